@@ -0,0 +1,66 @@
+/** @file
+    Parallel batch processing of input files.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_BATCH_H_
+#define INCLUDE_BATCH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct r_cfg;
+struct data;
+struct list;
+
+/// A file, or a range of samples in a file, to process.
+typedef struct batch_input {
+    char *filename;
+    uint64_t start; ///< first sample
+    uint64_t end;   ///< end sample, 0 for the whole file
+} batch_input_t;
+
+/// Process one input, return non-zero on failure.
+typedef int (*batch_input_fn)(struct r_cfg *cfg, batch_input_t const *input, void *ctx);
+
+/** Process all inputs in up to @p jobs worker processes.
+
+    Each worker is forked with a fresh copy of the demod state for a single input.
+    Workers send their events back to this process, which prints them to the outputs
+    either as they arrive or, with @p ordered, in the order of the inputs.
+
+    @param inputs list of batch_input_t
+    @return the number of inputs that failed
+*/
+int batch_run(struct r_cfg *cfg, struct list *inputs, int jobs, int ordered, batch_input_fn process, void *ctx);
+
+/** Append a file to the inputs, split into segments at silent gaps.
+
+    A cheap energy scan finds gaps longer than 3 * PD_MAX_GAP_MS, cuts are placed in
+    the middle of the gaps, so each segment starts and ends with enough silence for a
+    fresh pulse detector. Segments are at least a @p segments-th part of the file.
+    Files which can't be mapped or are not I/Q samples are added as a single input.
+
+    @param inputs list of batch_input_t to append to
+    @param filename the input file name, with format overrides
+    @param path the file path
+    @param format the file format, a file_type
+    @param samp_rate the sample rate
+    @param segments the number of segments to aim for
+    @return the number of inputs added
+*/
+int batch_split_file(struct list *inputs, char *filename, char const *path, uint32_t format, uint32_t samp_rate, int segments);
+
+/// Serialize an event to a buffer, returns the length needed, which might exceed @p size.
+size_t batch_pack(struct data *data, char *buf, size_t size);
+
+/// Deserialize an event, returns NULL if the buffer is malformed.
+struct data *batch_unpack(char const *buf, size_t len);
+
+#endif /* INCLUDE_BATCH_H_ */
@@ -41,6 +41,20 @@ typedef struct bitbuffer {
 /// Clear the content of the bitbuffer.
 void bitbuffer_clear(bitbuffer_t *bits);
 
+/// Get a cleared scratch bitbuffer from the pool of the calling thread.
+///
+/// Use this instead of a bitbuffer_t on the stack, release it before returning.
+bitbuffer_t *bitbuffer_acquire(void);
+
+/// Clear a bitbuffer from bitbuffer_acquire() and return it to the pool of the calling thread.
+void bitbuffer_release(bitbuffer_t *bits);
+
+/// Release a bitbuffer whose rows were written directly through bb, clears at least the first @p bytes_used bytes.
+void bitbuffer_release_used(bitbuffer_t *bits, unsigned bytes_used);
+
+/// Free all pooled bitbuffers of the calling thread.
+void bitbuffer_pool_free(void);
+
 /// Add a single bit at the end of the bitbuffer (MSB first).
 void bitbuffer_add_bit(bitbuffer_t *bits, int bit);
 
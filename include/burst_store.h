@@ -0,0 +1,85 @@
+/** @file
+    Burst store, an append-only file of detected I/Q bursts with an index.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_BURST_STORE_H_
+#define INCLUDE_BURST_STORE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+    File layout, all values little-endian:
+
+    file header: "RTL433BS", u32 version, u32 reserved
+    each record: "BRST", u32 header length (including magic, models text),
+                 u64 time (microseconds since the epoch),
+                 u32 center frequency, u32 sample rate, u32 format (a file_type), u32 number of samples,
+                 f32 RSSI, f32 SNR, f32 noise (dB), u32 number of events,
+                 u16 length of models text, models text (comma separated),
+                 samples (CU8 or CS16 I/Q)
+
+    The index file (the path with ".idx" appended) has a fixed size entry per record:
+                 u64 record offset, u64 time, u32 center frequency, u32 number of samples,
+                 u32 number of events, f32 RSSI
+*/
+
+#define BURST_STORE_VERSION    1
+#define BURST_STORE_MODELS_MAX 128
+#define BURST_STORE_INDEX_SIZE 32
+
+typedef struct burst_info {
+    uint64_t time_us;
+    uint32_t center_frequency;
+    uint32_t sample_rate;
+    uint32_t format; ///< CU8_IQ or CS16_IQ
+    uint32_t num_samples;
+    float rssi_db;
+    float snr_db;
+    float noise_db;
+    uint32_t events;
+    char models[BURST_STORE_MODELS_MAX];
+} burst_info_t;
+
+typedef struct burst_store {
+    FILE *file;
+    FILE *index;
+    uint64_t offset; ///< end of the file, where the next record goes
+    unsigned count;  ///< records written
+} burst_store_t;
+
+/// Open a burst store for appending, or truncate it with @p overwrite.
+/// Prints an error and returns NULL on failure.
+burst_store_t *burst_store_open(char const *path, int overwrite);
+
+/// Append a burst, the samples might be given in two parts, e.g. from a ring buffer.
+/// @return 0 on success, -1 on a write error
+int burst_store_write(burst_store_t *store, burst_info_t const *info,
+        void const *samples1, size_t len1, void const *samples2, size_t len2);
+
+/// Close the burst store and index files.
+void burst_store_close(burst_store_t *store);
+
+/// Bytes per sample for a burst format, 0 for unsupported formats.
+unsigned burst_sample_size(uint32_t format);
+
+/// Check the file header of a burst store opened for reading.
+/// @return 0 on success, -1 if this isn't a burst store
+int burst_store_read_header(FILE *file);
+
+/// Read the next record, the sample data is read into @p buf which is grown as needed.
+/// @return the number of sample bytes, 0 at the end of the file, -1 on a malformed record
+long burst_store_read(FILE *file, burst_info_t *info, uint8_t **buf, size_t *buf_size);
+
+/// Read an index entry by number.
+/// @return 0 on success, -1 if there is no such entry
+int burst_store_read_index(FILE *index, unsigned num, uint64_t *offset, burst_info_t *info);
+
+#endif /* INCLUDE_BURST_STORE_H_ */
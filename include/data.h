@@ -141,6 +141,13 @@ R_API void data_free(data_t *data);
 
 struct data_output;
 
+/// Output statistics, events are counted by data_output_print(), bytes and errors by the outputs.
+typedef struct data_output_stats {
+    unsigned long events; ///< data objects printed
+    unsigned long bytes;  ///< bytes written or sent, not counted by all outputs
+    unsigned long errors; ///< failed writes or sends, and dropped messages
+} data_output_stats_t;
+
 typedef struct data_output {
     void (R_API_CALLCONV *print_data)(struct data_output *output, data_t *data, char const *format);
     void (R_API_CALLCONV *print_array)(struct data_output *output, data_array_t *data, char const *format);
@@ -150,6 +157,8 @@ typedef struct data_output {
     void (R_API_CALLCONV *output_start)(struct data_output *output, char const *const *fields, int num_fields);
     void (R_API_CALLCONV *output_flush)(struct data_output *output);
     void (R_API_CALLCONV *output_free)(struct data_output *output);
+    char const *name; ///< output type for statistics, e.g. "json"
+    data_output_stats_t stats;
 } data_output_t;
 
 /** Setup known field keys and start output, used by CSV only.
@@ -0,0 +1,58 @@
+/** @file
+    De-duplication of repeated events.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_DATA_DEDUP_H_
+#define INCLUDE_DATA_DEDUP_H_
+
+#include <stddef.h>
+
+struct data;
+
+typedef struct data_dedup_entry data_dedup_entry_t;
+
+typedef struct data_dedup {
+    double window;        ///< seconds a repeat is suppressed after the last copy
+    int collapse;         ///< hold events and output one with a repeat count
+    char const **fields;  ///< fields to compare, NULL for all but meta data
+    data_dedup_entry_t *table;
+    unsigned capacity;    ///< table slots, a power of two
+    unsigned used;        ///< slots ever taken, live or expired
+    unsigned held;        ///< events held back in collapse mode
+    /* stats */
+    unsigned lookups;     ///< events checked
+    unsigned hits;        ///< events recognized as repeat
+} data_dedup_t;
+
+/// Create a de-duplication stage from "<ms>[,collapse][,fields=<key>[+<key>...]]". Exits on errors.
+data_dedup_t *data_dedup_create(char *params);
+
+/// Free a de-duplication stage, held events are discarded.
+void data_dedup_free(data_dedup_t *dedup);
+
+/** Check an event at time @p now (in seconds).
+
+    @return the event to output now, or NULL if the event was a repeat or is held back.
+*/
+struct data *data_dedup_apply(data_dedup_t *dedup, struct data *data, double now);
+
+/** Release one held event which is past its window at time @p now, use a negative @p now to release all.
+
+    @return an event to output or NULL if none are due.
+*/
+struct data *data_dedup_expire(data_dedup_t *dedup, double now);
+
+/// Number of live entries in the table.
+unsigned data_dedup_entries(data_dedup_t *dedup, double now);
+
+/// Table memory in bytes.
+size_t data_dedup_memory(data_dedup_t *dedup);
+
+#endif /* INCLUDE_DATA_DEDUP_H_ */
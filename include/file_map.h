@@ -0,0 +1,39 @@
+/** @file
+    Read-only memory mapping of input files.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_FILE_MAP_H_
+#define INCLUDE_FILE_MAP_H_
+
+#include <stdio.h>
+#include <stddef.h>
+
+typedef struct file_map {
+    unsigned char *data; ///< the mapped file, NULL if not mapped
+    size_t len;          ///< length of the mapping in bytes
+    size_t advised;      ///< offset up to which read-ahead was requested
+} file_map_t;
+
+/** Map a whole regular file for sequential reading.
+
+    Pipes, character devices, empty files and platforms without mmap are not mapped,
+    the caller should then fall back to fread().
+
+    @return 0 on success, -1 if the file can't be mapped
+*/
+int file_map_open(file_map_t *map, FILE *file);
+
+/// Hint that the range at @p offset will be read next, requests read-ahead in larger steps.
+void file_map_advise(file_map_t *map, size_t offset, size_t len);
+
+/// Unmap the file, the FILE itself is not closed.
+void file_map_close(file_map_t *map);
+
+#endif /* INCLUDE_FILE_MAP_H_ */
@@ -41,6 +41,9 @@ enum file_type {
     F_LOGIC    = 5 << 16,
     F_VCD      = 6 << 16,
     F_OOK      = 7 << 16,
+    F_BURST    = 8 << 16,
+    F_SIGMF    = 9 << 16,
+    F_PULSES   = 10 << 16,
     // format types
     F_U8       = F_1CH | F_UNSIGNED | F_INT | F_W8,
     F_S8       = F_1CH | F_SIGNED   | F_INT | F_W8,
@@ -70,6 +73,9 @@ enum file_type {
     U8_LOGIC   = F_LOGIC | F_U8,
     VCD_LOGIC  = F_VCD,
     PULSE_OOK  = F_OOK,
+    BURST_IQ   = F_BURST,
+    SIGMF_IQ   = F_SIGMF,
+    PULSE_BIN  = F_PULSES,
 };
 
 typedef struct {
@@ -100,6 +106,7 @@ void file_info_clear(file_info_t *info);
 /// - 2ch formats: "cu8", "cs8", "cs16", "cs32", "cf32"
 /// - 1ch formats: "u8", "s8", "s16", "u16", "s32", "u32", "f32"
 /// - text formats: "vcd", "ook"
+/// - container formats: "burst", "sigmf"
 /// - content types: "iq", "i", "q", "am", "fm", "logic"
 ///
 /// Parses left to right, with the exception of a prefix up to the last colon ":"
@@ -0,0 +1,68 @@
+/** @file
+    Little-endian encoding of integers and floats for binary file formats.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_LE_UTIL_H_
+#define INCLUDE_LE_UTIL_H_
+
+#include <stdint.h>
+#include <string.h>
+
+static inline void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = v & 0xff;
+    p[1] = v >> 8;
+}
+
+static inline void put_u32(uint8_t *p, uint32_t v)
+{
+    for (int i = 0; i < 4; ++i)
+        p[i] = (v >> (i * 8)) & 0xff;
+}
+
+static inline void put_u64(uint8_t *p, uint64_t v)
+{
+    for (int i = 0; i < 8; ++i)
+        p[i] = (v >> (i * 8)) & 0xff;
+}
+
+/// Store a float as its IEEE 754 bits.
+static inline void put_f32(uint8_t *p, float v)
+{
+    uint32_t u;
+    memcpy(&u, &v, sizeof(u));
+    put_u32(p, u);
+}
+
+static inline uint16_t get_u16(uint8_t const *p)
+{
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static inline uint32_t get_u32(uint8_t const *p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static inline uint64_t get_u64(uint8_t const *p)
+{
+    return (uint64_t)get_u32(p) | (uint64_t)get_u32(&p[4]) << 32;
+}
+
+/// Load a float from its IEEE 754 bits.
+static inline float get_f32(uint8_t const *p)
+{
+    uint32_t u = get_u32(p);
+    float v;
+    memcpy(&v, &u, sizeof(v));
+    return v;
+}
+
+#endif /* INCLUDE_LE_UTIL_H_ */
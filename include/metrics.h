@@ -0,0 +1,110 @@
+/** @file
+    Pipeline metrics, counters and histograms for the processing stages.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_METRICS_H_
+#define INCLUDE_METRICS_H_
+
+#include <stdint.h>
+
+/// Processing stages timed by the pipeline metrics.
+enum metrics_stage {
+    METRICS_STAGE_DEMOD,  ///< AM and FM demodulation of the samples
+    METRICS_STAGE_DETECT, ///< pulse detection
+    METRICS_STAGE_DECODE, ///< running the decoders, without the outputs
+    METRICS_STAGE_OUTPUT, ///< printing events to all outputs
+    METRICS_STAGE_COUNT,
+};
+
+/// Latencies on the wall clock, following a burst from the end of its last pulse to the outputs.
+enum metrics_latency_stage {
+    METRICS_LATENCY_EOP,    ///< end of the last pulse to the end of package being detected
+    METRICS_LATENCY_DECODE, ///< running the decoders on a package, without the outputs
+    METRICS_LATENCY_OUTPUT, ///< printing an event to all outputs
+    METRICS_LATENCY_TOTAL,  ///< end of the last pulse to an event being printed to all outputs
+    METRICS_LATENCY_COUNT,
+};
+
+#define METRICS_BUCKETS_MAX 12
+
+#define METRICS_LATENCY_STEPS   4   // buckets per octave
+#define METRICS_LATENCY_BUCKETS 105 // 1 us to 67 s
+#define METRICS_OUTPUTS_MAX     16  // outputs with latency tracking
+
+/// A histogram with fixed upper bounds, the last bucket counts values above all bounds.
+typedef struct metrics_histogram {
+    double const *bounds;
+    unsigned num_bounds;
+    uint64_t buckets[METRICS_BUCKETS_MAX + 1];
+    uint64_t count;
+    double sum;
+} metrics_histogram_t;
+
+/// A latency histogram with log-scale buckets for quantile estimates, bucket 0 counts 1 us and less.
+typedef struct metrics_latency {
+    uint32_t buckets[METRICS_LATENCY_BUCKETS];
+    uint64_t count;
+    double sum; ///< seconds
+    double max; ///< seconds
+} metrics_latency_t;
+
+/// Counters since start, never reset (unlike the report stats).
+typedef struct pipeline_metrics {
+    double start_time;          ///< wall clock time of metrics_init(), i.e. the program start
+    double startup_seconds;     ///< wall clock time from the start to the first sample buffer
+    uint64_t buffers;           ///< sample buffers received
+    uint64_t samples;           ///< samples processed
+    uint64_t buffers_squelched; ///< buffers skipped as noise only
+    uint64_t packages_ook;      ///< OOK packages detected
+    uint64_t packages_fsk;      ///< FSK packages detected
+    float noise_db;             ///< current estimated noise level
+    double stage_seconds[METRICS_STAGE_COUNT]; ///< CPU time spent in each stage
+    metrics_histogram_t buffer_seconds; ///< CPU time to process a sample buffer
+    metrics_histogram_t package_pulses; ///< number of pulses in a package
+    double output_wall_seconds; ///< wall clock time spent in the outputs, to take it out of the decode latency
+    metrics_latency_t latency[METRICS_LATENCY_COUNT];          ///< latencies since start
+    metrics_latency_t latency_interval[METRICS_LATENCY_COUNT]; ///< latencies since the last stats report
+    metrics_latency_t output_latency[METRICS_OUTPUTS_MAX];     ///< latency of each output, by position
+} pipeline_metrics_t;
+
+/// Set up the histogram bounds and note the start time.
+void metrics_init(pipeline_metrics_t *metrics);
+
+/// CPU time of the calling thread in seconds, where available, otherwise the process CPU time.
+double metrics_cpu_time(void);
+
+/// Add the CPU time since @p start to a stage, returns the current CPU time to start the next stage.
+double metrics_stage_end(pipeline_metrics_t *metrics, enum metrics_stage stage, double start);
+
+/// Count a value in a histogram.
+void metrics_histogram_observe(metrics_histogram_t *hist, double value);
+
+/// Name of a stage, as used for labels.
+char const *metrics_stage_name(enum metrics_stage stage);
+
+/// Wall clock time in seconds, comparable to the arrival time of sample buffers.
+double metrics_wall_time(void);
+
+/// Count a latency in seconds, negative values (clock steps) count as zero.
+void metrics_latency_observe(metrics_latency_t *lat, double seconds);
+
+/// Count a latency for a stage, since start and for the stats report.
+void metrics_latency_add(pipeline_metrics_t *metrics, enum metrics_latency_stage stage, double seconds);
+
+/// Estimate a quantile (0 to 1) in seconds, the upper bound of the bucket, at most the maximum.
+double metrics_latency_quantile(metrics_latency_t const *lat, double q);
+
+/// Name of a latency stage, as used for labels.
+char const *metrics_latency_name(enum metrics_latency_stage stage);
+
+/// Add the counters, times and histograms of @p other, e.g. from a worker process.
+void metrics_merge(pipeline_metrics_t *metrics, pipeline_metrics_t const *other);
+
+#endif /* INCLUDE_METRICS_H_ */
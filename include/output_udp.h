@@ -14,6 +14,8 @@
 
 #include "data.h"
 
-struct data_output *data_output_syslog_create(const char *host, const char *port);
+struct mg_mgr;
+
+struct data_output *data_output_syslog_create(struct mg_mgr *mgr, const char *host, const char *port, char *opts);
 
 #endif /* INCLUDE_OUTPUT_UDP_H_ */
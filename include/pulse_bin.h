@@ -0,0 +1,94 @@
+/** @file
+    Binary pulse data files, a compact and fast to load alternative to the OOK text format.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_PULSE_BIN_H_
+#define INCLUDE_PULSE_BIN_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "file_map.h"
+#include "pulse_detect.h"
+
+/*
+    File layout, all values little-endian:
+
+    file header: "RTL433PB", u32 version, u32 reserved
+    each package: "PULS", u32 record length (including magic, header, widths),
+                  u64 offset (samples from the start of the stream),
+                  u32 sample rate, u32 sample depth bits, u32 number of pulses,
+                  i32 FSK F1 estimate, i32 FSK F2 estimate (non-zero for FSK packages),
+                  i32 OOK low estimate, i32 OOK high estimate,
+                  f32 center frequency, f32 freq1, f32 freq2 (Hz),
+                  f32 range, f32 RSSI, f32 SNR, f32 noise (dB),
+                  pulse and gap widths in samples, alternating, each an unsigned LEB128 varint
+
+    The widths are kept in samples, unlike the text format there is no rounding to microseconds.
+
+    The index file (the path with ".idx" appended) has a fixed size entry per package:
+                  u64 record offset, u64 offset (samples), u32 number of pulses, u32 package type
+*/
+
+#define PULSE_BIN_VERSION    1
+#define PULSE_BIN_INDEX_SIZE 24
+
+typedef struct pulse_bin_writer {
+    FILE *file;
+    FILE *index;
+    uint64_t offset; ///< end of the file, where the next record goes
+    unsigned count;  ///< packages written
+    uint8_t *record; ///< record buffer, sized for the longest package written
+    size_t record_size;
+} pulse_bin_writer_t;
+
+/// Open a pulse file for appending, or truncate it with @p overwrite.
+/// Prints an error and returns NULL on failure.
+pulse_bin_writer_t *pulse_bin_open(char const *path, int overwrite);
+
+/// Append a package.
+/// @return 0 on success, -1 on a write error
+int pulse_bin_write(pulse_bin_writer_t *writer, pulse_data_t const *data);
+
+/// Close the pulse file and index.
+void pulse_bin_close(pulse_bin_writer_t *writer);
+
+/// A whole pulse file in memory, mapped if possible.
+typedef struct pulse_bin_reader {
+    file_map_t map;
+    uint8_t *buf;        ///< the file contents if it can't be mapped
+    uint8_t const *data;
+    size_t len;
+    size_t pos;          ///< offset of the next record, might be set from an index entry
+} pulse_bin_reader_t;
+
+/// Load a pulse file, @p file is left open for the caller to close after pulse_bin_reader_close().
+/// @return 0 on success, -1 if this isn't a pulse file
+int pulse_bin_reader_open(pulse_bin_reader_t *reader, FILE *file);
+
+/// Decode the next package into @p data.
+/// @return 1 if a package was read, 0 at the end of the file, -1 on a malformed record
+int pulse_bin_read(pulse_bin_reader_t *reader, pulse_data_t *data);
+
+/// Release the file contents.
+void pulse_bin_reader_close(pulse_bin_reader_t *reader);
+
+typedef struct pulse_bin_index {
+    uint64_t record_offset;
+    uint64_t offset;
+    uint32_t num_pulses;
+    uint32_t package_type; ///< PULSE_DATA_OOK or PULSE_DATA_FSK
+} pulse_bin_index_t;
+
+/// Read an index entry by number.
+/// @return 0 on success, -1 if there is no such entry
+int pulse_bin_read_index(FILE *index, unsigned num, pulse_bin_index_t *entry);
+
+#endif /* INCLUDE_PULSE_BIN_H_ */
@@ -16,7 +16,8 @@
 #include <stdio.h>
 #include "data.h"
 
-#define PD_MAX_PULSES 1200      // Maximum number of pulses before forcing End Of Package
+#define PD_MAX_PULSES 16384     // Maximum number of pulses before forcing End Of Package
+#define PD_MIN_CAPACITY 128     // Initial pulse storage, grows in powers of two up to PD_MAX_PULSES
 #define PD_MIN_PULSES 16        // Minimum number of pulses before declaring a proper package
 #define PD_MIN_PULSE_SAMPLES 10 // Minimum number of samples in a pulse for proper detection
 #define PD_MIN_GAP_MS 10        // Minimum gap size in milliseconds to exceed to declare End Of Package
@@ -31,9 +32,11 @@ typedef struct pulse_data {
     unsigned depth_bits;        ///< Sample depth in bits.
     unsigned start_ago;         ///< Start of first pulse in number of samples ago.
     unsigned end_ago;           ///< End of last pulse in number of samples ago.
+    double end_time;            ///< Wall clock time at the end of last pulse in seconds, estimated from the buffer arrival, 0 if unknown.
     unsigned int num_pulses;
-    int pulse[PD_MAX_PULSES];   ///< Width of pulses (high) in number of samples.
-    int gap[PD_MAX_PULSES];     ///< Width of gaps between pulses (low) in number of samples.
+    unsigned capacity;          ///< Number of pulses the storage holds, see pulse_data_reserve().
+    int *pulse;                 ///< Width of pulses (high) in number of samples.
+    int *gap;                   ///< Width of gaps between pulses (low) in number of samples.
     int ook_low_estimate;       ///< Estimate for the OOK low level (base noise level) at beginning of package.
     int ook_high_estimate;      ///< Estimate for the OOK high level at end of package.
     int fsk_f1_est;             ///< Estimate for the F1 frequency for FSK.
@@ -76,9 +79,19 @@ typedef struct {
 
 typedef struct pulse_detect pulse_detect_t;
 
-/// Clear the content of a pulse_data_t structure.
+/// Clear the content of a pulse_data_t structure, keeps the pulse storage.
 void pulse_data_clear(pulse_data_t *data);
 
+/// Grow the pulse storage to hold at least @p num_pulses, keeps the content.
+/// Storage is taken from a pool and reused across packages, only use from the processing thread.
+void pulse_data_reserve(pulse_data_t *data, unsigned num_pulses);
+
+/// Return the pulse storage to the pool, the structure is cleared.
+void pulse_data_free(pulse_data_t *data);
+
+/// Free all pulse storage kept in the pool.
+void pulse_data_pool_free(void);
+
 /// Shift out part of the data to make room for more.
 void pulse_data_shift(pulse_data_t *data);
 
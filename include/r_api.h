@@ -20,6 +20,7 @@ struct data;
 struct pulse_data;
 struct list;
 struct mg_mgr;
+struct ring_buf;
 
 /* general */
 
@@ -61,10 +62,16 @@ void event_occurred_handler(struct r_cfg *cfg, struct data *data);
 
 void data_acquired_handler(struct r_device *r_dev, struct data *data);
 
+/// Pass a complete event, e.g. from a batch worker, to all output handlers. Frees data afterwards.
+void event_forward_handler(struct r_cfg *cfg, struct data *data);
+
 struct data *create_report_data(struct r_cfg *cfg, int level);
 
 void flush_report_data(struct r_cfg *cfg);
 
+/// Output held de-duplicated events which are past their window, or all if @p all is set.
+void flush_dedup_data(struct r_cfg *cfg, int all);
+
 /* setup */
 
 void add_json_output(struct r_cfg *cfg, char *param);
@@ -89,6 +96,11 @@ void add_rtltcp_output(struct r_cfg *cfg, char *param);
 
 void start_outputs(struct r_cfg *cfg, char const *const *well_known);
 
+/// The ring all raw samples are written to once, shared by the sample grabber and raw outputs.
+struct ring_buf *get_sample_ring(struct r_cfg *cfg);
+
+void add_samp_grab(struct r_cfg *cfg);
+
 void add_sr_dumper(struct r_cfg *cfg, char const *spec, int overwrite);
 
 void close_dumpers(struct r_cfg *cfg);
@@ -99,6 +111,8 @@ void add_infile(struct r_cfg *cfg, char *in_file);
 
 void add_data_tag(struct r_cfg *cfg, char *param);
 
+void add_dedup(struct r_cfg *cfg, char *param);
+
 /* runtime */
 
 struct mg_mgr *get_mgr(struct r_cfg *cfg);
@@ -56,7 +56,7 @@ struct data;
 
 /** Device protocol decoder struct. */
 typedef struct r_device {
-    unsigned protocol_num; ///< fixed sequence number, assigned in main().
+    unsigned protocol_num; ///< fixed sequence number, assigned when registered.
 
     /* information provided by each decoder */
     char *name;
@@ -84,6 +84,12 @@ typedef struct r_device {
     unsigned decode_messages;
     unsigned decode_fails[5];
 
+    /* Decoder statistics since start, the counters above are added on each report flush */
+    unsigned long total_events;
+    unsigned long total_ok;
+    unsigned long total_messages;
+    unsigned long total_fails[5];
+
     /* private for flex decoder and output callback */
     void *decode_ctx;
     void *output_ctx;
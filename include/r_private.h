@@ -12,6 +12,9 @@
 #include "pulse_detect.h"
 #include "fileformat.h"
 #include "samp_grab.h"
+#include "burst_store.h"
+#include "sigmf.h"
+#include "pulse_bin.h"
 #include "am_analyze.h"
 #include "rtl_433.h"
 #include "compat_time.h"
@@ -28,14 +31,19 @@ struct dm_state {
     int use_mag_est;
     int detect_verbosity;
 
-    int16_t am_buf[MAXIMAL_BUF_LENGTH];  // AM demodulated signal (for OOK decoding)
+    // demodulation buffers, sized to the sample buffers on first use and grown as needed
+    unsigned buf_samples; // capacity of am_buf and buf in samples
+    int16_t *am_buf;  // AM demodulated signal (for OOK decoding)
     union {
         // These buffers aren't used at the same time, so let's use a union to save some memory
-        int16_t fm[MAXIMAL_BUF_LENGTH];  // FM demodulated signal (for FSK decoding)
-        uint16_t temp[MAXIMAL_BUF_LENGTH];  // Temporary buffer (to be optimized out..)
+        int16_t *fm;  // FM demodulated signal (for FSK decoding)
+        uint16_t *temp;  // Temporary buffer (to be optimized out..)
     } buf;
-    uint8_t u8_buf[MAXIMAL_BUF_LENGTH]; // format conversion buffer
-    float f32_buf[MAXIMAL_BUF_LENGTH]; // format conversion buffer
+    // dumper buffers, only allocated if a dumper needs them
+    uint8_t *u8_buf; // logic state buffer
+    size_t u8_buf_size;
+    uint8_t *conv_buf; // format conversion buffer
+    size_t conv_buf_size;
     int sample_size; // CU8: 2, CS16: 4
     pulse_detect_t *pulse_detect;
     filter_state_t lowpass_filter_state;
@@ -43,11 +51,15 @@ struct dm_state {
     int enable_FM_demod;
     unsigned fsk_pulse_detect_mode;
     unsigned frequency;
+    ring_buf_t *sample_ring;
     samp_grab_t *samp_grab;
     am_analyze_t *am_analyze;
     int analyze_pulses;
     file_info_t load_info;
     list_t dumper;
+    list_t burst_stores;
+    list_t sigmf_writers;
+    list_t pulse_writers;
 
     /* Protocol states */
     list_t r_devs;
@@ -57,7 +69,13 @@ struct dm_state {
     unsigned frame_event_count;
     unsigned frame_start_ago;
     unsigned frame_end_ago;
+    float frame_rssi_db; // levels of the strongest package in the frame
+    float frame_snr_db;
+    float frame_noise_db;
+    char frame_models[BURST_STORE_MODELS_MAX]; // models decoded in the frame, for burst stores
+    char package_models[BURST_STORE_MODELS_MAX]; // models decoded from the package, for SigMF annotations
     struct timeval now;
+    double buffer_arrival; // wall clock time the current sample buffer was received, 0 if unknown
     float sample_file_pos;
 };
 
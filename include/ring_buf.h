@@ -0,0 +1,57 @@
+/** @file
+    Double-mapped ring buffer of raw samples, one writer and any number of readers.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_RING_BUF_H_
+#define INCLUDE_RING_BUF_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+    The buffer memory is mapped twice, back to back, so any slice of up to
+    the buffer size is contiguous and readers never need to handle wraparound.
+    Where that mapping is not available the second half is a mirrored copy.
+
+    Positions are counted in bytes since creation and never wrap.
+    The writer publishes the head position after the data is written,
+    readers keep their own position and read from the ring without locking.
+    Data at a position is valid while the head is no more than the buffer size ahead.
+*/
+
+typedef struct ring_buf {
+    uint8_t *buf;    ///< twice the size, buf[i] and buf[i + size] are the same byte
+    size_t size;     ///< a multiple of the page size
+    uint64_t head;   ///< bytes written so far, only access with ring_buf_head()
+    int mirrored;    ///< the second half is a copy, not a mapping
+} ring_buf_t;
+
+/// Create a ring of at least @p min_size bytes.
+/// Prints an error and returns NULL on failure.
+ring_buf_t *ring_buf_create(size_t min_size);
+
+void ring_buf_free(ring_buf_t *ring);
+
+/// Append data, then publish the new head position. Only one thread may write.
+void ring_buf_write(ring_buf_t *ring, void const *data, size_t len);
+
+/// The position after the most recently written byte.
+uint64_t ring_buf_head(ring_buf_t *ring);
+
+/// The oldest position still in the ring.
+uint64_t ring_buf_tail(ring_buf_t *ring);
+
+/// The data at a position, contiguous for up to the ring size.
+static inline uint8_t const *ring_buf_at(ring_buf_t const *ring, uint64_t pos)
+{
+    return &ring->buf[pos % ring->size];
+}
+
+#endif /* INCLUDE_RING_BUF_H_ */
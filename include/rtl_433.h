@@ -7,6 +7,7 @@
 
 #include <stdint.h>
 #include "list.h"
+#include "metrics.h"
 #include <time.h>
 #include <signal.h>
 
@@ -54,6 +55,9 @@ typedef struct r_cfg {
     list_t in_files;
     char const *in_filename;
     int in_replay;
+    int batch_jobs; ///< number of worker processes for input files
+    int batch_ordered; ///< print the events of input files in file order
+    int batch_split; ///< split input files at silent gaps for parallel decoding
     volatile sig_atomic_t hop_now;
     volatile sig_atomic_t exit_async;
     volatile sig_atomic_t exit_code; ///< 0=no err, 1=params or cmd line err, 2=sdr device read error, 3=usb init error, 5=USB error (reset), other=other error
@@ -85,14 +89,17 @@ typedef struct r_cfg {
     int report_time_tz;
     int report_time_utc;
     int report_description;
+    int report_latency;
     int report_stats;
     int stats_interval;
     volatile sig_atomic_t stats_now;
+    volatile sig_atomic_t reload_now; ///< reload decoders and outputs from the config before the next buffer
     time_t stats_time;
     int no_default_devices;
-    struct r_device *devices;
+    struct r_device *const *devices; ///< the protocol registry, templates by protocol number - 1
     uint16_t num_r_devices;
     list_t data_tags;
+    struct data_dedup *dedup;
     list_t output_handler;
     list_t raw_handler;
     struct dm_state *demod;
@@ -103,6 +110,7 @@ typedef struct r_cfg {
     unsigned frames_count; ///< stats counter for interval
     unsigned frames_fsk; ///< stats counter for interval
     unsigned frames_events; ///< stats counter for interval
+    pipeline_metrics_t metrics; ///< stats counters since start, for the /metrics endpoint
     struct mg_mgr *mgr;
 } r_cfg_t;
 
@@ -14,27 +14,31 @@
 
 #include <stdint.h>
 
+#include "ring_buf.h"
+
 typedef struct samp_grab {
     uint32_t *frequency;
     uint32_t *samp_rate;
     int *sample_size;
 
     unsigned sg_counter;
-    char *sg_buf;
-    unsigned sg_size;
-    unsigned sg_index;
-    unsigned sg_len;
+    ring_buf_t *ring;  ///< the shared sample ring, not owned
+    uint64_t sg_start; ///< ring position at the last reset
 } samp_grab_t;
 
-samp_grab_t *samp_grab_create(unsigned size);
+/// Grab from the samples written to a shared ring.
+samp_grab_t *samp_grab_create(ring_buf_t *ring);
 
 void samp_grab_free(samp_grab_t *g);
 
-void samp_grab_push(samp_grab_t *g, unsigned char *iq_buf, uint32_t len);
-
 void samp_grab_reset(samp_grab_t *g);
 
 /// grab_end is counted in samples from end of buf.
 void samp_grab_write(samp_grab_t *g, unsigned grab_len, unsigned grab_end);
 
+/// Locate grab_len samples ending grab_end samples from end of buf.
+/// The samples are contiguous, valid until the ring is written to again.
+/// Returns the number of bytes located, which might be less than requested.
+unsigned samp_grab_range(samp_grab_t *g, unsigned grab_len, unsigned grab_end, char const **data);
+
 #endif /* INCLUDE_SAMP_GRAB_H_ */
@@ -36,10 +36,26 @@ typedef struct sdr_event {
     char const *gain_str;
     void *buf;
     int len;
+    double arrival; ///< wall clock time the data buffer was received in seconds, 0 if unknown
 } sdr_event_t;
 
 typedef void (*sdr_event_cb_t)(sdr_event_t *ev, void *ctx);
 
+/// Input statistics since the device was started.
+typedef struct sdr_stats {
+    unsigned long long buffers;          ///< data buffers passed to the callback
+    unsigned long long bytes;            ///< bytes received
+    unsigned long long samples;          ///< samples received
+    unsigned long long samples_expected; ///< samples expected from the wall clock and sample rate
+    unsigned long long dropped;          ///< samples lost, from stream timestamps, queue overruns, or arrival times
+    unsigned long long gaps;             ///< number of times samples were lost
+    unsigned long long overruns;         ///< overflows reported by the device, or buffers dropped by the read-ahead
+    unsigned long long late;             ///< callbacks that took longer than the buffer duration
+    double callback_seconds;             ///< time spent in the callback
+    double callback_max;                 ///< longest callback in seconds
+    double buffer_seconds;               ///< duration of all buffers at the sample rate
+} sdr_stats_t;
+
 /** Find the closest matching device, optionally report status.
 
     @param out_dev device output returned
@@ -67,6 +83,17 @@ int sdr_close(sdr_dev_t *dev);
 */
 char const *sdr_get_dev_info(sdr_dev_t *dev);
 
+/** Get input statistics.
+
+    @note
+    The counters are updated before and after each data event callback,
+    they are consistent when read from the callback.
+
+    @param dev the device handle
+    @return the statistics since the device was started
+*/
+sdr_stats_t const *sdr_get_stats(sdr_dev_t *dev);
+
 /** Get sample size.
 
     @param dev the device handle
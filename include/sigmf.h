@@ -0,0 +1,84 @@
+/** @file
+    SigMF recordings, a dataset file with a JSON metadata file.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_SIGMF_H_
+#define INCLUDE_SIGMF_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+typedef struct sigmf_annotation {
+    uint64_t sample_start;
+    uint64_t sample_count;
+    char *label;   ///< decoded models, might be NULL
+    char *comment; ///< package type, might be NULL
+} sigmf_annotation_t;
+
+typedef struct sigmf_capture {
+    uint64_t sample_start;
+    uint32_t frequency;
+} sigmf_capture_t;
+
+/// Metadata read from a ".sigmf-meta" file.
+typedef struct sigmf_meta {
+    char *data_path;  ///< the ".sigmf-data" dataset file
+    uint32_t format;  ///< a file_type, CU8_IQ, CS8_IQ, CS16_IQ, or CF32_IQ
+    uint32_t sample_rate;
+    uint32_t frequency; ///< of the first capture
+    sigmf_annotation_t *annotations; ///< sorted by sample_start, the labels are not read
+    size_t num_annotations;
+} sigmf_meta_t;
+
+/// Read the metadata for a recording, @p path is the meta, data, or base file name.
+/// Prints an error and returns -1 on failure.
+int sigmf_meta_read(sigmf_meta_t *meta, char const *path);
+
+/// Merge the annotations into regions padded by @p pad samples, in place.
+/// The regions are an index into the dataset, only these need to be read to decode the recording again.
+/// @return the number of regions
+size_t sigmf_meta_regions(sigmf_meta_t *meta, uint64_t pad);
+
+/// Free the metadata.
+void sigmf_meta_free(sigmf_meta_t *meta);
+
+/// A recording being written, the metadata is written on close.
+typedef struct sigmf_writer {
+    char *meta_path;
+    FILE *data;
+    uint32_t format;
+    uint32_t sample_rate;
+    time_t start_time;
+    uint64_t num_samples; ///< samples written so far
+    sigmf_capture_t *captures;
+    size_t num_captures;
+    sigmf_annotation_t *annotations;
+    size_t num_annotations;
+    size_t size_annotations;
+} sigmf_writer_t;
+
+/// Open a recording for writing, @p path is the meta, data, or base file name.
+/// Prints an error and returns NULL on failure.
+sigmf_writer_t *sigmf_writer_open(char const *path, int overwrite);
+
+/// Append samples, a change of frequency starts a new capture.
+/// @return 0 on success, -1 on a write error
+int sigmf_writer_write(sigmf_writer_t *writer, void const *buf, size_t len,
+        uint32_t format, uint32_t sample_rate, uint32_t frequency);
+
+/// Annotate samples, counted from the end of the samples written so far.
+void sigmf_writer_annotate(sigmf_writer_t *writer, uint64_t start_ago, uint64_t end_ago,
+        char const *label, char const *comment);
+
+/// Write the metadata and close the recording, prints an error on failure.
+void sigmf_writer_close(sigmf_writer_t *writer);
+
+#endif /* INCLUDE_SIGMF_H_ */
@@ -0,0 +1,871 @@
+/** @file
+    Parallel batch processing of input files.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "batch.h"
+
+#include "rtl_433.h"
+#include "r_api.h"
+#include "r_private.h"
+#include "r_device.h"
+#include "data.h"
+#include "data_dedup.h"
+#include "metrics.h"
+#include "list.h"
+#include "fileformat.h"
+#include "file_map.h"
+#include "pulse_detect.h"
+#include "r_util.h"
+#include "fatal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+/* Event serialization, only ever read back by the same binary on the same host.
+
+   A field is a type byte, the key, pretty key, and format as length-prefixed strings,
+   and the value. Ints and doubles are stored in native byte order, strings length-prefixed,
+   nested data as a field list, arrays as element type, count, and elements.
+   A field list ends with a 0xff byte.
+*/
+
+#define PACK_END    0xff
+#define PACK_NULL   UINT32_MAX ///< string length marking a NULL string
+
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t len;
+} pack_t;
+
+static void pack_bytes(pack_t *p, void const *src, size_t len)
+{
+    if (p->len + len <= p->size)
+        memcpy(&p->buf[p->len], src, len);
+    p->len += len;
+}
+
+static void pack_u8(pack_t *p, uint8_t val)
+{
+    pack_bytes(p, &val, sizeof(val));
+}
+
+static void pack_u32(pack_t *p, uint32_t val)
+{
+    pack_bytes(p, &val, sizeof(val));
+}
+
+static void pack_str(pack_t *p, char const *str)
+{
+    if (!str) {
+        pack_u32(p, PACK_NULL);
+        return;
+    }
+    uint32_t len = (uint32_t)strlen(str);
+    pack_u32(p, len);
+    pack_bytes(p, str, len);
+}
+
+static void pack_data(pack_t *p, data_t *data);
+
+static void pack_value(pack_t *p, data_type_t type, data_value_t value)
+{
+    switch (type) {
+    case DATA_INT:
+        pack_bytes(p, &value.v_int, sizeof(value.v_int));
+        break;
+    case DATA_DOUBLE:
+        pack_bytes(p, &value.v_dbl, sizeof(value.v_dbl));
+        break;
+    case DATA_STRING:
+        pack_str(p, value.v_ptr);
+        break;
+    case DATA_DATA:
+        pack_data(p, value.v_ptr);
+        break;
+    case DATA_ARRAY: {
+        data_array_t *array = value.v_ptr;
+        pack_u8(p, (uint8_t)array->type);
+        pack_u32(p, (uint32_t)array->num_values);
+        for (int i = 0; i < array->num_values; ++i) {
+            data_value_t v;
+            if (array->type == DATA_INT)
+                v.v_int = ((int *)array->values)[i];
+            else if (array->type == DATA_DOUBLE)
+                v.v_dbl = ((double *)array->values)[i];
+            else
+                v.v_ptr = ((void **)array->values)[i];
+            pack_value(p, array->type, v);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+static void pack_data(pack_t *p, data_t *data)
+{
+    for (; data; data = data->next) {
+        pack_u8(p, (uint8_t)data->type);
+        pack_str(p, data->key);
+        pack_str(p, data->pretty_key);
+        pack_str(p, data->format);
+        pack_value(p, data->type, data->value);
+    }
+    pack_u8(p, PACK_END);
+}
+
+size_t batch_pack(data_t *data, char *buf, size_t size)
+{
+    pack_t p = {.buf = buf, .size = size};
+    pack_data(&p, data);
+    return p.len;
+}
+
+typedef struct {
+    char const *p;
+    char const *end;
+    int err;
+} unpack_t;
+
+static void unpack_bytes(unpack_t *u, void *dst, size_t len)
+{
+    if (u->err || (size_t)(u->end - u->p) < len) {
+        u->err = 1;
+        memset(dst, 0, len);
+        return;
+    }
+    memcpy(dst, u->p, len);
+    u->p += len;
+}
+
+static uint8_t unpack_u8(unpack_t *u)
+{
+    uint8_t val;
+    unpack_bytes(u, &val, sizeof(val));
+    return val;
+}
+
+static uint32_t unpack_u32(unpack_t *u)
+{
+    uint32_t val;
+    unpack_bytes(u, &val, sizeof(val));
+    return val;
+}
+
+/// Returns a copy of the string, or NULL for a NULL string or on errors.
+static char *unpack_str(unpack_t *u)
+{
+    uint32_t len = unpack_u32(u);
+    if (u->err || len == PACK_NULL)
+        return NULL;
+    if ((size_t)(u->end - u->p) < len) {
+        u->err = 1;
+        return NULL;
+    }
+    char *str = malloc(len + 1);
+    if (!str) {
+        WARN_MALLOC("unpack_str()");
+        u->err = 1;
+        return NULL;
+    }
+    memcpy(str, u->p, len);
+    str[len] = '\0';
+    u->p += len;
+    return str;
+}
+
+static data_t *unpack_data(unpack_t *u);
+
+static data_array_t *unpack_array(unpack_t *u)
+{
+    data_type_t type = (data_type_t)unpack_u8(u);
+    uint32_t num_values = unpack_u32(u);
+    if (type != DATA_INT && type != DATA_DOUBLE && type != DATA_STRING && type != DATA_DATA && type != DATA_ARRAY)
+        u->err = 1;
+    if (u->err || num_values > (size_t)(u->end - u->p)) { // each element takes at least one byte
+        u->err = 1;
+        return NULL;
+    }
+
+    size_t element_size = type == DATA_INT ? sizeof(int) : type == DATA_DOUBLE ? sizeof(double) : sizeof(void *);
+    void *values = calloc(num_values + 1, element_size); // '+ 1' so we never alloc size 0
+    if (!values) {
+        WARN_CALLOC("unpack_array()");
+        u->err = 1;
+        return NULL;
+    }
+    uint32_t n = 0;
+    for (; n < num_values && !u->err; ++n) {
+        if (type == DATA_INT)
+            unpack_bytes(u, &((int *)values)[n], sizeof(int));
+        else if (type == DATA_DOUBLE)
+            unpack_bytes(u, &((double *)values)[n], sizeof(double));
+        else if (type == DATA_STRING)
+            ((char **)values)[n] = unpack_str(u);
+        else if (type == DATA_DATA)
+            ((data_t **)values)[n] = unpack_data(u);
+        else if (type == DATA_ARRAY)
+            ((data_array_t **)values)[n] = unpack_array(u);
+        else
+            u->err = 1;
+    }
+
+    data_array_t *array = NULL;
+    if (!u->err)
+        array = data_array((int)num_values, type, values); // copies strings, moves data and arrays
+
+    // release what was not moved into the array
+    for (uint32_t i = 0; i < n; ++i) {
+        if (type == DATA_STRING)
+            free(((char **)values)[i]);
+        else if (type == DATA_DATA && !array)
+            data_free(((data_t **)values)[i]);
+        else if (type == DATA_ARRAY && !array && ((data_array_t **)values)[i])
+            data_array_free(((data_array_t **)values)[i]);
+    }
+    free(values);
+    if (!array)
+        u->err = 1;
+    return array;
+}
+
+/// Append a field, data_append() takes nested data and arrays, but copies strings.
+static data_t *append_field(data_t *first, char const *key, char const *pretty_key, char const *format, data_type_t type, data_value_t value)
+{
+    if (type == DATA_INT)
+        return format ? data_append(first, key, pretty_key, DATA_FORMAT, format, type, value.v_int, NULL)
+                      : data_append(first, key, pretty_key, type, value.v_int, NULL);
+    else if (type == DATA_DOUBLE)
+        return format ? data_append(first, key, pretty_key, DATA_FORMAT, format, type, value.v_dbl, NULL)
+                      : data_append(first, key, pretty_key, type, value.v_dbl, NULL);
+    else
+        return format ? data_append(first, key, pretty_key, DATA_FORMAT, format, type, value.v_ptr, NULL)
+                      : data_append(first, key, pretty_key, type, value.v_ptr, NULL);
+}
+
+static data_t *unpack_data(unpack_t *u)
+{
+    data_t *first = NULL;
+    while (!u->err) {
+        uint8_t type = unpack_u8(u);
+        if (u->err || type == PACK_END)
+            break;
+        char *key        = unpack_str(u);
+        char *pretty_key = unpack_str(u);
+        char *format     = unpack_str(u);
+        if (!key || !pretty_key)
+            u->err = 1;
+
+        if (!u->err) {
+            data_value_t value = {0};
+            switch (type) {
+            case DATA_INT:
+                unpack_bytes(u, &value.v_int, sizeof(value.v_int));
+                break;
+            case DATA_DOUBLE:
+                unpack_bytes(u, &value.v_dbl, sizeof(value.v_dbl));
+                break;
+            case DATA_STRING:
+                value.v_ptr = unpack_str(u);
+                if (!value.v_ptr)
+                    u->err = 1;
+                break;
+            case DATA_DATA:
+                value.v_ptr = unpack_data(u);
+                break;
+            case DATA_ARRAY:
+                value.v_ptr = unpack_array(u);
+                break;
+            default:
+                u->err = 1;
+            }
+
+            if (!u->err) {
+                first = append_field(first, key, pretty_key, format, type, value);
+                if (!first)
+                    u->err = 1; // data_append() freed the list and the value
+            }
+            if (type == DATA_STRING)
+                free(value.v_ptr); // the string was copied
+        }
+        free(key);
+        free(pretty_key);
+        free(format);
+    }
+    if (u->err) {
+        data_free(first);
+        return NULL;
+    }
+    return first;
+}
+
+data_t *batch_unpack(char const *buf, size_t len)
+{
+    unpack_t u = {.p = buf, .end = buf + len};
+    data_t *data = unpack_data(&u);
+    if (u.err || u.p != u.end) {
+        data_free(data);
+        return NULL;
+    }
+    return data;
+}
+
+/* Splitting files at silent gaps */
+
+#define SCAN_SUB_SAMPLES    16   ///< samples averaged for the power of a sub-window
+#define SCAN_HIST_BINS      400  ///< window power histogram from -150 dB to +50 dB in 0.5 dB steps
+#define SCAN_MIN_SEGMENT_S  10   ///< shortest segment in seconds
+#define SCAN_THRESHOLD_DB   10   ///< level above the noise floor for active windows
+
+static void batch_push_input(list_t *inputs, char *filename, uint64_t start, uint64_t end)
+{
+    batch_input_t *input = calloc(1, sizeof(*input));
+    if (!input)
+        FATAL_CALLOC("batch_push_input()");
+    input->filename = filename;
+    input->start    = start;
+    input->end      = end;
+    list_push(inputs, input);
+}
+
+/// Mean power of @p n samples, relative to full scale.
+static float scan_power(unsigned char const *buf, uint32_t format, unsigned n)
+{
+    float sum = 0.0f;
+    if (format == CU8_IQ) {
+        for (unsigned i = 0; i < 2 * n; ++i) {
+            float v = (buf[i] - 127.5f) * (1.0f / 128);
+            sum += v * v;
+        }
+    }
+    else if (format == CS8_IQ) {
+        int8_t const *s8 = (int8_t const *)buf;
+        for (unsigned i = 0; i < 2 * n; ++i) {
+            float v = s8[i] * (1.0f / 128);
+            sum += v * v;
+        }
+    }
+    else if (format == CS16_IQ) {
+        int16_t const *s16 = (int16_t const *)buf;
+        for (unsigned i = 0; i < 2 * n; ++i) {
+            float v = s16[i] * (1.0f / 32768);
+            sum += v * v;
+        }
+    }
+    else { // CF32_IQ
+        float const *f32 = (float const *)buf;
+        for (unsigned i = 0; i < 2 * n; ++i)
+            sum += f32[i] * f32[i];
+    }
+    return sum / n;
+}
+
+int batch_split_file(list_t *inputs, char *filename, char const *path, uint32_t format, uint32_t samp_rate, int segments)
+{
+    unsigned sample_bytes = format == CU8_IQ || format == CS8_IQ ? 2
+            : format == CS16_IQ                                 ? 4
+            : format == CF32_IQ                                 ? 8
+                                                                : 0;
+    unsigned win_samples = samp_rate / 1000; // 1 ms windows
+    FILE *file = sample_bytes && win_samples >= SCAN_SUB_SAMPLES ? fopen(path, "rb") : NULL;
+    file_map_t map = {0};
+    if (!file || file_map_open(&map, file) != 0) {
+        if (file)
+            fclose(file);
+        batch_push_input(inputs, filename, 0, 0);
+        return 1;
+    }
+
+    // Power of each window, the loudest sub-window counts to not miss short pulses
+    uint64_t num_samples = map.len / sample_bytes;
+    size_t num_windows   = (size_t)(num_samples / win_samples);
+    float *win_power     = calloc(num_windows + 1, sizeof(*win_power));
+    if (!win_power)
+        FATAL_CALLOC("batch_split_file()");
+    unsigned hist[SCAN_HIST_BINS] = {0};
+    for (size_t w = 0; w < num_windows; ++w) {
+        size_t offset = (size_t)w * win_samples * sample_bytes;
+        file_map_advise(&map, offset, win_samples * sample_bytes);
+        float max_power = 0.0f;
+        for (unsigned i = 0; i + SCAN_SUB_SAMPLES <= win_samples; i += SCAN_SUB_SAMPLES) {
+            float power = scan_power(map.data + offset + i * sample_bytes, format, SCAN_SUB_SAMPLES);
+            if (power > max_power)
+                max_power = power;
+        }
+        win_power[w] = max_power;
+        int bin = (int)((10.0f * log10f(max_power + 1e-20f) + 150.0f) * 2.0f);
+        hist[bin < 0 ? 0 : bin >= SCAN_HIST_BINS ? SCAN_HIST_BINS - 1 : bin]++;
+    }
+    file_map_close(&map);
+    fclose(file);
+
+    // The noise floor is the 5th percentile of the window power, windows well above are active
+    size_t count = 0;
+    int floor_bin = 0;
+    while (floor_bin < SCAN_HIST_BINS - 1 && (count += hist[floor_bin]) < num_windows / 20)
+        floor_bin++;
+    float threshold = powf(10.0f, (floor_bin / 2.0f - 150.0f + SCAN_THRESHOLD_DB) / 10.0f);
+
+    uint64_t min_len = num_samples / (segments > 0 ? segments : 1);
+    if (min_len < (uint64_t)SCAN_MIN_SEGMENT_S * samp_rate)
+        min_len = (uint64_t)SCAN_MIN_SEGMENT_S * samp_rate;
+    unsigned min_gap = 3 * PD_MAX_GAP_MS; // in windows
+    int added        = 0;
+    uint64_t start   = 0;
+    size_t quiet     = 0;
+    for (size_t w = 0; w < num_windows; ++w) {
+        if (win_power[w] < threshold) {
+            quiet++;
+            continue;
+        }
+        if (quiet >= min_gap) {
+            uint64_t cut = (uint64_t)(w - quiet / 2) * win_samples;
+            if (cut - start >= min_len && num_samples - cut >= min_len / 2) {
+                batch_push_input(inputs, filename, start, cut);
+                added++;
+                start = cut;
+            }
+        }
+        quiet = 0;
+    }
+    batch_push_input(inputs, filename, start, 0);
+    added++;
+
+    free(win_power);
+    return added;
+}
+
+#ifndef _WIN32
+
+/* Stats counters of a worker, sent in a flagged frame after the events, in native byte order.
+   The decoder counters follow as BATCH_DEV_COUNTERS unsigned values per decoder. */
+
+#define BATCH_FRAME_STATS   0x80000000u ///< frame length flag for the worker stats
+#define BATCH_DEV_COUNTERS  8 ///< events, ok, messages and the 5 fail counters
+
+typedef struct {
+    unsigned frames_count;
+    unsigned frames_fsk;
+    unsigned frames_events;
+    unsigned dedup_lookups;
+    unsigned dedup_hits;
+    unsigned num_devs;
+    pipeline_metrics_t metrics;
+} batch_stats_t;
+
+/// Clear the counters a worker inherited from the main process, the main process adds what the worker sends back.
+static void batch_stats_reset(r_cfg_t *cfg)
+{
+    cfg->frames_count  = 0;
+    cfg->frames_fsk    = 0;
+    cfg->frames_events = 0;
+    if (cfg->dedup) {
+        cfg->dedup->lookups = 0;
+        cfg->dedup->hits    = 0;
+    }
+    metrics_init(&cfg->metrics);
+    for (void **iter = cfg->demod->r_devs.elems; iter && *iter; ++iter) {
+        r_device *r_dev = *iter;
+        r_dev->decode_events   = 0;
+        r_dev->decode_ok       = 0;
+        r_dev->decode_messages = 0;
+        memset(r_dev->decode_fails, 0, sizeof(r_dev->decode_fails));
+    }
+}
+
+/// Add the stats of a worker, the decoder list is the same as in the worker.
+static void batch_stats_merge(r_cfg_t *cfg, char const *buf, size_t len)
+{
+    batch_stats_t stats;
+    list_t *r_devs = &cfg->demod->r_devs;
+    if (len < sizeof(stats))
+        return;
+    memcpy(&stats, buf, sizeof(stats));
+    if (stats.num_devs != r_devs->len || len != sizeof(stats) + stats.num_devs * BATCH_DEV_COUNTERS * sizeof(unsigned))
+        return;
+
+    cfg->frames_count += stats.frames_count;
+    cfg->frames_fsk += stats.frames_fsk;
+    cfg->frames_events += stats.frames_events;
+    if (cfg->dedup) {
+        cfg->dedup->lookups += stats.dedup_lookups;
+        cfg->dedup->hits += stats.dedup_hits;
+    }
+    metrics_merge(&cfg->metrics, &stats.metrics);
+
+    buf += sizeof(stats);
+    for (size_t i = 0; i < r_devs->len; ++i) {
+        r_device *r_dev = r_devs->elems[i];
+        unsigned counters[BATCH_DEV_COUNTERS];
+        memcpy(counters, buf + i * sizeof(counters), sizeof(counters));
+        r_dev->decode_events += counters[0];
+        r_dev->decode_ok += counters[1];
+        r_dev->decode_messages += counters[2];
+        for (int j = 0; j < 5; ++j)
+            r_dev->decode_fails[j] += counters[3 + j];
+    }
+}
+
+/* Worker side, an output which sends each event to the main process */
+
+typedef struct {
+    struct data_output output;
+    int fd;
+    char *buf;
+    size_t size;
+} data_output_batch_t;
+
+static void write_all(data_output_batch_t *batch, char const *buf, size_t len)
+{
+    while (len && batch->fd >= 0) {
+        ssize_t n = write(batch->fd, buf, len);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            perror("Batch worker write");
+            close(batch->fd);
+            batch->fd = -1;
+            return;
+        }
+        buf += n;
+        len -= (size_t)n;
+    }
+}
+
+static void R_API_CALLCONV print_batch_data(data_output_t *output, data_t *data, char const *format)
+{
+    UNUSED(format);
+    data_output_batch_t *batch = (data_output_batch_t *)output;
+
+    // a frame is the packed length followed by the packed event
+    size_t len = batch_pack(data, batch->buf + sizeof(uint32_t), batch->size - sizeof(uint32_t));
+    if (len + sizeof(uint32_t) > batch->size) {
+        char *buf = realloc(batch->buf, len + sizeof(uint32_t));
+        if (!buf) {
+            WARN_REALLOC("print_batch_data()");
+            return;
+        }
+        batch->buf  = buf;
+        batch->size = len + sizeof(uint32_t);
+        batch_pack(data, batch->buf + sizeof(uint32_t), batch->size - sizeof(uint32_t));
+    }
+    uint32_t frame_len = (uint32_t)len;
+    memcpy(batch->buf, &frame_len, sizeof(frame_len));
+    write_all(batch, batch->buf, len + sizeof(uint32_t));
+}
+
+static void R_API_CALLCONV data_output_batch_free(data_output_t *output)
+{
+    data_output_batch_t *batch = (data_output_batch_t *)output;
+
+    if (batch->fd >= 0)
+        close(batch->fd);
+    free(batch->buf);
+    free(batch);
+}
+
+/// Send the stats of the worker, the main process times the outputs itself.
+static void batch_send_stats(data_output_batch_t *batch, r_cfg_t *cfg)
+{
+    list_t *r_devs = &cfg->demod->r_devs;
+    batch_stats_t stats = {
+            .frames_count  = cfg->frames_count,
+            .frames_fsk    = cfg->frames_fsk,
+            .frames_events = cfg->frames_events,
+            .dedup_lookups = cfg->dedup ? cfg->dedup->lookups : 0,
+            .dedup_hits    = cfg->dedup ? cfg->dedup->hits : 0,
+            .num_devs      = (unsigned)r_devs->len,
+            .metrics       = cfg->metrics,
+    };
+    stats.metrics.stage_seconds[METRICS_STAGE_OUTPUT] = 0.0;
+    stats.metrics.output_wall_seconds                 = 0.0;
+    memset(&stats.metrics.latency[METRICS_LATENCY_OUTPUT], 0, sizeof(metrics_latency_t));
+    memset(&stats.metrics.latency_interval[METRICS_LATENCY_OUTPUT], 0, sizeof(metrics_latency_t));
+    memset(stats.metrics.output_latency, 0, sizeof(stats.metrics.output_latency));
+
+    size_t len = sizeof(stats) + r_devs->len * BATCH_DEV_COUNTERS * sizeof(unsigned);
+    char *buf = malloc(sizeof(uint32_t) + len);
+    if (!buf) {
+        WARN_MALLOC("batch_send_stats()");
+        return;
+    }
+    uint32_t frame_len = (uint32_t)len | BATCH_FRAME_STATS;
+    memcpy(buf, &frame_len, sizeof(frame_len));
+    memcpy(buf + sizeof(uint32_t), &stats, sizeof(stats));
+    char *p = buf + sizeof(uint32_t) + sizeof(stats);
+    for (size_t i = 0; i < r_devs->len; ++i) {
+        r_device *r_dev = r_devs->elems[i];
+        unsigned counters[BATCH_DEV_COUNTERS] = {r_dev->decode_events, r_dev->decode_ok, r_dev->decode_messages};
+        memcpy(&counters[3], r_dev->decode_fails, sizeof(r_dev->decode_fails));
+        memcpy(p, counters, sizeof(counters));
+        p += sizeof(counters);
+    }
+    write_all(batch, buf, sizeof(uint32_t) + len);
+    free(buf);
+}
+
+static data_output_t *data_output_batch_create(int fd)
+{
+    data_output_batch_t *batch = calloc(1, sizeof(data_output_batch_t));
+    if (!batch)
+        FATAL_CALLOC("data_output_batch_create()");
+
+    batch->output.print_data  = print_batch_data;
+    batch->output.output_free = data_output_batch_free;
+    batch->fd                 = fd;
+    batch->size               = 1024;
+    batch->buf                = malloc(batch->size);
+    if (!batch->buf)
+        FATAL_MALLOC("data_output_batch_create()");
+
+    return &batch->output;
+}
+
+static void batch_worker(r_cfg_t *cfg, int fd, batch_input_t const *input, batch_input_fn process, void *ctx)
+{
+    // Replace the outputs, but don't free them: network outputs share their connections with the main process.
+    // Raw outputs can't be shared between processes.
+    list_t outputs = {0};
+    list_push(&outputs, data_output_batch_create(fd));
+    cfg->output_handler = outputs;
+    cfg->raw_handler    = (list_t){0};
+    batch_stats_reset(cfg);
+
+    int ret = process(cfg, input, ctx);
+
+    batch_send_stats(outputs.elems[0], cfg);
+    data_output_free(outputs.elems[0]);
+    _exit(ret ? 1 : 0);
+}
+
+/* Main process side, collects events from the workers */
+
+typedef struct {
+    batch_input_t const *input;
+    pid_t pid;
+    int fd;     ///< read end of the pipe, -1 once the worker is done
+    int failed;
+    char *buf;  ///< received bytes not yet printed
+    size_t len;
+    size_t size;
+} batch_job_t;
+
+static int batch_job_start(r_cfg_t *cfg, batch_job_t *jobs, int idx, batch_input_fn process, void *ctx)
+{
+    batch_job_t *job = &jobs[idx];
+
+    int fds[2];
+    if (pipe(fds) != 0) {
+        perror("Batch pipe");
+        return -1;
+    }
+
+    fflush(NULL); // don't duplicate buffered output
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("Batch fork");
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        for (int i = 0; i < idx; ++i)
+            if (jobs[i].fd >= 0)
+                close(jobs[i].fd);
+        batch_worker(cfg, fds[1], job->input, process, ctx);
+    }
+
+    close(fds[1]);
+    job->pid = pid;
+    job->fd  = fds[0];
+    return 0;
+}
+
+/// Read from a worker, returns 0 once the worker has closed the pipe.
+static int batch_job_read(batch_job_t *job)
+{
+    if (job->size - job->len < 4096) {
+        size_t size = job->size ? job->size * 2 : 65536;
+        char *buf = realloc(job->buf, size);
+        if (!buf)
+            FATAL_REALLOC("batch_job_read()");
+        job->buf  = buf;
+        job->size = size;
+    }
+
+    ssize_t n = read(job->fd, job->buf + job->len, job->size - job->len);
+    if (n < 0 && (errno == EINTR || errno == EAGAIN))
+        return 1;
+    if (n > 0) {
+        job->len += (size_t)n;
+        return 1;
+    }
+    if (n < 0)
+        perror("Batch read");
+
+    close(job->fd);
+    job->fd = -1;
+
+    int status = 0;
+    while (waitpid(job->pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    job->failed = !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+    if (job->failed)
+        fprintf(stderr, "Batch: processing \"%s\" failed\n", job->input->filename);
+    return 0;
+}
+
+/// Print all complete events received from a worker, merge its stats.
+static void batch_job_print(r_cfg_t *cfg, batch_job_t *job)
+{
+    size_t pos = 0;
+    while (job->len - pos >= sizeof(uint32_t)) {
+        uint32_t frame_len;
+        memcpy(&frame_len, job->buf + pos, sizeof(frame_len));
+        int is_stats = (frame_len & BATCH_FRAME_STATS) != 0;
+        frame_len &= ~BATCH_FRAME_STATS;
+        if (job->len - pos - sizeof(uint32_t) < frame_len)
+            break;
+        pos += sizeof(uint32_t);
+
+        if (is_stats) {
+            batch_stats_merge(cfg, job->buf + pos, frame_len);
+        }
+        else {
+            data_t *data = batch_unpack(job->buf + pos, frame_len);
+            if (data)
+                event_forward_handler(cfg, data); // frees the data
+            else
+                fprintf(stderr, "Batch: malformed event from \"%s\"\n", job->input->filename);
+        }
+        pos += frame_len;
+    }
+
+    job->len -= pos;
+    if (job->len)
+        memmove(job->buf, job->buf + pos, job->len);
+}
+
+int batch_run(r_cfg_t *cfg, list_t *inputs, int jobs, int ordered, batch_input_fn process, void *ctx)
+{
+    int num_jobs = (int)inputs->len;
+    batch_job_t *job = calloc(num_jobs, sizeof(*job));
+    if (!job)
+        FATAL_CALLOC("batch_run()");
+    struct pollfd *pfd = calloc(jobs, sizeof(*pfd));
+    if (!pfd)
+        FATAL_CALLOC("batch_run()");
+    int *pfd_job = calloc(jobs, sizeof(*pfd_job));
+    if (!pfd_job)
+        FATAL_CALLOC("batch_run()");
+
+    for (int i = 0; i < num_jobs; ++i) {
+        job[i].input = inputs->elems[i];
+        job[i].fd       = -1;
+    }
+
+    int started = 0; // jobs started
+    int running = 0; // jobs with an open pipe
+    int printed = 0; // jobs completely printed, in ordered mode
+    int failed  = 0;
+    while ((started < num_jobs && !cfg->exit_async) || running) {
+        while (running < jobs && started < num_jobs && !cfg->exit_async) {
+            if (batch_job_start(cfg, job, started, process, ctx) == 0)
+                running++;
+            else
+                job[started].failed = 1;
+            started++;
+        }
+
+        int nfds = 0;
+        for (int i = 0; i < started; ++i) {
+            if (job[i].fd >= 0) {
+                pfd[nfds].fd     = job[i].fd;
+                pfd[nfds].events = POLLIN;
+                pfd_job[nfds]    = i;
+                nfds++;
+            }
+        }
+        if (nfds && poll(pfd, nfds, -1) < 0 && errno != EINTR) {
+            perror("Batch poll");
+            break;
+        }
+        for (int i = 0; i < nfds; ++i) {
+            if (pfd[i].revents && !batch_job_read(&job[pfd_job[i]]))
+                running--;
+        }
+
+        // a job is complete once its pipe is closed
+        if (ordered) {
+            while (printed < started) {
+                batch_job_t *j = &job[printed];
+                batch_job_print(cfg, j);
+                if (j->fd >= 0)
+                    break;
+                free(j->buf);
+                j->buf = NULL;
+                printed++;
+            }
+        }
+        else {
+            for (int i = 0; i < started; ++i) {
+                if (job[i].buf)
+                    batch_job_print(cfg, &job[i]);
+                if (job[i].fd < 0) {
+                    free(job[i].buf);
+                    job[i].buf = NULL;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < num_jobs; ++i) {
+        failed += job[i].failed;
+        free(job[i].buf);
+    }
+    if (failed)
+        fprintf(stderr, "Batch: %d of %d inputs failed\n", failed, num_jobs);
+
+    free(pfd_job);
+    free(pfd);
+    free(job);
+    return failed;
+}
+
+#else
+
+int batch_run(r_cfg_t *cfg, list_t *inputs, int jobs, int ordered, batch_input_fn process, void *ctx)
+{
+    UNUSED(jobs);
+    UNUSED(ordered);
+    fprintf(stderr, "Parallel batch mode is not supported on this platform, reading files one by one.\n");
+
+    int failed = 0;
+    for (void **iter = inputs->elems; iter && *iter && !cfg->exit_async; ++iter) {
+        failed += process(cfg, *iter, ctx) != 0;
+    }
+    return failed;
+}
+
+#endif
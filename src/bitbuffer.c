@@ -10,15 +10,97 @@
 */
 
 #include "bitbuffer.h"
+#include "fatal.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__) || defined(__clang__)
+#define THREAD_LOCAL __thread
+#else
+#define THREAD_LOCAL
+#endif
+
+// Released scratch bitbuffers are kept cleared in a free list per thread, decoders reuse them without allocations.
+#define BITBUFFER_POOL_KEEP 8 // bitbuffers kept per thread
+
+typedef struct bitbuffer_block {
+    struct bitbuffer_block *next;
+} bitbuffer_block_t;
+
+static THREAD_LOCAL bitbuffer_block_t *bitbuffer_pool;
+static THREAD_LOCAL unsigned bitbuffer_pool_count;
+
 void bitbuffer_clear(bitbuffer_t *bits)
 {
     memset(bits, 0, sizeof(*bits));
 }
 
+bitbuffer_t *bitbuffer_acquire(void)
+{
+    if (bitbuffer_pool) {
+        bitbuffer_block_t *block = bitbuffer_pool;
+        bitbuffer_pool           = block->next;
+        bitbuffer_pool_count--;
+        block->next = NULL; // the free list link overlays the header
+        return (bitbuffer_t *)block;
+    }
+    bitbuffer_t *bits = calloc(1, sizeof(*bits));
+    if (!bits)
+        FATAL_CALLOC("bitbuffer_acquire()");
+    return bits;
+}
+
+void bitbuffer_release(bitbuffer_t *bits)
+{
+    bitbuffer_release_used(bits, 0);
+}
+
+void bitbuffer_release_used(bitbuffer_t *bits, unsigned bytes_used)
+{
+    if (!bits)
+        return;
+    if (bitbuffer_pool_count >= BITBUFFER_POOL_KEEP) {
+        free(bits);
+        return;
+    }
+
+    // only clear the rows in use, long rows spill into the following rows
+    unsigned used_rows = bits->free_row > bits->num_rows ? bits->free_row : bits->num_rows;
+    for (unsigned row = 0; row < bits->num_rows && row < BITBUF_ROWS; ++row) {
+        unsigned end = row + (bits->bits_per_row[row] + BITBUF_COLS * 8 - 1) / (BITBUF_COLS * 8);
+        if (end > used_rows)
+            used_rows = end;
+    }
+    unsigned direct_rows = (bytes_used + BITBUF_COLS - 1) / BITBUF_COLS;
+    if (direct_rows > used_rows)
+        used_rows = direct_rows;
+    if (used_rows > BITBUF_ROWS)
+        used_rows = BITBUF_ROWS;
+    memset(bits->bb, 0, used_rows * sizeof(bits->bb[0]));
+    memset(bits->bits_per_row, 0, sizeof(bits->bits_per_row));
+    memset(bits->syncs_before_row, 0, sizeof(bits->syncs_before_row));
+    bits->num_rows = 0;
+    bits->free_row = 0;
+
+    bitbuffer_block_t *block = (bitbuffer_block_t *)bits;
+    block->next              = bitbuffer_pool;
+    bitbuffer_pool           = block;
+    bitbuffer_pool_count++;
+}
+
+void bitbuffer_pool_free(void)
+{
+    while (bitbuffer_pool) {
+        bitbuffer_block_t *block = bitbuffer_pool;
+        bitbuffer_pool           = block->next;
+        free(block);
+    }
+    bitbuffer_pool_count = 0;
+}
+
 void bitbuffer_add_bit(bitbuffer_t *bits, int bit)
 {
     if (bits->num_rows == 0)
@@ -595,6 +677,40 @@ int main(void)
     bitbuffer_add_bit(&bits, 1);
     bitbuffer_print(&bits);
 
+    fprintf(stderr, "TEST: bitbuffer:: Pool returns cleared buffers\n");
+    bitbuffer_t *pooled = bitbuffer_acquire();
+    ASSERT(pooled->num_rows == 0);
+    bitbuffer_add_row(pooled);
+    for (int i = 0; i < BITBUF_COLS * 8 * 2 + 5; ++i) {
+        bitbuffer_add_bit(pooled, 1); // spills into the next two rows
+    }
+    bitbuffer_add_sync(pooled);
+    bitbuffer_release(pooled);
+    bitbuffer_t *reused = bitbuffer_acquire();
+    ASSERT(reused == pooled);
+    int dirty = reused->num_rows || reused->free_row;
+    for (int i = 0; i < BITBUF_ROWS; ++i) {
+        dirty |= reused->bits_per_row[i] | reused->syncs_before_row[i];
+        for (int j = 0; j < BITBUF_COLS; ++j) {
+            dirty |= reused->bb[i][j];
+        }
+    }
+    ASSERT(!dirty);
+
+    fprintf(stderr, "TEST: bitbuffer:: Pool clears directly written bytes\n");
+    memset(reused->bb[0], 0xff, BITBUF_COLS * 2 + 3); // spills into the next two rows
+    bitbuffer_release_used(reused, BITBUF_COLS * 2 + 3);
+    reused = bitbuffer_acquire();
+    ASSERT(reused == pooled);
+    for (int i = 0; i < BITBUF_ROWS; ++i) {
+        for (int j = 0; j < BITBUF_COLS; ++j) {
+            dirty |= reused->bb[i][j];
+        }
+    }
+    ASSERT(!dirty);
+    bitbuffer_release(reused);
+    bitbuffer_pool_free();
+
     fprintf(stderr, "bitbuffer:: test (%u/%u) passed, (%u) failed.\n", passed, passed + failed, failed);
 
     return failed > 0 ? 1 : 0;
@@ -0,0 +1,237 @@
+/** @file
+    Burst store, an append-only file of detected I/Q bursts with an index.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "burst_store.h"
+#include "fileformat.h"
+#include "le_util.h"
+#include "fatal.h"
+
+#define FILE_HEADER_SIZE   16
+#define RECORD_HEADER_SIZE 50
+#define RECORD_SAMPLES_MAX (256 * 1024 * 1024) // bytes of samples in a record, if the file size is unknown
+
+static char const file_magic[8]   = {'R', 'T', 'L', '4', '3', '3', 'B', 'S'};
+static char const record_magic[4] = {'B', 'R', 'S', 'T'};
+
+unsigned burst_sample_size(uint32_t format)
+{
+    if (format == CU8_IQ)
+        return 2;
+    if (format == CS16_IQ)
+        return 4;
+    return 0;
+}
+
+burst_store_t *burst_store_open(char const *path, int overwrite)
+{
+    burst_store_t *store = calloc(1, sizeof(*store));
+    if (!store) {
+        WARN_CALLOC("burst_store_open()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+
+    store->file = fopen(path, overwrite ? "w+b" : "a+b");
+    if (!store->file) {
+        fprintf(stderr, "Failed to open %s\n", path);
+        free(store);
+        return NULL;
+    }
+
+    // an existing store is appended to, check that it really is one
+    fseek(store->file, 0, SEEK_END);
+    long len = ftell(store->file);
+    if (len > 0) {
+        rewind(store->file);
+        if (burst_store_read_header(store->file) != 0) {
+            fprintf(stderr, "Not a burst store, refusing to append to %s\n", path);
+            fclose(store->file);
+            free(store);
+            return NULL;
+        }
+        fseek(store->file, 0, SEEK_END);
+    }
+    else {
+        uint8_t header[FILE_HEADER_SIZE] = {0};
+        memcpy(header, file_magic, sizeof(file_magic));
+        put_u32(&header[8], BURST_STORE_VERSION);
+        fwrite(header, 1, sizeof(header), store->file);
+        len = FILE_HEADER_SIZE;
+    }
+    store->offset = (uint64_t)len;
+
+    size_t path_len  = strlen(path);
+    char *index_path = malloc(path_len + 5);
+    if (!index_path) {
+        WARN_MALLOC("burst_store_open()");
+        fclose(store->file);
+        free(store);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    memcpy(index_path, path, path_len);
+    memcpy(&index_path[path_len], ".idx", 5);
+    store->index = fopen(index_path, overwrite ? "wb" : "ab");
+    if (!store->index) {
+        fprintf(stderr, "Failed to open %s\n", index_path);
+        free(index_path);
+        fclose(store->file);
+        free(store);
+        return NULL;
+    }
+    free(index_path);
+
+    return store;
+}
+
+int burst_store_write(burst_store_t *store, burst_info_t const *info,
+        void const *samples1, size_t len1, void const *samples2, size_t len2)
+{
+    size_t models_len = strnlen(info->models, BURST_STORE_MODELS_MAX - 1);
+    uint8_t header[RECORD_HEADER_SIZE + BURST_STORE_MODELS_MAX];
+    memcpy(header, record_magic, sizeof(record_magic));
+    put_u32(&header[4], (uint32_t)(RECORD_HEADER_SIZE + models_len));
+    put_u64(&header[8], info->time_us);
+    put_u32(&header[16], info->center_frequency);
+    put_u32(&header[20], info->sample_rate);
+    put_u32(&header[24], info->format);
+    put_u32(&header[28], info->num_samples);
+    put_f32(&header[32], info->rssi_db);
+    put_f32(&header[36], info->snr_db);
+    put_f32(&header[40], info->noise_db);
+    put_u32(&header[44], info->events);
+    put_u16(&header[48], (uint16_t)models_len);
+    memcpy(&header[RECORD_HEADER_SIZE], info->models, models_len);
+
+    size_t header_len = RECORD_HEADER_SIZE + models_len;
+    if (fwrite(header, 1, header_len, store->file) != header_len
+            || (len1 && fwrite(samples1, 1, len1, store->file) != len1)
+            || (len2 && fwrite(samples2, 1, len2, store->file) != len2)
+            || fflush(store->file) != 0) {
+        fprintf(stderr, "Short write on burst store\n");
+        return -1;
+    }
+
+    // the index entry goes out after the record is complete
+    uint8_t entry[BURST_STORE_INDEX_SIZE];
+    put_u64(&entry[0], store->offset);
+    put_u64(&entry[8], info->time_us);
+    put_u32(&entry[16], info->center_frequency);
+    put_u32(&entry[20], info->num_samples);
+    put_u32(&entry[24], info->events);
+    put_f32(&entry[28], info->rssi_db);
+    if (fwrite(entry, 1, sizeof(entry), store->index) != sizeof(entry)
+            || fflush(store->index) != 0) {
+        fprintf(stderr, "Short write on burst store index\n");
+        return -1;
+    }
+
+    store->offset += header_len + len1 + len2;
+    store->count++;
+    return 0;
+}
+
+void burst_store_close(burst_store_t *store)
+{
+    if (!store)
+        return;
+    if (store->file)
+        fclose(store->file);
+    if (store->index)
+        fclose(store->index);
+    free(store);
+}
+
+int burst_store_read_header(FILE *file)
+{
+    uint8_t header[FILE_HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header)
+            || memcmp(header, file_magic, sizeof(file_magic))
+            || get_u32(&header[8]) != BURST_STORE_VERSION)
+        return -1;
+    return 0;
+}
+
+long burst_store_read(FILE *file, burst_info_t *info, uint8_t **buf, size_t *buf_size)
+{
+    uint8_t header[RECORD_HEADER_SIZE + BURST_STORE_MODELS_MAX];
+    size_t n = fread(header, 1, 8, file);
+    if (n == 0)
+        return 0; // end of file
+    if (n != 8 || memcmp(header, record_magic, sizeof(record_magic)))
+        return -1;
+
+    uint32_t header_len = get_u32(&header[4]);
+    if (header_len < RECORD_HEADER_SIZE || header_len > sizeof(header)
+            || fread(&header[8], 1, header_len - 8, file) != header_len - 8)
+        return -1;
+
+    *info = (burst_info_t){0};
+    info->time_us          = get_u64(&header[8]);
+    info->center_frequency = get_u32(&header[16]);
+    info->sample_rate      = get_u32(&header[20]);
+    info->format           = get_u32(&header[24]);
+    info->num_samples      = get_u32(&header[28]);
+    info->rssi_db          = get_f32(&header[32]);
+    info->snr_db           = get_f32(&header[36]);
+    info->noise_db         = get_f32(&header[40]);
+    info->events           = get_u32(&header[44]);
+    uint16_t models_len    = get_u16(&header[48]);
+    if (models_len >= BURST_STORE_MODELS_MAX || (uint32_t)RECORD_HEADER_SIZE + models_len > header_len)
+        return -1;
+    memcpy(info->models, &header[RECORD_HEADER_SIZE], models_len);
+    info->models[models_len] = '\0';
+
+    unsigned sample_size = burst_sample_size(info->format);
+    if (!sample_size || !info->sample_rate)
+        return -1;
+    size_t len = (size_t)info->num_samples * sample_size;
+    // reject a corrupt sample count instead of allocating for it
+    long pos = ftell(file);
+    if (pos >= 0 && fseek(file, 0, SEEK_END) == 0) {
+        long end = ftell(file);
+        if (fseek(file, pos, SEEK_SET) != 0 || end < pos || len > (size_t)(end - pos))
+            return -1;
+    }
+    else if (len > RECORD_SAMPLES_MAX) {
+        return -1;
+    }
+    if (len > *buf_size) {
+        uint8_t *new_buf = realloc(*buf, len);
+        if (!new_buf)
+            FATAL_REALLOC("burst_store_read()");
+        *buf      = new_buf;
+        *buf_size = len;
+    }
+    if (fread(*buf, 1, len, file) != len)
+        return -1;
+
+    return (long)len;
+}
+
+int burst_store_read_index(FILE *index, unsigned num, uint64_t *offset, burst_info_t *info)
+{
+    uint8_t entry[BURST_STORE_INDEX_SIZE];
+    if (fseek(index, (long)num * BURST_STORE_INDEX_SIZE, SEEK_SET) != 0
+            || fread(entry, 1, sizeof(entry), index) != sizeof(entry))
+        return -1;
+
+    *offset = get_u64(&entry[0]);
+    *info   = (burst_info_t){0};
+    info->time_us          = get_u64(&entry[8]);
+    info->center_frequency = get_u32(&entry[16]);
+    info->num_samples      = get_u32(&entry[20]);
+    info->events           = get_u32(&entry[24]);
+    info->rssi_db          = get_f32(&entry[28]);
+    return 0;
+}
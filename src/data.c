@@ -350,6 +350,7 @@ R_API void data_output_print(data_output_t *output, data_t *data)
 {
     if (!output)
         return;
+    output->stats.events++;
     output->print_data(output, data, NULL);
 
     if (output->output_flush)
@@ -0,0 +1,331 @@
+/** @file
+    De-duplication of repeated events.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "data_dedup.h"
+#include "data.h"
+#include "optparse.h"
+#include "fatal.h"
+
+#define DEDUP_WINDOW_DEFAULT 1000 // ms
+#define DEDUP_CAPACITY_MIN   64
+
+struct data_dedup_entry {
+    uint64_t hash;       ///< 0 marks a slot never used
+    double expires;      ///< time the window closes, extended by each repeat
+    unsigned count;      ///< copies received
+    struct data *held;   ///< first copy, in collapse mode
+};
+
+/// Meta data which differs between copies of the same transmission.
+static char const *const meta_keys[] = {
+        "time",
+        "mod",
+        "freq",
+        "freq1",
+        "freq2",
+        "rssi",
+        "snr",
+        "noise",
+        NULL,
+};
+
+/// Identifying keys always compared.
+static char const *const id_keys[] = {
+        "model",
+        "id",
+        "channel",
+        NULL,
+};
+
+static int key_in(char const *key, char const *const *keys)
+{
+    for (; keys && *keys; ++keys)
+        if (!strcmp(key, *keys))
+            return 1;
+    return 0;
+}
+
+/* FNV-1a */
+
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME  0x100000001b3ULL
+
+static uint64_t hash_bytes(uint64_t h, void const *buf, size_t len)
+{
+    uint8_t const *p = buf;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= p[i];
+        h *= FNV_PRIME;
+    }
+    return h;
+}
+
+static uint64_t hash_str(uint64_t h, char const *str)
+{
+    return hash_bytes(h, str, strlen(str) + 1); // include the terminator to separate strings
+}
+
+static uint64_t hash_data(uint64_t h, data_t *data, char const *const *fields);
+
+static uint64_t hash_value(uint64_t h, data_type_t type, data_value_t value)
+{
+    switch (type) {
+    case DATA_INT:
+        return hash_bytes(h, &value.v_int, sizeof(value.v_int));
+    case DATA_DOUBLE:
+        return hash_bytes(h, &value.v_dbl, sizeof(value.v_dbl));
+    case DATA_STRING:
+        return hash_str(h, value.v_ptr);
+    case DATA_DATA:
+        return hash_data(h, value.v_ptr, NULL);
+    case DATA_ARRAY: {
+        data_array_t *array = value.v_ptr;
+        h = hash_bytes(h, &array->num_values, sizeof(array->num_values));
+        for (int i = 0; i < array->num_values; ++i) {
+            data_value_t v;
+            if (array->type == DATA_INT)
+                v.v_int = ((int *)array->values)[i];
+            else if (array->type == DATA_DOUBLE)
+                v.v_dbl = ((double *)array->values)[i];
+            else
+                v.v_ptr = ((void **)array->values)[i];
+            h = hash_value(h, array->type, v);
+        }
+        return h;
+    }
+    default:
+        return h;
+    }
+}
+
+/// Hash the identifying keys and either the given @p fields or all but meta data.
+static uint64_t hash_data(uint64_t h, data_t *data, char const *const *fields)
+{
+    for (data_t *d = data; d; d = d->next) {
+        if (fields ? !key_in(d->key, id_keys) && !key_in(d->key, fields) : key_in(d->key, meta_keys))
+            continue;
+        h = hash_str(h, d->key);
+        h = hash_value(h, d->type, d->value);
+    }
+    return h;
+}
+
+/* hash table with linear probing, expired entries are reused in place */
+
+static data_dedup_entry_t *dedup_find(data_dedup_t *dedup, uint64_t hash, double now, data_dedup_entry_t **free_slot)
+{
+    unsigned mask = dedup->capacity - 1;
+    *free_slot    = NULL;
+    for (unsigned i = (unsigned)hash & mask;; i = (i + 1) & mask) {
+        data_dedup_entry_t *e = &dedup->table[i];
+        if (!e->hash) {
+            if (!*free_slot)
+                *free_slot = e;
+            return NULL;
+        }
+        if (e->hash == hash)
+            return e;
+        if (!*free_slot && e->expires <= now && !e->held)
+            *free_slot = e;
+    }
+}
+
+static void dedup_resize(data_dedup_t *dedup, double now)
+{
+    unsigned live = data_dedup_entries(dedup, now);
+    unsigned capacity = dedup->capacity;
+    while (live * 4 > capacity)
+        capacity *= 2;
+
+    data_dedup_entry_t *table = calloc(capacity, sizeof(*table));
+    if (!table)
+        FATAL_CALLOC("dedup_resize()");
+
+    unsigned mask = capacity - 1;
+    for (unsigned i = 0; i < dedup->capacity; ++i) {
+        data_dedup_entry_t *e = &dedup->table[i];
+        if (!e->hash || (e->expires <= now && !e->held))
+            continue;
+        unsigned j = (unsigned)e->hash & mask;
+        while (table[j].hash)
+            j = (j + 1) & mask;
+        table[j] = *e;
+    }
+
+    free(dedup->table);
+    dedup->table    = table;
+    dedup->capacity = capacity;
+    dedup->used     = live;
+}
+
+static data_t *dedup_release(data_dedup_t *dedup, data_dedup_entry_t *e)
+{
+    data_t *data = e->held;
+    e->held      = NULL;
+    dedup->held--;
+    data_append(data,
+            "dedup_count", "Copies", DATA_INT, e->count,
+            NULL);
+    return data;
+}
+
+data_t *data_dedup_apply(data_dedup_t *dedup, data_t *data, double now)
+{
+    dedup->lookups++;
+
+    uint64_t hash = hash_data(FNV_OFFSET, data, dedup->fields);
+    if (!hash)
+        hash = 1; // 0 marks unused slots
+
+    data_dedup_entry_t *free_slot;
+    data_dedup_entry_t *e = dedup_find(dedup, hash, now, &free_slot);
+
+    if (e && e->expires > now) {
+        // a repeat within the window
+        dedup->hits++;
+        e->count++;
+        e->expires = now + dedup->window;
+        data_free(data);
+        return NULL;
+    }
+
+    data_t *out = NULL;
+    if (e) {
+        // seen before, but the window has closed
+        if (e->held)
+            out = dedup_release(dedup, e);
+    }
+    else if (free_slot->hash) {
+        e = free_slot; // reuse an expired entry
+    }
+    else {
+        e = free_slot;
+        dedup->used++;
+    }
+
+    e->hash    = hash;
+    e->expires = now + dedup->window;
+    e->count   = 1;
+
+    if (dedup->collapse) {
+        e->held = data;
+        dedup->held++;
+    }
+    else {
+        out = data;
+    }
+
+    // keep the load below 1/2 to have short probe sequences
+    if (dedup->used * 2 > dedup->capacity)
+        dedup_resize(dedup, now);
+
+    return out;
+}
+
+data_t *data_dedup_expire(data_dedup_t *dedup, double now)
+{
+    if (!dedup->held)
+        return NULL;
+
+    for (unsigned i = 0; i < dedup->capacity; ++i) {
+        data_dedup_entry_t *e = &dedup->table[i];
+        if (e->held && (now < 0 || e->expires <= now))
+            return dedup_release(dedup, e);
+    }
+    return NULL;
+}
+
+unsigned data_dedup_entries(data_dedup_t *dedup, double now)
+{
+    unsigned live = 0;
+    for (unsigned i = 0; i < dedup->capacity; ++i) {
+        data_dedup_entry_t *e = &dedup->table[i];
+        if (e->hash && (e->expires > now || e->held))
+            live++;
+    }
+    return live;
+}
+
+size_t data_dedup_memory(data_dedup_t *dedup)
+{
+    return sizeof(*dedup) + dedup->capacity * sizeof(*dedup->table);
+}
+
+data_dedup_t *data_dedup_create(char *params)
+{
+    data_dedup_t *dedup = calloc(1, sizeof(*dedup));
+    if (!dedup)
+        FATAL_CALLOC("data_dedup_create()");
+
+    int window = DEDUP_WINDOW_DEFAULT;
+
+    char *key, *val;
+    while (getkwargs(&params, &key, &val)) {
+        key = remove_ws(key);
+        val = trim_ws(val);
+        if (!key || !*key)
+            continue;
+        else if (*key >= '0' && *key <= '9')
+            window = atoiv(key, DEDUP_WINDOW_DEFAULT);
+        else if (!strcasecmp(key, "w") || !strcasecmp(key, "window"))
+            window = atoiv(val, DEDUP_WINDOW_DEFAULT);
+        else if (!strcasecmp(key, "c") || !strcasecmp(key, "collapse"))
+            dedup->collapse = atobv(val, 1);
+        else if (!strcasecmp(key, "f") || !strcasecmp(key, "fields")) {
+            if (!val || !*val) {
+                fprintf(stderr, "Dedup fields missing.\n");
+                exit(1);
+            }
+            int num_fields = 2; // first field and terminator
+            for (char *p = val; *p; ++p)
+                num_fields += *p == '+';
+            free(dedup->fields);
+            dedup->fields = calloc(num_fields, sizeof(*dedup->fields));
+            if (!dedup->fields)
+                FATAL_CALLOC("data_dedup_create()");
+            for (int i = 0; val; ++i)
+                dedup->fields[i] = asepc(&val, '+'); // NOTE: points into the params
+        }
+        else {
+            fprintf(stderr, "Invalid key \"%s\" option.\n", key);
+            exit(1);
+        }
+    }
+    if (window <= 0) {
+        fprintf(stderr, "Dedup window must be positive.\n");
+        exit(1);
+    }
+    dedup->window = window / 1000.0;
+
+    dedup->capacity = DEDUP_CAPACITY_MIN;
+    dedup->table    = calloc(dedup->capacity, sizeof(*dedup->table));
+    if (!dedup->table)
+        FATAL_CALLOC("data_dedup_create()");
+
+    return dedup;
+}
+
+void data_dedup_free(data_dedup_t *dedup)
+{
+    if (!dedup)
+        return;
+
+    for (unsigned i = 0; i < dedup->capacity; ++i)
+        data_free(dedup->table[i].held);
+    free(dedup->table);
+    free(dedup->fields);
+    free(dedup);
+}
@@ -201,6 +201,8 @@ static int flex_callback(r_device *decoder, bitbuffer_t *bitbuffer)
     if (params->preamble_len) {
         r = -1;
         match_count = 0;
+        bitbuffer_t *tmp = bitbuffer_acquire();
+        unsigned tmp_used = 0; // bytes written to tmp
         for (i = 0; i < bitbuffer->num_rows; i++) {
             unsigned pos = bitbuffer_search(bitbuffer, i, 0, params->preamble_bits, params->preamble_len);
             if (pos < bitbuffer->bits_per_row[i]) {
@@ -210,25 +212,31 @@ static int flex_callback(r_device *decoder, bitbuffer_t *bitbuffer)
                 pos += params->preamble_len;
                 // TODO: refactor to bitbuffer_shift_row()
                 unsigned len = bitbuffer->bits_per_row[i] - pos;
-                bitbuffer_t tmp = {0};
-                bitbuffer_extract_bytes(bitbuffer, i, pos, tmp.bb[0], len);
-                memcpy(bitbuffer->bb[i], tmp.bb[0], (len + 7) / 8);
+                bitbuffer_extract_bytes(bitbuffer, i, pos, tmp->bb[0], len);
+                memcpy(bitbuffer->bb[i], tmp->bb[0], (len + 7) / 8);
                 bitbuffer->bits_per_row[i] = len;
+                if ((len + 7) / 8 > tmp_used)
+                    tmp_used = (len + 7) / 8;
             }
         }
+        bitbuffer_release_used(tmp, tmp_used);
         if (!match_count)
             return DECODE_FAIL_SANITY;
     }
 
     if (params->decode_uart) {
+        bitbuffer_t *tmp = bitbuffer_acquire();
+        unsigned tmp_used = 0; // bytes written to tmp
         for (i = 0; i < bitbuffer->num_rows; i++) {
             // TODO: refactor to bitbuffer_decode_uart_row()
             unsigned len = bitbuffer->bits_per_row[i];
-            bitbuffer_t tmp = {0};
-            len = extract_bytes_uart(bitbuffer->bb[i], 0, len, tmp.bb[0]);
-            memcpy(bitbuffer->bb[i], tmp.bb[0], len);
+            len = extract_bytes_uart(bitbuffer->bb[i], 0, len, tmp->bb[0]);
+            memcpy(bitbuffer->bb[i], tmp->bb[0], len);
             bitbuffer->bits_per_row[i] = len * 8;
+            if (len > tmp_used)
+                tmp_used = len;
         }
+        bitbuffer_release_used(tmp, tmp_used);
     }
 
     if (decoder->verbose) {
@@ -410,27 +418,26 @@ static unsigned parse_modulation(char const *str)
         return FSK_PULSE_MANCHESTER_ZEROBIT;
     else {
         fprintf(stderr, "Bad flex spec, unknown modulation!\n");
-        usage();
     }
     return 0;
 }
 
-// used for match, preamble, getter, limited to 1024 bits (128 byte).
-static unsigned parse_bits(const char *code, uint8_t *bitrow)
+// used for match, preamble, getter, limited to 1024 bits (128 byte), returns -1 on errors.
+static int parse_bits(const char *code, uint8_t *bitrow)
 {
     bitbuffer_t bits = {0};
     bitbuffer_parse(&bits, code);
     if (bits.num_rows != 1) {
         fprintf(stderr, "Bad flex spec, \"match\", \"preamble\", and getter mask need exactly one bit row (%d found)!\n", bits.num_rows);
-        usage();
+        return -1;
     }
     unsigned len = bits.bits_per_row[0];
     if (len > 1024) {
         fprintf(stderr, "Bad flex spec, \"match\", \"preamble\", and getter mask mayb have up to 1024 bits (%d found)!\n", len);
-        usage();
+        return -1;
     }
     memcpy(bitrow, bits.bb[0], (len + 7) / 8);
-    return len;
+    return (int)len;
 }
 
 static const char *parse_map(const char *arg, struct flex_get *getter)
@@ -475,7 +482,7 @@ static const char *parse_map(const char *arg, struct flex_get *getter)
     return c;
 }
 
-static void parse_getter(const char *arg, struct flex_get *getter)
+static int parse_getter(const char *arg, struct flex_get *getter)
 {
     uint8_t bitrow[128];
     while (arg && *arg) {
@@ -489,7 +496,10 @@ static void parse_getter(const char *arg, struct flex_get *getter)
         if (*arg == '@')
             getter->bit_offset = strtol(++arg, NULL, 0);
         else if (*arg == '{' || (*arg >= '0' && *arg <= '9')) {
-            getter->bit_count = parse_bits(arg, bitrow);
+            int len = parse_bits(arg, bitrow);
+            if (len < 0)
+                return -1;
+            getter->bit_count = len;
             getter->mask = extract_number(bitrow, 0, getter->bit_count);
         }
         else if (*arg == '%') {
@@ -506,45 +516,21 @@ static void parse_getter(const char *arg, struct flex_get *getter)
     }
     if (!getter->name) {
         fprintf(stderr, "Bad flex spec, \"get\" missing name!\n");
-        usage();
+        return -1;
     }
     /*
     if (decoder->verbose)
         fprintf(stderr, "parse_getter() bit_offset: %d bit_count: %d mask: %lx name: %s\n",
                 getter->bit_offset, getter->bit_count, getter->mask, getter->name);
     */
+    return 0;
 }
 
-// NOTE: this is declared in rtl_433.c also.
-r_device *flex_create_device(char *spec);
-
-r_device *flex_create_device(char *spec)
+/// Parse a flex spec into @p dev and @p params, prints the error and returns -1 on bad specs.
+static int parse_spec(char *spec, r_device *dev, struct flex_params *params)
 {
-    if (!spec || !*spec || *spec == '?' || !strncasecmp(spec, "help", strlen(spec))) {
-        help();
-    }
-
-    struct flex_params *params = calloc(1, sizeof(*params));
-    if (!params) {
-        WARN_CALLOC("flex_create_device()");
-        return NULL; // NOTE: returns NULL on alloc failure.
-    }
-    r_device *dev = calloc(1, sizeof(*dev));
-    if (!dev) {
-        WARN_CALLOC("flex_create_device()");
-        free(params);
-        return NULL; // NOTE: returns NULL on alloc failure.
-    }
-    dev->decode_ctx = params;
     int get_count = 0;
 
-    spec = strdup(spec);
-    if (!spec)
-        FATAL_STRDUP("flex_create_device()");
-
-    dev->decode_fn = flex_callback;
-    dev->fields = output_fields;
-
     char *key, *val;
     while (getkwargs(&spec, &key, &val)) {
         key = remove_ws(key);
@@ -555,16 +541,19 @@ r_device *flex_create_device(char *spec)
         else if (!strcasecmp(key, "n") || !strcasecmp(key, "name")) {
             params->name = strdup(val);
             if (!params->name)
-                FATAL_STRDUP("flex_create_device()");
+                FATAL_STRDUP("parse_spec()");
             int name_size = strlen(val) + 27;
             dev->name = malloc(name_size);
             if (!dev->name)
-                FATAL_MALLOC("flex_create_device()");
+                FATAL_MALLOC("parse_spec()");
             snprintf(dev->name, name_size, "General purpose decoder '%s'", val);
         }
 
-        else if (!strcasecmp(key, "m") || !strcasecmp(key, "modulation"))
+        else if (!strcasecmp(key, "m") || !strcasecmp(key, "modulation")) {
             dev->modulation = parse_modulation(val);
+            if (!dev->modulation)
+                return -1;
+        }
         else if (!strcasecmp(key, "s") || !strcasecmp(key, "short"))
             dev->short_width = atoi(val);
         else if (!strcasecmp(key, "l") || !strcasecmp(key, "long"))
@@ -606,11 +595,19 @@ r_device *flex_create_device(char *spec)
         else if (!strcasecmp(key, "reflect"))
             params->reflect = val ? atoi(val) : 1;
 
-        else if (!strcasecmp(key, "match"))
-            params->match_len = parse_bits(val, params->match_bits);
+        else if (!strcasecmp(key, "match")) {
+            int len = parse_bits(val, params->match_bits);
+            if (len < 0)
+                return -1;
+            params->match_len = len;
+        }
 
-        else if (!strcasecmp(key, "preamble"))
-            params->preamble_len = parse_bits(val, params->preamble_bits);
+        else if (!strcasecmp(key, "preamble")) {
+            int len = parse_bits(val, params->preamble_bits);
+            if (len < 0)
+                return -1;
+            params->preamble_len = len;
+        }
 
         else if (!strcasecmp(key, "countonly"))
             params->count_only = val ? atoi(val) : 1;
@@ -622,16 +619,16 @@ r_device *flex_create_device(char *spec)
             params->decode_uart = val ? atoi(val) : 1;
 
         else if (!strcasecmp(key, "get")) {
-            if (get_count < GETTER_SLOTS)
-                parse_getter(val, &params->getter[get_count++]);
-            else {
+            if (get_count >= GETTER_SLOTS) {
                 fprintf(stderr, "Maximum getter slots exceeded (%d)!\n", GETTER_SLOTS);
-                usage();
+                return -1;
             }
+            if (parse_getter(val, &params->getter[get_count++]))
+                return -1;
 
         } else {
             fprintf(stderr, "Bad flex spec, unknown keyword (%s)!\n", key);
-            usage();
+            return -1;
         }
     }
 
@@ -645,30 +642,30 @@ r_device *flex_create_device(char *spec)
 
     if (!params->name || !*params->name) {
         fprintf(stderr, "Bad flex spec, missing name!\n");
-        usage();
+        return -1;
     }
 
     if (!dev->modulation) {
         fprintf(stderr, "Bad flex spec, missing modulation!\n");
-        usage();
+        return -1;
     }
 
     if (!dev->short_width) {
         fprintf(stderr, "Bad flex spec, missing short width!\n");
-        usage();
+        return -1;
     }
 
     if (dev->modulation != OOK_PULSE_MANCHESTER_ZEROBIT
             && dev->modulation != FSK_PULSE_MANCHESTER_ZEROBIT) {
         if (!dev->long_width) {
             fprintf(stderr, "Bad flex spec, missing long width!\n");
-            usage();
+            return -1;
         }
     }
 
     if (!dev->reset_limit) {
         fprintf(stderr, "Bad flex spec, missing reset limit!\n");
-        usage();
+        return -1;
     }
 
     if (dev->modulation == OOK_PULSE_DMC
@@ -676,10 +673,79 @@ r_device *flex_create_device(char *spec)
             || dev->modulation == OOK_PULSE_PIWM_DC) {
         if (!dev->tolerance) {
             fprintf(stderr, "Bad flex spec, missing tolerance limit!\n");
-            usage();
+            return -1;
         }
     }
 
+    return 0;
+}
+
+/// Free the strings allocated by parse_spec().
+static void free_spec(r_device *dev, struct flex_params *params)
+{
+    free(dev->name);
+    free(params->name);
+    for (int i = 0; i < GETTER_SLOTS; ++i) {
+        free((char *)params->getter[i].name);
+        free((char *)params->getter[i].format);
+        for (int j = 0; j < GETTER_MAP_SLOTS; ++j)
+            free((char *)params->getter[i].map[j].val);
+    }
+}
+
+// NOTE: this is declared in rtl_433.c also.
+int flex_check_spec(char const *spec);
+
+int flex_check_spec(char const *spec)
+{
+    if (!spec || !*spec || *spec == '?' || !strncasecmp(spec, "help", strlen(spec))) {
+        fprintf(stderr, "Bad flex spec, missing spec!\n");
+        return -1;
+    }
+
+    struct flex_params params = {0};
+    r_device dev = {0};
+    char *copy = strdup(spec);
+    if (!copy)
+        FATAL_STRDUP("flex_check_spec()");
+    int ret = parse_spec(copy, &dev, &params);
+    free(copy);
+    free_spec(&dev, &params);
+    return ret;
+}
+
+// NOTE: this is declared in rtl_433.c also.
+r_device *flex_create_device(char *spec);
+
+r_device *flex_create_device(char *spec)
+{
+    if (!spec || !*spec || *spec == '?' || !strncasecmp(spec, "help", strlen(spec))) {
+        help();
+    }
+
+    struct flex_params *params = calloc(1, sizeof(*params));
+    if (!params) {
+        WARN_CALLOC("flex_create_device()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    r_device *dev = calloc(1, sizeof(*dev));
+    if (!dev) {
+        WARN_CALLOC("flex_create_device()");
+        free(params);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    dev->decode_ctx = params;
+
+    spec = strdup(spec);
+    if (!spec)
+        FATAL_STRDUP("flex_create_device()");
+
+    dev->decode_fn = flex_callback;
+    dev->fields = output_fields;
+
+    if (parse_spec(spec, dev, params))
+        usage();
+
     /*
     if (decoder->verbose) {
         fprintf(stderr, "Adding flex decoder \"%s\"\n", params->name);
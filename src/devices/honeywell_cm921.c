@@ -344,54 +344,63 @@ static int honeywell_cm921_decode(r_device *decoder, bitbuffer_t *bitbuffer)
         return DECODE_ABORT_LENGTH;
     int end = start + len;
 
-    bitbuffer_t bytes = {0};
+    bitbuffer_t *bytes = bitbuffer_acquire();
     int pos = start;
     while (pos < end) {
         uint8_t byte = 0;
         if (decode_10to8(bitbuffer->bb[row], pos, end, &byte) != 10)
             break;
         for (unsigned i = 0; i < 8; i++)
-            bitbuffer_add_bit(&bytes, (byte >> i) & 0x1);
+            bitbuffer_add_bit(bytes, (byte >> i) & 0x1);
         pos += 10;
     }
 
     // Skip Manchester breaking header
     uint8_t header[3] = { 0x33, 0x55, 0x53 };
-    if (bitrow_get_byte(bytes.bb[row], 0) != header[0] ||
-        bitrow_get_byte(bytes.bb[row], 8) != header[1] ||
-        bitrow_get_byte(bytes.bb[row], 16) != header[2])
+    if (bitrow_get_byte(bytes->bb[row], 0) != header[0] ||
+        bitrow_get_byte(bytes->bb[row], 8) != header[1] ||
+        bitrow_get_byte(bytes->bb[row], 16) != header[2]) {
+        bitbuffer_release(bytes);
         return DECODE_FAIL_SANITY;
+    }
 
     // Find Footer 0x35 (0x55*)
-    int fi = bytes.bits_per_row[row] - 8;
+    int fi = bytes->bits_per_row[row] - 8;
     int seen_aa = 0;
-    while (bitrow_get_byte(bytes.bb[row], fi) == 0x55) {
+    while (bitrow_get_byte(bytes->bb[row], fi) == 0x55) {
         seen_aa = 1;
         fi -= 8;
     }
-    if (!seen_aa || bitrow_get_byte(bytes.bb[row], fi) != 0x35)
+    if (!seen_aa || bitrow_get_byte(bytes->bb[row], fi) != 0x35) {
+        bitbuffer_release(bytes);
         return DECODE_FAIL_SANITY;
+    }
 
     unsigned first_byte = 24;
     unsigned end_byte   = fi;
     unsigned num_bits   = end_byte - first_byte;
     //unsigned num_bytes = num_bits/8 / 2;
 
-    bitbuffer_t packet = {0};
-    unsigned fpos = bitbuffer_manchester_decode(&bytes, row, first_byte, &packet, num_bits);
+    bitbuffer_t *packet = bitbuffer_acquire();
+    unsigned fpos = bitbuffer_manchester_decode(bytes, row, first_byte, packet, num_bits);
     unsigned man_errors = num_bits - (fpos - first_byte - 2);
+    bitbuffer_release(bytes);
 
 #ifndef _DEBUG
-    if (man_errors != 0)
+    if (man_errors != 0) {
+        bitbuffer_release(packet);
         return DECODE_FAIL_SANITY;
+    }
 #endif
 
     message_t message;
 
-    int pr = parse_msg(&packet, 0, &message);
+    int pr = parse_msg(packet, 0, &message);
 
-    if (pr <= 0)
+    if (pr <= 0) {
+        bitbuffer_release(packet);
         return pr;
+    }
 
     /* clang-format off */
     data_t *data = data_make(
@@ -403,7 +412,7 @@ static int honeywell_cm921_decode(r_device *decoder, bitbuffer_t *bitbuffer)
     data = honeywell_cm921_interpret_message(decoder, &message, data);
 
 #ifdef _DEBUG
-    data = add_hex_string(data, "Packet", packet.bb[row], packet.bits_per_row[row] / 8);
+    data = add_hex_string(data, "Packet", packet->bb[row], packet->bits_per_row[row] / 8);
     data = add_hex_string(data, "Header", &message.header, 1);
     uint8_t cmd[2] = {message.command >> 8, message.command & 0x00FF};
     data = add_hex_string(data, "Command", cmd, 2);
@@ -414,6 +423,7 @@ static int honeywell_cm921_decode(r_device *decoder, bitbuffer_t *bitbuffer)
 #endif
 
     decoder_output_data(decoder, data);
+    bitbuffer_release(packet);
 
     return 1;
 }
@@ -115,8 +115,8 @@ static int parse_insteon_pkt(r_device *decoder, bitbuffer_t *bits, unsigned int
 {
     uint8_t results[35]   = {0};
     uint8_t results_len   = 0;
-    bitbuffer_t i_bits    = {0};
-    bitbuffer_t d_bits    = {0};
+    bitbuffer_t *i_bits   = bitbuffer_acquire();
+    bitbuffer_t *d_bits   = bitbuffer_acquire();
     unsigned int next_pos = 0;
     uint8_t i             = 0;
     uint8_t pkt_i, pkt_d;
@@ -154,20 +154,24 @@ static int parse_insteon_pkt(r_device *decoder, bitbuffer_t *bits, unsigned int
 
     */
 
-    next_pos = bitbuffer_manchester_decode(bits, row, start_pos, &i_bits, 5);
-    pkt_i    = reverse8(i_bits.bb[0][0]);
+    next_pos = bitbuffer_manchester_decode(bits, row, start_pos, i_bits, 5);
+    pkt_i    = reverse8(i_bits->bb[0][0]);
 
-    next_pos               = bitbuffer_manchester_decode(bits, row, next_pos, &d_bits, 8);
-    pkt_d                  = reverse8(d_bits.bb[0][0]);
+    next_pos               = bitbuffer_manchester_decode(bits, row, next_pos, d_bits, 8);
+    pkt_d                  = reverse8(d_bits->bb[0][0]);
     results[results_len++] = pkt_d;
 
     if (pkt_i != 31) { // should always be 31 ( 0b11111) in first block of packet
+        bitbuffer_release(i_bits);
+        bitbuffer_release(d_bits);
         return DECODE_ABORT_EARLY;
     }
 
     bitbuffer_extract_bytes(bits, row, start_pos + 26, &i, 2);
     // Check for packet delimiter  marker bits (at least once)
     if (i != 0xc0) {                 // 0b11000000
+        bitbuffer_release(i_bits);
+        bitbuffer_release(d_bits);
         return DECODE_FAIL_SANITY; // There should be two high bits '11' between packets
     }
 
@@ -217,10 +221,10 @@ static int parse_insteon_pkt(r_device *decoder, bitbuffer_t *bits, unsigned int
     for (int j = 1; j < max_pkt_len; j++) {
         unsigned y;
         start_pos += 28;
-        bitbuffer_clear(&i_bits);
-        bitbuffer_clear(&d_bits);
-        next_pos = bitbuffer_manchester_decode(bits, row, start_pos, &i_bits, 5);
-        next_pos = bitbuffer_manchester_decode(bits, row, next_pos, &d_bits, 8);
+        bitbuffer_clear(i_bits);
+        bitbuffer_clear(d_bits);
+        next_pos = bitbuffer_manchester_decode(bits, row, start_pos, i_bits, 5);
+        next_pos = bitbuffer_manchester_decode(bits, row, next_pos, d_bits, 8);
 
         y = (next_pos - start_pos);
         if (y != 26) {
@@ -231,8 +235,8 @@ static int parse_insteon_pkt(r_device *decoder, bitbuffer_t *bits, unsigned int
         // bitbuffer_extract_bytes(bits, row, start_pos -2, buff, 8);
         // printBits(sizeof(buff), buff);
 
-        pkt_i = reverse8(i_bits.bb[0][0]);
-        pkt_d = reverse8(d_bits.bb[0][0]);
+        pkt_i = reverse8(i_bits->bb[0][0]);
+        pkt_d = reverse8(d_bits->bb[0][0]);
 
         results[results_len++] = pkt_d;
 
@@ -249,9 +253,13 @@ static int parse_insteon_pkt(r_device *decoder, bitbuffer_t *bits, unsigned int
         if (pkt_i < prev_i) {
             prev_i = pkt_i;
         } else {
+            bitbuffer_release(i_bits);
+            bitbuffer_release(d_bits);
             return DECODE_ABORT_EARLY;
         }
     }
+    bitbuffer_release(i_bits);
+    bitbuffer_release(d_bits);
 
     // if (decoder->verbose > 1) {
     //     for (int j=0; j < results_len; j++) {
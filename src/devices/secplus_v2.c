@@ -240,15 +240,15 @@ unsigned _preamble_len           = 28;
 static int secplus_v2_callback(r_device *decoder, bitbuffer_t *bitbuffer)
 {
     unsigned search_index = 0;
-    bitbuffer_t bits = {0};
+    bitbuffer_t *bits = bitbuffer_acquire();
     // int i            = 0;
 
     //bitbuffer_t bits_1    = {0};
-    bitbuffer_t fixed_1   = {0};
+    bitbuffer_t *fixed_1  = bitbuffer_acquire();
     uint8_t rolling_1[16] = {0};
 
     //bitbuffer_t bits_2    = {0};
-    bitbuffer_t fixed_2   = {0};
+    bitbuffer_t *fixed_2  = bitbuffer_acquire();
     uint8_t rolling_2[16] = {0};
 
     for (uint16_t row = 0; row < bitbuffer->num_rows; ++row) {
@@ -262,42 +262,60 @@ static int secplus_v2_callback(r_device *decoder, bitbuffer_t *bitbuffer)
             break;
         }
 
-        bitbuffer_clear(&bits);
-        bitbuffer_manchester_decode(bitbuffer, row, search_index + 26, &bits, 80);
+        bitbuffer_clear(bits);
+        bitbuffer_manchester_decode(bitbuffer, row, search_index + 26, bits, 80);
         search_index += 20;
-        if (bits.bits_per_row[0] < 42) {
+        if (bits->bits_per_row[0] < 42) {
             continue; // DECODE_ABORT_LENGTH;
         }
 
-        decoder_log_bitrow(decoder, 1, __func__, bits.bb[0], bits.bits_per_row[0], "manchester decoded");
+        decoder_log_bitrow(decoder, 1, __func__, bits->bb[0], bits->bits_per_row[0], "manchester decoded");
 
         // valid = 0X00XXXX
         // 1st 3rs and 4th bits should always be 0
-        if (bits.bb[0][0] & 0xB0) {
+        if (bits->bb[0][0] & 0xB0) {
             continue; // DECODE_FAIL_SANITY;
         }
 
         // 2nd bit indicates with half of the data
-        if (bits.bb[0][0] & 0xC0) {
+        if (bits->bb[0][0] & 0xC0) {
             decoder_log(decoder, 1, __func__, "Set 2");
-            secplus_v2_decode_v2_half(decoder, &bits, rolling_2, &fixed_2);
+            secplus_v2_decode_v2_half(decoder, bits, rolling_2, fixed_2);
         }
         else {
             decoder_log(decoder, 1, __func__, "Set 1");
-            secplus_v2_decode_v2_half(decoder, &bits, rolling_1, &fixed_1);
+            secplus_v2_decode_v2_half(decoder, bits, rolling_1, fixed_1);
         }
 
         // break if we've received both halves
-        if (fixed_1.bits_per_row[0] > 1 && fixed_2.bits_per_row[0] > 1) {
+        if (fixed_1->bits_per_row[0] > 1 && fixed_2->bits_per_row[0] > 1) {
             break;
         }
     }
+    bitbuffer_release(bits);
 
     // Do we have what we need ??
-    if (fixed_1.bits_per_row[0] == 0 || fixed_2.bits_per_row[0] == 0) {
+    if (fixed_1->bits_per_row[0] == 0 || fixed_2->bits_per_row[0] == 0) {
+        bitbuffer_release(fixed_1);
+        bitbuffer_release(fixed_2);
         return DECODE_FAIL_SANITY;
     }
 
+    // Assemble "fixed" data part
+    uint64_t fixed_total = 0;
+    uint8_t *bb;
+    bb = fixed_1->bb[0];
+    fixed_total ^= ((uint64_t)bb[0]) << 32;
+    fixed_total ^= ((uint64_t)bb[1]) << 24;
+    fixed_total ^= ((uint64_t)bb[2]) << 16;
+
+    bb = fixed_2->bb[0];
+    fixed_total ^= ((uint64_t)bb[0]) << 12;
+    fixed_total ^= ((uint64_t)bb[1]) << 4;
+    fixed_total ^= (bb[2] >> 4) & 0x0f;
+    bitbuffer_release(fixed_1);
+    bitbuffer_release(fixed_2);
+
     // Assemble rolling_1[] and rolling_2[] into rolling_digits[]
     uint8_t rolling_digits[24] = {0};
     uint8_t *r;
@@ -336,19 +354,6 @@ static int secplus_v2_callback(r_device *decoder, bitbuffer_t *bitbuffer)
     rolling_total = reverse32(rolling_temp);
     rolling_total = rolling_total >> 4;
 
-    // Assemble "fixed" data part
-    uint64_t fixed_total = 0;
-    uint8_t *bb;
-    bb = fixed_1.bb[0];
-    fixed_total ^= ((uint64_t)bb[0]) << 32;
-    fixed_total ^= ((uint64_t)bb[1]) << 24;
-    fixed_total ^= ((uint64_t)bb[2]) << 16;
-
-    bb = fixed_2.bb[0];
-    fixed_total ^= ((uint64_t)bb[0]) << 12;
-    fixed_total ^= ((uint64_t)bb[1]) << 4;
-    fixed_total ^= (bb[2] >> 4) & 0x0f;
-
     // int button    = fixed_total >> 32;
     // int remote_id = fixed_total & 0xffffffff;
     char fixed_str[16];
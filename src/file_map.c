@@ -0,0 +1,101 @@
+/** @file
+    Read-only memory mapping of input files.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "file_map.h"
+
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/// Read-ahead is requested in steps of this many bytes.
+#define FILE_MAP_READAHEAD (4 * 1024 * 1024)
+
+#ifndef _WIN32
+
+int file_map_open(file_map_t *map, FILE *file)
+{
+    memset(map, 0, sizeof(*map));
+
+    int fd = fileno(file);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0)
+        return -1;
+    // the file might be too large for the address space on 32-bit systems
+    if ((unsigned long long)st.st_size > (size_t)-1)
+        return -1;
+
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)
+        return -1;
+
+    map->data = data;
+    map->len  = (size_t)st.st_size;
+
+#ifdef MADV_SEQUENTIAL
+    madvise(map->data, map->len, MADV_SEQUENTIAL);
+#endif
+    file_map_advise(map, 0, 0);
+
+    return 0;
+}
+
+void file_map_advise(file_map_t *map, size_t offset, size_t len)
+{
+    if (!map->data || offset + len + FILE_MAP_READAHEAD / 2 < map->advised || map->advised >= map->len)
+        return;
+
+    // keep about one step ahead of the reader
+    size_t start = map->advised & ~(size_t)(sysconf(_SC_PAGESIZE) - 1);
+    size_t end   = offset + len + FILE_MAP_READAHEAD;
+    if (end > map->len)
+        end = map->len;
+#ifdef MADV_WILLNEED
+    madvise(map->data + start, end - start, MADV_WILLNEED);
+#endif
+    map->advised = end;
+}
+
+void file_map_close(file_map_t *map)
+{
+    if (map->data)
+        munmap(map->data, map->len);
+    memset(map, 0, sizeof(*map));
+}
+
+#else
+
+// Not mapped on Windows, the caller falls back to fread().
+
+int file_map_open(file_map_t *map, FILE *file)
+{
+    (void)file;
+    memset(map, 0, sizeof(*map));
+    return -1;
+}
+
+void file_map_advise(file_map_t *map, size_t offset, size_t len)
+{
+    (void)map;
+    (void)offset;
+    (void)len;
+}
+
+void file_map_close(file_map_t *map)
+{
+    memset(map, 0, sizeof(*map));
+}
+
+#endif
@@ -50,7 +50,10 @@ void file_info_check_read(file_info_t *info)
             && info->format != CS16_IQ
             && info->format != CF32_IQ
             && info->format != S16_AM
-            && info->format != PULSE_OOK) {
+            && info->format != PULSE_OOK
+            && info->format != BURST_IQ
+            && info->format != SIGMF_IQ
+            && info->format != PULSE_BIN) {
         fprintf(stderr, "File type not supported as input (%s).\n", info->spec);
         exit(1);
     }
@@ -69,7 +72,10 @@ void file_info_check_write(file_info_t *info)
             && info->format != F32_I
             && info->format != F32_Q
             && info->format != U8_LOGIC
-            && info->format != VCD_LOGIC) {
+            && info->format != VCD_LOGIC
+            && info->format != BURST_IQ
+            && info->format != SIGMF_IQ
+            && info->format != PULSE_BIN) {
         fprintf(stderr, "File type not supported as output (%s).\n", info->spec);
         exit(1);
     }
@@ -90,6 +96,9 @@ char const *file_info_string(file_info_t *info)
     case VCD_LOGIC: return "VCD logic (text)";
     case U8_LOGIC:  return "U8 logic (1ch uint8)";
     case PULSE_OOK: return "OOK pulse data (text)";
+    case BURST_IQ:  return "Burst store (IQ bursts)";
+    case SIGMF_IQ:  return "SigMF recording (IQ)";
+    case PULSE_BIN: return "Pulse data (binary)";
     default:        return "Unknown";
     }
 }
@@ -120,6 +129,9 @@ static uint32_t file_type_guess_auto_format(uint32_t type)
     else if (type == F_U8) return U8_LOGIC;
     else if (type == F_VCD) return VCD_LOGIC;
     else if (type == F_OOK) return PULSE_OOK;
+    else if (type == F_BURST) return BURST_IQ;
+    else if (type == F_PULSES) return PULSE_BIN;
+    else if ((type & 0xffff0000) == F_SIGMF) return SIGMF_IQ; // the dataset format is in the meta file
     else if (type == F_CS16) return CS16_IQ;
     else if (type == F_CF32) return CF32_IQ;
     else return type;
@@ -198,6 +210,9 @@ static void file_type(char const *filename, file_info_t *info)
             else if (len == 3 && !strncasecmp("f32", t, 3)) file_type_set_format(&info->format, F_F32);
             else if (len == 3 && !strncasecmp("vcd", t, 3)) file_type_set_content(&info->format, F_VCD);
             else if (len == 3 && !strncasecmp("ook", t, 3)) file_type_set_content(&info->format, F_OOK);
+            else if (len == 5 && !strncasecmp("burst", t, 5)) file_type_set_content(&info->format, F_BURST);
+            else if (len == 5 && !strncasecmp("sigmf", t, 5)) file_type_set_content(&info->format, F_SIGMF);
+            else if (len == 4 && !strncasecmp("pbin", t, 4)) file_type_set_content(&info->format, F_PULSES);
             else if (len == 4 && !strncasecmp("cs16", t, 4)) file_type_set_format(&info->format, F_CS16);
             else if (len == 4 && !strncasecmp("cs32", t, 4)) file_type_set_format(&info->format, F_CS32);
             else if (len == 4 && !strncasecmp("cf32", t, 4)) file_type_set_format(&info->format, F_CF32);
@@ -237,6 +252,7 @@ Parse "[A-Za-z][0-9A-Za-z]+" as format or content specifier:
 2ch formats: "cu8", "cs8", "cs16", "cs32", "cf32"
 1ch formats: "u8", "s8", "s16", "u16", "s32", "u32", "f32"
 text formats: "vcd", "ook"
+container formats: "burst", "sigmf", "pbin"
 content types: "iq", "i", "q", "am", "fm", "logic"
 
 Parses left to right, with the exception of a prefix up to the last colon ":"
@@ -329,6 +345,8 @@ int main(void)
     assert_file_type(S16_FM, "s16_fm:");
     assert_file_type(S16_FM, "fm+s16:");
     assert_file_type(S16_FM, "s16,fm:");
+    assert_file_type(BURST_IQ, "burst:");
+    assert_file_type(PULSE_BIN, "pbin:");
 
     assert_file_type(CU8_IQ, ".cu8");
     assert_file_type(CS16_IQ, ".cs16");
@@ -350,6 +368,12 @@ int main(void)
     assert_file_type(S16_FM, ".s16-fm");
     assert_file_type(S16_FM, ".s16_fm");
     assert_file_type(S16_FM, ".s16,fm");
+    assert_file_type(BURST_IQ, ".burst");
+    assert_file_type(PULSE_BIN, ".pbin");
+    assert_file_type(PULSE_BIN, "path/file_433.92M_250k.pbin");
+    assert_file_type(SIGMF_IQ, ".sigmf-meta");
+    assert_file_type(SIGMF_IQ, ".sigmf-data");
+    assert_file_type(SIGMF_IQ, "path/file_433.92M_250k.sigmf");
 
     fprintf(stderr, "\nDone!\n");
 }
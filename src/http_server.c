@@ -17,8 +17,9 @@ A choice of endpoints are available:
     (also serves "/favicon.ico", "/app.css", "/app.js", "/vendor.css", "/vendor.js")
 - "/jsonrpc": JSON-RPC API
 - "/cmd": simple JSON command API
-- "/events": HTTP (chunked) streaming API, streams JSON events
+- "/events": HTTP (chunked) streaming API, streams JSON events, starting with the recent history
 - "/stream": HTTP (plain) streaming API, streams JSON events
+- "/metrics": pipeline, decoder, and output counters in the Prometheus text format
 - "/api": RESTful API (not implemented)
 - "ws:": Websocket API (similar to cmd/events API)
 
@@ -90,6 +91,7 @@ or `(echo "GET /stream HTTP/1.0\n"; sleep 600) | socat - tcp:127.0.0.1:8433`
 - "report_meta":      "time"|"reltime"|"notime"|"hires"|"utc"|"protocol"|"level"
 - "convert":          "native"|"si"|"customary"
 - "protocol":         1
+- "reload":           re-reads the config and swaps in the decoders (-R, -X) and outputs (-F)
 
 */
 
@@ -100,12 +102,14 @@ or `(echo "GET /stream HTTP/1.0\n"; sleep 600) | socat - tcp:127.0.0.1:8433`
 #include "r_device.h" // used for protocols
 #include "r_private.h" // used for protocols
 #include "r_util.h"
+#include "sdr.h"
 #include "optparse.h"
 #include "abuf.h"
 #include "list.h" // used for protocols
 #include "jsmn.h"
 #include "mongoose.h"
 #include "fatal.h"
+#include <stdarg.h>
 #include <stdbool.h>
 
 // embed index.html so browsers allow access as local
@@ -223,6 +227,106 @@ static void **ring_list_next(ring_list_t *ring, void **iter)
     return iter;
 }
 
+// refcounted serialized message, shared by all connections and the history
+
+typedef struct {
+    unsigned refs;
+    size_t len;       ///< length of the JSON text
+    char *ws_frame;   ///< cached websocket frame, built on first use
+    size_t ws_len;
+    char *chunk;      ///< cached HTTP chunk, built on first use
+    size_t chunk_len;
+    char json[];      ///< JSON text followed by "\r\n", as sent on plain streams
+} http_msg_t;
+
+static http_msg_t *http_msg_new(char const *json, size_t len)
+{
+    http_msg_t *msg = malloc(sizeof(*msg) + len + 3);
+    if (!msg) {
+        WARN_MALLOC("http_msg_new()");
+        return NULL;
+    }
+    msg->refs      = 1;
+    msg->len       = len;
+    msg->ws_frame  = NULL;
+    msg->ws_len    = 0;
+    msg->chunk     = NULL;
+    msg->chunk_len = 0;
+    memcpy(msg->json, json, len);
+    memcpy(msg->json + len, "\r\n", 3);
+    return msg;
+}
+
+static http_msg_t *http_msg_retain(http_msg_t *msg)
+{
+    if (msg)
+        msg->refs++;
+    return msg;
+}
+
+static void http_msg_release(http_msg_t *msg)
+{
+    if (!msg || --msg->refs)
+        return;
+    free(msg->ws_frame);
+    free(msg->chunk);
+    free(msg);
+}
+
+/// Unmasked websocket text frame of the JSON text, as a server sends it.
+static char const *http_msg_ws_frame(http_msg_t *msg, size_t *len)
+{
+    if (!msg->ws_frame) {
+        char *frame = malloc(msg->len + 10);
+        if (!frame) {
+            WARN_MALLOC("http_msg_ws_frame()");
+            return NULL;
+        }
+        size_t hdr_len;
+        frame[0] = (char)(0x80 | WEBSOCKET_OP_TEXT);
+        if (msg->len < 126) {
+            frame[1] = (char)msg->len;
+            hdr_len  = 2;
+        }
+        else if (msg->len < 65536) {
+            frame[1] = 126;
+            frame[2] = (char)(msg->len >> 8);
+            frame[3] = (char)msg->len;
+            hdr_len  = 4;
+        }
+        else {
+            frame[1] = 127;
+            for (int i = 0; i < 8; ++i)
+                frame[2 + i] = (char)((uint64_t)msg->len >> (56 - 8 * i));
+            hdr_len = 10;
+        }
+        memcpy(frame + hdr_len, msg->json, msg->len);
+        msg->ws_frame = frame;
+        msg->ws_len   = hdr_len + msg->len;
+    }
+    *len = msg->ws_len;
+    return msg->ws_frame;
+}
+
+/// HTTP chunk of the JSON text and "\r\n".
+static char const *http_msg_chunk(http_msg_t *msg, size_t *len)
+{
+    if (!msg->chunk) {
+        char *chunk = malloc(msg->len + 2 + 20);
+        if (!chunk) {
+            WARN_MALLOC("http_msg_chunk()");
+            return NULL;
+        }
+        int hdr_len = sprintf(chunk, "%lx\r\n", (unsigned long)(msg->len + 2));
+        memcpy(chunk + hdr_len, msg->json, msg->len + 2);
+        memcpy(chunk + hdr_len + msg->len + 2, "\r\n", 2);
+        msg->chunk     = chunk;
+        msg->chunk_len = hdr_len + msg->len + 4;
+    }
+    *len = msg->chunk_len;
+    return msg->chunk;
+}
+
 // data helpers that could go into r_api
 
 static data_t *meta_data(r_cfg_t *cfg)
@@ -254,12 +358,12 @@ static data_t *protocols_data(r_cfg_t *cfg)
     list_ensure_size(&devs, cfg->num_r_devices);
 
     for (int i = 0; i < cfg->num_r_devices; ++i) {
-        r_device *dev = &cfg->devices[i];
+        r_device *dev = cfg->devices[i];
 
         int enabled = 0;
         for (void **iter = cfg->demod->r_devs.elems; iter && *iter; ++iter) {
             r_device *r_dev = *iter;
-            if (r_dev->protocol_num == dev->protocol_num) {
+            if (r_dev->protocol_num == (unsigned)i + 1) {
                 enabled = 1;
                 break;
             }
@@ -269,7 +373,7 @@ static data_t *protocols_data(r_cfg_t *cfg)
             fields_len++;
         }
         data_t *data = data_make(
-                "num", "", DATA_INT, dev->protocol_num,
+                "num", "", DATA_INT, i + 1,
                 "name", "", DATA_STRING, dev->name,
                 "mod", "", DATA_INT, dev->modulation,
                 "short", "", DATA_DOUBLE, dev->short_width,
@@ -661,6 +765,10 @@ static void rpc_exec(rpc_t *rpc, r_cfg_t *cfg)
         set_sample_rate(cfg, rpc->val);
         rpc->response(rpc, 0, "Ok", 0);
     }
+    else if (!strcmp(rpc->method, "reload")) {
+        cfg->reload_now = 1;
+        rpc->response(rpc, 0, "Ok", 0);
+    }
 
     // Invalid
     else {
@@ -842,6 +950,7 @@ static void rpc_response_jsoncmd(rpc_t *rpc, int ret_code, char const *message,
 static void handle_json_events(struct mg_connection *nc, struct http_message *hm)
 {
     UNUSED(hm);
+    struct http_server_context *srv = nc->user_data;
     /* Send headers */
     mg_printf(nc, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n");
 
@@ -854,6 +963,16 @@ static void handle_json_events(struct mg_connection *nc, struct http_message *hm
     ctx->is_chunked = 1;
     nc->user_data   = ctx;
 
+    /* Send history */
+    if (srv) {
+        for (void **iter = ring_list_iter(srv->history); iter; iter = ring_list_next(srv->history, iter)) {
+            size_t len;
+            char const *chunk = http_msg_chunk(*iter, &len);
+            if (chunk)
+                mg_send(nc, chunk, (int)len);
+        }
+    }
+
     mg_set_timer(nc, mg_time() + KEEP_ALIVE); // set keep alive timer
 }
 
@@ -970,6 +1089,193 @@ static void handle_ws_rpc(struct mg_connection *nc, struct websocket_message *wm
     free(rpc.arg);
 }
 
+// Prometheus metrics
+
+static void metrics_printf(struct mbuf *buf, char const *fmt, ...)
+{
+    char line[512];
+    va_list ap;
+    va_start(ap, fmt);
+    int len = vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    if (len > 0)
+        mbuf_append(buf, line, (size_t)len < sizeof(line) ? (size_t)len : sizeof(line) - 1);
+}
+
+/// Escape a label value, backslash, double-quote, and line feed need escaping.
+static char const *metrics_label(char *buf, size_t size, char const *str)
+{
+    size_t len = 0;
+    for (; str && *str && len + 2 < size; ++str) {
+        if (*str == '\\' || *str == '"') {
+            buf[len++] = '\\';
+            buf[len++] = *str;
+        }
+        else if (*str == '\n') {
+            buf[len++] = '\\';
+            buf[len++] = 'n';
+        }
+        else {
+            buf[len++] = *str;
+        }
+    }
+    buf[len] = '\0';
+    return buf;
+}
+
+static void metrics_histogram(struct mbuf *buf, char const *name, char const *help, metrics_histogram_t const *hist)
+{
+    metrics_printf(buf, "# HELP %s %s\n# TYPE %s histogram\n", name, help, name);
+    uint64_t count = 0;
+    for (unsigned i = 0; i < hist->num_bounds; ++i) {
+        count += hist->buckets[i];
+        metrics_printf(buf, "%s_bucket{le=\"%g\"} %llu\n", name, hist->bounds[i], (unsigned long long)count);
+    }
+    metrics_printf(buf, "%s_bucket{le=\"+Inf\"} %llu\n", name, (unsigned long long)hist->count);
+    metrics_printf(buf, "%s_sum %.6f\n", name, hist->sum);
+    metrics_printf(buf, "%s_count %llu\n", name, (unsigned long long)hist->count);
+}
+
+/// Print the quantiles, sum, and count of a summary, @p labels are the labels without braces.
+static void metrics_summary(struct mbuf *buf, char const *name, char const *labels, metrics_latency_t const *lat)
+{
+    metrics_printf(buf, "%s{%s,quantile=\"0.5\"} %.6f\n", name, labels, metrics_latency_quantile(lat, 0.5));
+    metrics_printf(buf, "%s{%s,quantile=\"0.99\"} %.6f\n", name, labels, metrics_latency_quantile(lat, 0.99));
+    metrics_printf(buf, "%s_sum{%s} %.6f\n", name, labels, lat->sum);
+    metrics_printf(buf, "%s_count{%s} %llu\n", name, labels, (unsigned long long)lat->count);
+}
+
+static void metrics_counter_head(struct mbuf *buf, char const *name, char const *help)
+{
+    metrics_printf(buf, "# HELP %s %s\n# TYPE %s counter\n", name, help, name);
+}
+
+// Serves GET /metrics in the Prometheus text format
+static void handle_metrics(struct mg_connection *nc, struct http_message *hm)
+{
+    UNUSED(hm);
+    struct http_server_context *ctx = nc->user_data;
+    r_cfg_t *cfg = ctx->cfg;
+    pipeline_metrics_t const *m = &cfg->metrics;
+    struct mbuf buf;
+    mbuf_init(&buf, 16384);
+    char label[256];
+
+    metrics_counter_head(&buf, "rtl433_buffers_total", "Sample buffers received.");
+    metrics_printf(&buf, "rtl433_buffers_total %llu\n", (unsigned long long)m->buffers);
+    metrics_counter_head(&buf, "rtl433_samples_total", "Samples processed.");
+    metrics_printf(&buf, "rtl433_samples_total %llu\n", (unsigned long long)m->samples);
+    metrics_counter_head(&buf, "rtl433_buffers_squelched_total", "Sample buffers skipped as noise only.");
+    metrics_printf(&buf, "rtl433_buffers_squelched_total %llu\n", (unsigned long long)m->buffers_squelched);
+    metrics_counter_head(&buf, "rtl433_packages_total", "Pulse packages detected.");
+    metrics_printf(&buf, "rtl433_packages_total{modulation=\"ook\"} %llu\n", (unsigned long long)m->packages_ook);
+    metrics_printf(&buf, "rtl433_packages_total{modulation=\"fsk\"} %llu\n", (unsigned long long)m->packages_fsk);
+    metrics_printf(&buf, "# HELP rtl433_noise_level_db Estimated noise level.\n# TYPE rtl433_noise_level_db gauge\n");
+    metrics_printf(&buf, "rtl433_noise_level_db %.1f\n", m->noise_db);
+    metrics_printf(&buf, "# HELP rtl433_startup_seconds Time from the start to the first sample buffer.\n# TYPE rtl433_startup_seconds gauge\n");
+    metrics_printf(&buf, "rtl433_startup_seconds %.6f\n", m->startup_seconds);
+
+    metrics_counter_head(&buf, "rtl433_stage_cpu_seconds_total", "CPU time spent in each processing stage.");
+    for (int i = 0; i < METRICS_STAGE_COUNT; ++i) {
+        metrics_printf(&buf, "rtl433_stage_cpu_seconds_total{stage=\"%s\"} %.6f\n", metrics_stage_name(i), m->stage_seconds[i]);
+    }
+    metrics_histogram(&buf, "rtl433_buffer_cpu_seconds", "CPU time to process a sample buffer.", &m->buffer_seconds);
+    metrics_histogram(&buf, "rtl433_package_pulses", "Pulses in a detected package.", &m->package_pulses);
+
+    // decoders, the interval counters are added to the totals on each report flush
+    static char const *const fail_names[] = {"fail_other", "abort_length", "abort_early", "fail_mic", "fail_sanity"};
+    char const *const decoder_metrics[] = {"attempts", "ok", "messages"};
+    char const *const decoder_help[] = {"Packages passed to the decoder.", "Packages decoded.", "Messages output."};
+    for (int k = 0; k < 3; ++k) {
+        metrics_printf(&buf, "# HELP rtl433_decoder_%s_total %s\n# TYPE rtl433_decoder_%s_total counter\n", decoder_metrics[k], decoder_help[k], decoder_metrics[k]);
+        for (void **iter = cfg->demod->r_devs.elems; iter && *iter; ++iter) {
+            r_device const *r_dev = *iter;
+            if (!r_dev->total_events && !r_dev->decode_events)
+                continue; // skip decoders that never ran
+            unsigned long val = k == 0 ? r_dev->total_events + r_dev->decode_events
+                    : k == 1           ? r_dev->total_ok + r_dev->decode_ok
+                                       : r_dev->total_messages + r_dev->decode_messages;
+            metrics_printf(&buf, "rtl433_decoder_%s_total{protocol=\"%u\",name=\"%s\"} %lu\n",
+                    decoder_metrics[k], r_dev->protocol_num, metrics_label(label, sizeof(label), r_dev->name), val);
+        }
+    }
+    metrics_counter_head(&buf, "rtl433_decoder_fails_total", "Packages rejected by the decoder, by reason.");
+    for (void **iter = cfg->demod->r_devs.elems; iter && *iter; ++iter) {
+        r_device const *r_dev = *iter;
+        for (int i = 0; i < 5; ++i) {
+            unsigned long val = r_dev->total_fails[i] + r_dev->decode_fails[i];
+            if (!val)
+                continue;
+            metrics_printf(&buf, "rtl433_decoder_fails_total{protocol=\"%u\",name=\"%s\",reason=\"%s\"} %lu\n",
+                    r_dev->protocol_num, metrics_label(label, sizeof(label), r_dev->name), fail_names[i], val);
+        }
+    }
+
+    // outputs
+    char const *const output_metrics[] = {"events", "bytes", "errors"};
+    char const *const output_help[] = {"Events printed.", "Bytes written or sent, if counted by the output.", "Failed writes or sends, and dropped messages."};
+    for (int k = 0; k < 3; ++k) {
+        metrics_printf(&buf, "# HELP rtl433_output_%s_total %s\n# TYPE rtl433_output_%s_total counter\n", output_metrics[k], output_help[k], output_metrics[k]);
+        for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
+            data_output_t const *output = cfg->output_handler.elems[i];
+            if (!output)
+                continue;
+            unsigned long val = k == 0 ? output->stats.events : k == 1 ? output->stats.bytes : output->stats.errors;
+            metrics_printf(&buf, "rtl433_output_%s_total{output=\"%s\",index=\"%zu\"} %lu\n",
+                    output_metrics[k], output->name ? output->name : "unknown", i, val);
+        }
+    }
+
+    // input, counted since the start of the device
+    sdr_stats_t const *sdr_stats = sdr_get_stats(cfg->dev);
+    if (sdr_stats) {
+        char const *const sdr_metrics[] = {"buffers", "samples", "expected_samples", "dropped_samples", "gaps", "overruns", "late_callbacks"};
+        char const *const sdr_help[]    = {"Sample buffers received from the input.", "Samples received from the input.",
+                "Samples expected from the wall clock and sample rate.", "Samples lost by the input.", "Times samples were lost by the input.",
+                "Overflows reported by the input, or buffers dropped by the read-ahead.", "Callbacks that took longer than the buffer duration."};
+        unsigned long long const sdr_values[] = {sdr_stats->buffers, sdr_stats->samples, sdr_stats->samples_expected, sdr_stats->dropped,
+                sdr_stats->gaps, sdr_stats->overruns, sdr_stats->late};
+        for (int k = 0; k < 7; ++k) {
+            metrics_printf(&buf, "# HELP rtl433_input_%s_total %s\n# TYPE rtl433_input_%s_total counter\n", sdr_metrics[k], sdr_help[k], sdr_metrics[k]);
+            metrics_printf(&buf, "rtl433_input_%s_total %llu\n", sdr_metrics[k], sdr_values[k]);
+        }
+        metrics_counter_head(&buf, "rtl433_input_callback_seconds_total", "Time spent processing input buffers.");
+        metrics_printf(&buf, "rtl433_input_callback_seconds_total %.6f\n", sdr_stats->callback_seconds);
+        metrics_counter_head(&buf, "rtl433_input_buffer_seconds_total", "Duration of the input buffers at the sample rate.");
+        metrics_printf(&buf, "rtl433_input_buffer_seconds_total %.6f\n", sdr_stats->buffer_seconds);
+        metrics_printf(&buf, "# HELP rtl433_input_callback_max_seconds Longest time to process an input buffer.\n# TYPE rtl433_input_callback_max_seconds gauge\n");
+        metrics_printf(&buf, "rtl433_input_callback_max_seconds %.6f\n", sdr_stats->callback_max);
+    }
+
+    // latencies on the wall clock
+    char labels[300];
+    metrics_printf(&buf, "# HELP rtl433_latency_seconds Latency from the end of a transmission, by stage.\n# TYPE rtl433_latency_seconds summary\n");
+    for (int i = 0; i < METRICS_LATENCY_COUNT; ++i) {
+        snprintf(labels, sizeof(labels), "stage=\"%s\"", metrics_latency_name(i));
+        metrics_summary(&buf, "rtl433_latency_seconds", labels, &m->latency[i]);
+    }
+    metrics_printf(&buf, "# HELP rtl433_latency_max_seconds Maximum latency, by stage.\n# TYPE rtl433_latency_max_seconds gauge\n");
+    for (int i = 0; i < METRICS_LATENCY_COUNT; ++i) {
+        metrics_printf(&buf, "rtl433_latency_max_seconds{stage=\"%s\"} %.6f\n", metrics_latency_name(i), m->latency[i].max);
+    }
+    metrics_printf(&buf, "# HELP rtl433_output_latency_seconds Time to print an event, for each output.\n# TYPE rtl433_output_latency_seconds summary\n");
+    for (size_t i = 0; i < cfg->output_handler.len && i < METRICS_OUTPUTS_MAX; ++i) { // list might contain NULLs
+        data_output_t const *output = cfg->output_handler.elems[i];
+        if (!output)
+            continue;
+        snprintf(labels, sizeof(labels), "output=\"%s\",index=\"%zu\"", output->name ? output->name : "unknown", i);
+        metrics_summary(&buf, "rtl433_output_latency_seconds", labels, &m->output_latency[i]);
+    }
+
+    mg_printf(nc,
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Type: text/plain; version=0.0.4\r\n"
+            "Content-Length: %zu\r\n"
+            "\r\n", buf.len);
+    mg_send(nc, buf.buf, (int)buf.len);
+    mbuf_free(&buf);
+}
+
 static void ev_handler(struct mg_connection *nc, int ev, void *ev_data);
 
 static void send_keep_alive(struct mg_connection *nc)
@@ -1003,8 +1309,12 @@ static void ev_handler(struct mg_connection *nc, int ev, void *ev_data)
         data_output_print(ctx->output, meta);
         data_free(meta);
         /* Send history */
-        for (void **iter = ring_list_iter(ctx->history); iter; iter = ring_list_next(ctx->history, iter))
-            mg_send_websocket_frame(nc, WEBSOCKET_OP_TEXT, (char *)*iter, strlen((char *)*iter));
+        for (void **iter = ring_list_iter(ctx->history); iter; iter = ring_list_next(ctx->history, iter)) {
+            size_t len;
+            char const *frame = http_msg_ws_frame(*iter, &len);
+            if (frame)
+                mg_send(nc, frame, (int)len);
+        }
         break;
     }
     case MG_EV_WEBSOCKET_FRAME: {
@@ -1038,6 +1348,9 @@ static void ev_handler(struct mg_connection *nc, int ev, void *ev_data)
         else if (mg_vcmp(&hm->uri, "/stream") == 0) {
             handle_json_stream(nc, hm);
         }
+        else if (mg_vcmp(&hm->uri, "/metrics") == 0) {
+            handle_metrics(nc, hm);
+        }
         else if (mg_vcmp(&hm->uri, "/api") == 0) {
             //handle_api_query(nc, hm);
         }
@@ -1062,39 +1375,41 @@ static int is_websocket(const struct mg_connection *nc)
     return nc->flags & MG_F_IS_WEBSOCKET;
 }
 
-// event handler to broadcast to all our sockets
-static void http_broadcast_send(struct http_server_context *ctx, char const *msg, size_t len)
+// event handler to broadcast to all our sockets, the message is serialized and framed only once
+static void http_broadcast_send(struct http_server_context *ctx, char const *json, size_t json_len)
 {
     struct mg_connection *nc;
     struct mg_mgr *mgr = ctx->conn->mgr;
 
-    char *dup = strdup(msg);
-    if (!dup) {
-        WARN_STRDUP("http_broadcast_send()");
-    }
-    else {
-        free(ring_list_push(ctx->history, dup));
-    }
+    http_msg_t *msg = http_msg_new(json, json_len);
+    if (!msg)
+        return; // NOTE: skip output on alloc failure.
 
     for (nc = mg_next(mgr, NULL); nc != NULL; nc = mg_next(mgr, nc)) {
         if (nc->handler != ev_handler)
             continue;
 
+        char const *buf = NULL;
+        size_t len      = 0;
         struct nc_context *cctx = nc->user_data; // might not be valid
         if (is_websocket(nc)) {
-            mg_send_websocket_frame(nc, WEBSOCKET_OP_TEXT, msg, len);
+            buf = http_msg_ws_frame(msg, &len);
         }
         else if (cctx && cctx->is_chunked) {
-            mg_send_http_chunk(nc, msg, len);
-            mg_send_http_chunk(nc, "\r\n", 2);
+            buf = http_msg_chunk(msg, &len);
             mg_set_timer(nc, mg_time() + KEEP_ALIVE); // reset keep alive timer
         }
         else if (cctx && !cctx->is_chunked) {
-            mg_send(nc, msg, len);
-            mg_send(nc, "\r\n", 2);
+            buf = msg->json;
+            len = msg->len + 2;
             mg_set_timer(nc, mg_time() + KEEP_ALIVE); // reset keep alive timer
         }
+        if (buf)
+            mg_send(nc, buf, (int)len);
     }
+
+    http_msg_release(ring_list_push(ctx->history, http_msg_retain(msg)));
+    http_msg_release(msg);
 }
 
 static struct http_server_context *http_server_start(struct mg_mgr *mgr, char const *host, char const *port, r_cfg_t *cfg, struct data_output *output)
@@ -1176,7 +1491,7 @@ static int http_server_stop(struct http_server_context *ctx)
     }
 
     for (void **iter = ring_list_iter(ctx->history); iter; iter = ring_list_next(ctx->history, iter))
-        free((data_t *)*iter);
+        http_msg_release(*iter);
     ring_list_free(ctx->history);
 
     return 0;
@@ -1206,6 +1521,7 @@ static void R_API_CALLCONV print_http_data(data_output_t *output, data_t *data,
         char buf[2048]; // we expect the biggest strings to be around 500 bytes.
         size_t len = data_print_jsons(data, buf, sizeof(buf));
         http_broadcast_send(http->server, buf, len);
+        output->stats.bytes += len;
     }
     else {
         // "states"
@@ -1217,6 +1533,7 @@ static void R_API_CALLCONV print_http_data(data_output_t *output, data_t *data,
         }
         size_t len = data_print_jsons(data, buf, buf_size);
         http_broadcast_send(http->server, buf, len);
+        output->stats.bytes += len;
         free(buf);
     }
 }
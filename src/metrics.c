@@ -0,0 +1,173 @@
+/** @file
+    Pipeline metrics, counters and histograms for the processing stages.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+// clock_gettime() needs _POSIX_C_SOURCE 199309L
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+#include "metrics.h"
+#include "r_util.h"
+
+// a sample buffer takes about 0.1 ms to 10 ms to process
+static double const buffer_seconds_bounds[] = {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1};
+// PD_MIN_PULSES to PD_MAX_PULSES
+static double const package_pulses_bounds[] = {16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384};
+
+void metrics_init(pipeline_metrics_t *metrics)
+{
+    memset(metrics, 0, sizeof(*metrics));
+    metrics->start_time                = metrics_wall_time();
+    metrics->buffer_seconds.bounds     = buffer_seconds_bounds;
+    metrics->buffer_seconds.num_bounds = sizeof(buffer_seconds_bounds) / sizeof(*buffer_seconds_bounds);
+    metrics->package_pulses.bounds     = package_pulses_bounds;
+    metrics->package_pulses.num_bounds = sizeof(package_pulses_bounds) / sizeof(*package_pulses_bounds);
+}
+
+double metrics_cpu_time(void)
+{
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+        return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+    return (double)clock() / CLOCKS_PER_SEC;
+}
+
+double metrics_stage_end(pipeline_metrics_t *metrics, enum metrics_stage stage, double start)
+{
+    double now = metrics_cpu_time();
+    metrics->stage_seconds[stage] += now - start;
+    return now;
+}
+
+void metrics_histogram_observe(metrics_histogram_t *hist, double value)
+{
+    unsigned i = 0;
+    while (i < hist->num_bounds && value > hist->bounds[i])
+        ++i;
+    hist->buckets[i]++;
+    hist->count++;
+    hist->sum += value;
+}
+
+char const *metrics_stage_name(enum metrics_stage stage)
+{
+    switch (stage) {
+    case METRICS_STAGE_DEMOD:  return "demod";
+    case METRICS_STAGE_DETECT: return "detect";
+    case METRICS_STAGE_DECODE: return "decode";
+    case METRICS_STAGE_OUTPUT: return "output";
+    default:                   return "unknown";
+    }
+}
+
+double metrics_wall_time(void)
+{
+    struct timeval tv;
+    get_time_now(&tv);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+void metrics_latency_observe(metrics_latency_t *lat, double seconds)
+{
+    if (seconds < 0.0)
+        seconds = 0.0;
+    double us = seconds * 1e6;
+    unsigned i = 0;
+    if (us > 1.0) {
+        double step = ceil(log2(us) * METRICS_LATENCY_STEPS);
+        i = step < METRICS_LATENCY_BUCKETS - 1 ? (unsigned)step : METRICS_LATENCY_BUCKETS - 1;
+    }
+    lat->buckets[i]++;
+    lat->count++;
+    lat->sum += seconds;
+    if (seconds > lat->max)
+        lat->max = seconds;
+}
+
+void metrics_latency_add(pipeline_metrics_t *metrics, enum metrics_latency_stage stage, double seconds)
+{
+    metrics_latency_observe(&metrics->latency[stage], seconds);
+    metrics_latency_observe(&metrics->latency_interval[stage], seconds);
+}
+
+double metrics_latency_quantile(metrics_latency_t const *lat, double q)
+{
+    if (!lat->count)
+        return 0.0;
+    uint64_t rank = (uint64_t)ceil(q * lat->count);
+    if (rank < 1)
+        rank = 1;
+    uint64_t count = 0;
+    for (unsigned i = 0; i < METRICS_LATENCY_BUCKETS; ++i) {
+        count += lat->buckets[i];
+        if (count >= rank) {
+            double upper = pow(2.0, (double)i / METRICS_LATENCY_STEPS) * 1e-6;
+            return upper < lat->max ? upper : lat->max;
+        }
+    }
+    return lat->max;
+}
+
+char const *metrics_latency_name(enum metrics_latency_stage stage)
+{
+    switch (stage) {
+    case METRICS_LATENCY_EOP:    return "eop";
+    case METRICS_LATENCY_DECODE: return "decode";
+    case METRICS_LATENCY_OUTPUT: return "output";
+    case METRICS_LATENCY_TOTAL:  return "total";
+    default:                     return "unknown";
+    }
+}
+
+static void metrics_histogram_merge(metrics_histogram_t *hist, metrics_histogram_t const *other)
+{
+    for (unsigned i = 0; i <= hist->num_bounds; ++i)
+        hist->buckets[i] += other->buckets[i];
+    hist->count += other->count;
+    hist->sum += other->sum;
+}
+
+static void metrics_latency_merge(metrics_latency_t *lat, metrics_latency_t const *other)
+{
+    for (unsigned i = 0; i < METRICS_LATENCY_BUCKETS; ++i)
+        lat->buckets[i] += other->buckets[i];
+    lat->count += other->count;
+    lat->sum += other->sum;
+    if (other->max > lat->max)
+        lat->max = other->max;
+}
+
+void metrics_merge(pipeline_metrics_t *metrics, pipeline_metrics_t const *other)
+{
+    metrics->buffers += other->buffers;
+    metrics->samples += other->samples;
+    metrics->buffers_squelched += other->buffers_squelched;
+    metrics->packages_ook += other->packages_ook;
+    metrics->packages_fsk += other->packages_fsk;
+    metrics->noise_db = other->noise_db;
+    for (int i = 0; i < METRICS_STAGE_COUNT; ++i)
+        metrics->stage_seconds[i] += other->stage_seconds[i];
+    metrics_histogram_merge(&metrics->buffer_seconds, &other->buffer_seconds);
+    metrics_histogram_merge(&metrics->package_pulses, &other->package_pulses);
+    metrics->output_wall_seconds += other->output_wall_seconds;
+    for (int i = 0; i < METRICS_LATENCY_COUNT; ++i) {
+        metrics_latency_merge(&metrics->latency[i], &other->latency[i]);
+        metrics_latency_merge(&metrics->latency_interval[i], &other->latency_interval[i]);
+    }
+    for (int i = 0; i < METRICS_OUTPUTS_MAX; ++i)
+        metrics_latency_merge(&metrics->output_latency[i], &other->output_latency[i]);
+}
@@ -116,7 +116,8 @@ static void R_API_CALLCONV print_json_flush(data_output_t *output)
 
     if (json && json->file) {
         fputc('\n', json->file);
-        fflush(json->file);
+        if (fflush(json->file) != 0)
+            output->stats.errors++;
     }
 }
 
@@ -311,7 +312,8 @@ static void R_API_CALLCONV print_kv_flush(data_output_t *output)
 
     if (kv && kv->file) {
         fputc('\n', kv->file);
-        fflush(kv->file);
+        if (fflush(kv->file) != 0)
+            output->stats.errors++;
     }
 }
 
@@ -358,41 +360,91 @@ typedef struct {
     struct data_output output;
     FILE *file;
     const char **fields;
+    int num_fields;
+    int *columns;        ///< hash table of column index + 1, 0 marks an empty slot
+    unsigned columns_mask;
+    data_t **row;        ///< values of the current row, sparse by column
+    char *buf;           ///< the current line
+    size_t buf_len;
+    size_t buf_size;
     int data_recursion;
     const char *separator;
 } data_output_csv_t;
 
+static unsigned csv_hash(const char *key)
+{
+    unsigned h = 2166136261u; // FNV-1a
+    while (*key) {
+        h ^= (unsigned char)*key++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/// Column index of a key, -1 if the key is not a column.
+static int csv_column(data_output_csv_t *csv, const char *key)
+{
+    unsigned mask = csv->columns_mask;
+    for (unsigned i = csv_hash(key) & mask; csv->columns[i]; i = (i + 1) & mask) {
+        int col = csv->columns[i] - 1;
+        if (!strcmp(csv->fields[col], key))
+            return col;
+    }
+    return -1;
+}
+
+static int csv_reserve(data_output_csv_t *csv, size_t len)
+{
+    if (csv->buf_len + len < csv->buf_size)
+        return 1;
+    size_t size = csv->buf_size ? csv->buf_size : 1024;
+    while (csv->buf_len + len >= size)
+        size *= 2;
+    char *buf = realloc(csv->buf, size);
+    if (!buf) {
+        WARN_REALLOC("csv_reserve()");
+        return 0;
+    }
+    csv->buf      = buf;
+    csv->buf_size = size;
+    return 1;
+}
+
+static void csv_append(data_output_csv_t *csv, const char *str, size_t len)
+{
+    if (!csv_reserve(csv, len))
+        return;
+    memcpy(&csv->buf[csv->buf_len], str, len);
+    csv->buf_len += len;
+}
+
 static void R_API_CALLCONV print_csv_data(data_output_t *output, data_t *data, char const *format)
 {
     UNUSED(format);
     data_output_csv_t *csv = (data_output_csv_t *)output;
 
-    const char **fields = csv->fields;
-    int i;
-
-    if (csv->data_recursion)
+    if (csv->data_recursion || !csv->row)
         return;
 
+    // fill the row in one pass, the first of duplicate keys wins
     int regular = 0; // skip "states" output
     for (data_t *d = data; d; d = d->next) {
-        if (!strcmp(d->key, "msg") || !strcmp(d->key, "codes") || !strcmp(d->key, "model")) {
+        if (!strcmp(d->key, "msg") || !strcmp(d->key, "codes") || !strcmp(d->key, "model"))
             regular = 1;
-            break;
-        }
+        int col = csv_column(csv, d->key);
+        if (col >= 0 && !csv->row[col])
+            csv->row[col] = d;
     }
-    if (!regular)
-        return;
 
+    size_t sep_len = strlen(csv->separator);
     ++csv->data_recursion;
-    for (i = 0; fields[i]; ++i) {
-        const char *key = fields[i];
-        data_t *found = NULL;
+    for (int i = 0; i < csv->num_fields; ++i) {
+        data_t *found = csv->row[i];
+        csv->row[i]   = NULL;
+        if (!regular)
+            continue;
         if (i)
-            fprintf(csv->file, "%s", csv->separator);
-        for (data_t *iter = data; !found && iter; iter = iter->next)
-            if (strcmp(iter->key, key) == 0)
-                found = iter;
-
+            csv_append(csv, csv->separator, sep_len);
         if (found)
             print_value(output, found->type, found->value, found->format);
     }
@@ -405,7 +457,7 @@ static void R_API_CALLCONV print_csv_array(data_output_t *output, data_array_t *
 
     for (int c = 0; c < array->num_values; ++c) {
         if (c)
-            fprintf(csv->file, ";");
+            csv_append(csv, ";", 1);
         print_array_value(output, array, format, c);
     }
 }
@@ -415,10 +467,14 @@ static void R_API_CALLCONV print_csv_string(data_output_t *output, const char *s
     UNUSED(format);
     data_output_csv_t *csv = (data_output_csv_t *)output;
 
+    size_t sep_len = strlen(csv->separator);
+    // worst case every char is escaped
+    if (!csv_reserve(csv, 2 * strlen(str)))
+        return;
     while (*str) {
-        if (strncmp(str, csv->separator, strlen(csv->separator)) == 0)
-            fputc('\\', csv->file);
-        fputc(*str, csv->file);
+        if (strncmp(str, csv->separator, sep_len) == 0)
+            csv->buf[csv->buf_len++] = '\\';
+        csv->buf[csv->buf_len++] = *str;
         ++str;
     }
 }
@@ -490,8 +546,34 @@ static void R_API_CALLCONV data_output_csv_start(struct data_output *output, cha
         }
     }
     csv->fields[csv_fields] = NULL;
+    csv->num_fields = csv_fields;
     free((void *)allowed);
+    allowed = NULL;
     free(use_count);
+    use_count = NULL;
+
+    // Map each key to its column, the table is kept at most half full
+    unsigned num_slots = 16;
+    while (num_slots < 2 * (unsigned)csv_fields)
+        num_slots *= 2;
+    csv->columns = calloc(num_slots, sizeof(*csv->columns));
+    if (!csv->columns) {
+        WARN_CALLOC("data_output_csv_start()");
+        goto alloc_error;
+    }
+    csv->columns_mask = num_slots - 1;
+    for (i = 0; i < csv_fields; ++i) {
+        unsigned slot = csv_hash(csv->fields[i]) & csv->columns_mask;
+        while (csv->columns[slot])
+            slot = (slot + 1) & csv->columns_mask;
+        csv->columns[slot] = i + 1;
+    }
+
+    csv->row = calloc(csv_fields + 1, sizeof(*csv->row)); // '+ 1' so we never alloc size 0
+    if (!csv->row) {
+        WARN_CALLOC("data_output_csv_start()");
+        goto alloc_error;
+    }
 
     // Output the CSV header
     for (i = 0; csv->fields[i]; ++i) {
@@ -503,8 +585,11 @@ static void R_API_CALLCONV data_output_csv_start(struct data_output *output, cha
 alloc_error:
     free(use_count);
     free((void *)allowed);
-    if (csv)
+    if (csv) {
         free((void *)csv->fields);
+        free(csv->columns);
+        free(csv->row);
+    }
     free(csv);
 }
 
@@ -513,7 +598,9 @@ static void R_API_CALLCONV print_csv_double(data_output_t *output, double data,
     UNUSED(format);
     data_output_csv_t *csv = (data_output_csv_t *)output;
 
-    fprintf(csv->file, "%.3f", data);
+    char str[400]; // fits any double in "%.3f"
+    int len = snprintf(str, sizeof(str), "%.3f", data);
+    csv_append(csv, str, len);
 }
 
 static void R_API_CALLCONV print_csv_int(data_output_t *output, int data, char const *format)
@@ -521,7 +608,9 @@ static void R_API_CALLCONV print_csv_int(data_output_t *output, int data, char c
     UNUSED(format);
     data_output_csv_t *csv = (data_output_csv_t *)output;
 
-    fprintf(csv->file, "%d", data);
+    char str[16];
+    int len = snprintf(str, sizeof(str), "%d", data);
+    csv_append(csv, str, len);
 }
 
 static void R_API_CALLCONV print_csv_flush(data_output_t *output)
@@ -529,8 +618,12 @@ static void R_API_CALLCONV print_csv_flush(data_output_t *output)
     data_output_csv_t *csv = (data_output_csv_t *)output;
 
     if (csv && csv->file) {
-        fputc('\n', csv->file);
-        fflush(csv->file);
+        csv_append(csv, "\n", 1);
+        size_t written = fwrite(csv->buf, 1, csv->buf_len, csv->file);
+        output->stats.bytes += written;
+        if (written != csv->buf_len || fflush(csv->file) != 0)
+            output->stats.errors++;
+        csv->buf_len = 0;
     }
 }
 
@@ -539,6 +632,9 @@ static void R_API_CALLCONV data_output_csv_free(data_output_t *output)
     data_output_csv_t *csv = (data_output_csv_t *)output;
 
     free((void *)csv->fields);
+    free(csv->columns);
+    free(csv->row);
+    free(csv->buf);
     free(csv);
 }
 
@@ -25,24 +25,162 @@
 
 #include "mongoose.h"
 
+#ifdef ZLIB
+#include <zlib.h>
+#endif
+
 /* InfluxDB client abstraction / printer */
 
+#define INFLUX_BATCH_SIZE       (64 * 1024) ///< default bytes of line protocol per request
+#define INFLUX_BATCH_LATENCY    1000 ///< default ms a line may wait for its batch
+#define INFLUX_SPOOL_MAX        (10 * 1024 * 1024) ///< default max bytes kept in the spool file
+#define INFLUX_RETRY_MIN        1.0 ///< seconds to wait after the first failure
+#define INFLUX_RETRY_MAX        30.0 ///< seconds to wait at most between retries
+#define INFLUX_MEM_BATCHES      8 ///< without spool keep at most this many batches in memory
+
 typedef struct {
     struct data_output output;
     struct mg_mgr *mgr;
     struct mg_connection *conn;
+    struct mg_connection *timer; ///< standalone timer for batch deadlines and retries, exists without a connection
+    int conn_ready; ///< connected, the connection is kept alive between requests
     int prev_status;
     int prev_resp_code;
     char hostname[64];
     char url[400];
+    char address[300]; ///< connect address as "tcp://host:port"
+    char host[256]; ///< Host header
+    char path[400]; ///< request path and query
+    int use_ssl;
     char extra_headers[150];
-    int databufidxfill;
-    struct mbuf databufs[2];
-
+    size_t batch_size;
+    double batch_latency;
+    double batch_deadline;
+    double retry_delay;
+    double retry_time;
+    int gzip;
+    struct mbuf databuf; ///< lines collected for the next batch
+    struct mbuf sendbuf; ///< lines of the request in flight, kept until acknowledged
+    size_t sendbuf_spooled; ///< number of bytes in sendbuf that were read from the spool
+    struct mbuf zbuf; ///< compressed request body
+    char spool_path[256];
+    FILE *spool;
+    long spool_pos; ///< read position of the oldest unsent line in the spool
+    long spool_len;
+    long spool_max;
 } influx_client_t;
 
 static void influx_client_send(influx_client_t *ctx);
 
+/// append lines to the spool file, returns the number of bytes dropped
+static size_t influx_spool_write(influx_client_t *ctx, char const *buf, size_t len)
+{
+    if (!ctx->spool)
+        return len;
+    if (ctx->spool_len + (long)len > ctx->spool_max)
+        return len;
+
+    fseek(ctx->spool, ctx->spool_len, SEEK_SET);
+    size_t n = fwrite(buf, 1, len, ctx->spool);
+    fflush(ctx->spool);
+    ctx->spool_len += n;
+    return len - n;
+}
+
+/// read the oldest lines from the spool file into sendbuf, up to a batch size
+static size_t influx_spool_read(influx_client_t *ctx)
+{
+    size_t len = ctx->spool_len - ctx->spool_pos;
+    if (len > ctx->batch_size)
+        len = ctx->batch_size;
+
+    mbuf_resize(&ctx->sendbuf, len);
+    fseek(ctx->spool, ctx->spool_pos, SEEK_SET);
+    len = fread(ctx->sendbuf.buf, 1, len, ctx->spool);
+    // only send whole lines, unless a single line is larger than a batch
+    size_t whole = len;
+    while (whole > 0 && ctx->sendbuf.buf[whole - 1] != '\n')
+        whole--;
+    if (whole > 0)
+        len = whole;
+
+    ctx->sendbuf.len     = len;
+    ctx->sendbuf_spooled = len;
+    return len;
+}
+
+/// mark spooled lines as sent, truncates the spool once it is fully drained
+static void influx_spool_consume(influx_client_t *ctx, size_t len)
+{
+    ctx->spool_pos += len;
+    if (ctx->spool_pos < ctx->spool_len)
+        return;
+
+    FILE *spool = freopen(ctx->spool_path, "w+b", ctx->spool);
+    if (!spool)
+        fprintf(stderr, "InfluxDB spool file \"%s\" can't be truncated\n", ctx->spool_path);
+    ctx->spool     = spool;
+    ctx->spool_pos = 0;
+    ctx->spool_len = 0;
+}
+
+/// put back lines that could not be sent, to the spool file if there is one, otherwise to memory
+static void influx_client_requeue(influx_client_t *ctx, struct mbuf *buf)
+{
+    size_t dropped = 0;
+    if (ctx->spool) {
+        dropped = influx_spool_write(ctx, buf->buf, buf->len);
+    }
+    else if (ctx->databuf.len + buf->len <= INFLUX_MEM_BATCHES * ctx->batch_size) {
+        mbuf_insert(&ctx->databuf, 0, buf->buf, buf->len);
+    }
+    else {
+        dropped = buf->len;
+    }
+    if (dropped) {
+        fprintf(stderr, "InfluxDB unreachable, dropping %zu bytes of data\n", dropped);
+        ctx->output.stats.errors++;
+    }
+    buf->len = 0;
+}
+
+static void influx_client_retry_later(influx_client_t *ctx)
+{
+    ctx->retry_delay = ctx->retry_delay ? ctx->retry_delay * 2 : INFLUX_RETRY_MIN;
+    if (ctx->retry_delay > INFLUX_RETRY_MAX)
+        ctx->retry_delay = INFLUX_RETRY_MAX;
+    ctx->retry_time = mg_time() + ctx->retry_delay;
+}
+
+static void influx_client_reply(influx_client_t *ctx, int resp_code, struct mg_str body)
+{
+    if (resp_code >= 200 && resp_code < 300) {
+        // mark influx data as sent
+        if (ctx->sendbuf_spooled)
+            influx_spool_consume(ctx, ctx->sendbuf_spooled);
+        ctx->retry_delay = 0;
+        ctx->retry_time  = 0;
+    }
+    else {
+        ctx->output.stats.errors++;
+        if (ctx->prev_resp_code != resp_code)
+            fprintf(stderr, "InfluxDB replied HTTP code: %d with message:\n%.*s\n", resp_code, (int)body.len, body.p);
+        if (resp_code == 429 || resp_code >= 500) {
+            // server overloaded or down, try again later
+            if (!ctx->sendbuf_spooled)
+                influx_client_requeue(ctx, &ctx->sendbuf);
+            influx_client_retry_later(ctx);
+        }
+        else if (ctx->sendbuf_spooled) {
+            // the data itself is rejected, retrying won't help
+            influx_spool_consume(ctx, ctx->sendbuf_spooled);
+        }
+    }
+    ctx->prev_resp_code  = resp_code;
+    ctx->sendbuf.len     = 0;
+    ctx->sendbuf_spooled = 0;
+}
+
 static void influx_client_event(struct mg_connection *nc, int ev, void *ev_data)
 {
     // note that while shutting down the ctx is NULL
@@ -54,68 +192,200 @@ static void influx_client_event(struct mg_connection *nc, int ev, void *ev_data)
         int connect_status = *(int *)ev_data;
         if (connect_status != 0) {
             // Error, print only once
-            if (ctx) {
-                if (ctx->prev_status != connect_status)
-                    fprintf(stderr, "InfluxDB connect error: %s\n", strerror(connect_status));
-                ctx->conn = NULL;
-            }
+            if (ctx && ctx->prev_status != connect_status)
+                fprintf(stderr, "InfluxDB connect error: %s\n", strerror(connect_status));
         }
-        if (ctx)
+        if (ctx) {
             ctx->prev_status = connect_status;
+            ctx->conn_ready  = connect_status == 0;
+            influx_client_send(ctx);
+        }
         break;
     }
-    case MG_EV_HTTP_CHUNK: // response is normally empty (so mongoose thinks we received a chunk only)
+    case MG_EV_HTTP_CHUNK:
+        // a 204 response has no Content-Length (so mongoose thinks we received a chunk only)
+        if (hm->resp_code != 204)
+            break;
+        // the response is complete, drop it to keep the connection usable
+        nc->recv_mbuf.len = 0;
+        // fall through
     case MG_EV_HTTP_REPLY:
-        nc->flags |= MG_F_CLOSE_IMMEDIATELY;
-        if (hm->resp_code == 204) {
-            // mark influx data as sent
-        }
-        else {
-            if (ctx && ctx->prev_resp_code != hm->resp_code)
-                fprintf(stderr, "InfluxDB replied HTTP code: %d with message:\n%s\n", hm->resp_code, hm->body.p);
-        }
         if (ctx) {
-            ctx->prev_resp_code = hm->resp_code;
+            influx_client_reply(ctx, hm->resp_code, hm->body);
+            influx_client_send(ctx);
         }
         break;
     case MG_EV_CLOSE:
-        if (ctx) {
-            ctx->conn = NULL;
-            influx_client_send(ctx);
+        if (!ctx)
+            break; // shutting down
+        if (!ctx->conn_ready || ctx->sendbuf.len) {
+            // connect failed or the request got no reply
+            if (ctx->sendbuf.len && !ctx->sendbuf_spooled)
+                influx_client_requeue(ctx, &ctx->sendbuf);
+            ctx->sendbuf.len     = 0;
+            ctx->sendbuf_spooled = 0;
+            influx_client_retry_later(ctx);
         }
+        // otherwise the keep-alive connection was closed while idle
+        ctx->conn       = NULL;
+        ctx->conn_ready = 0;
+        influx_client_send(ctx);
         break;
     }
 }
 
+static void influx_timer_event(struct mg_connection *nc, int ev, void *ev_data)
+{
+    UNUSED(ev_data);
+    // note that while shutting down the ctx is NULL
+    influx_client_t *ctx = (influx_client_t *)nc->user_data;
+    if (ev == MG_EV_TIMER && ctx)
+        influx_client_send(ctx);
+}
+
 static influx_client_t *influx_client_init(influx_client_t *ctx, char const *url, char const *token)
 {
     strncpy(ctx->url, url, sizeof(ctx->url));
     ctx->url[sizeof(ctx->url) - 1] = '\0';
-    snprintf(ctx->extra_headers, sizeof (ctx->extra_headers), "Authorization: Token %s\r\n", token);
+    if (token)
+        snprintf(ctx->extra_headers, sizeof (ctx->extra_headers), "Authorization: Token %s\r\n", token);
+
+    // split the URL, the connection is kept alive and requests are written directly
+    struct mg_str scheme, host, path, query;
+    unsigned port = 0;
+    mg_parse_uri(mg_mk_str(ctx->url), &scheme, NULL, &host, &port, &path, &query, NULL);
+    ctx->use_ssl = scheme.len == 5; // "https"
+    if (!port)
+        port = ctx->use_ssl ? 443 : 80;
+    snprintf(ctx->address, sizeof(ctx->address), "tcp://%.*s:%u", (int)host.len, host.p, port);
+    snprintf(ctx->host, sizeof(ctx->host), "%.*s", (int)host.len, host.p);
+    snprintf(ctx->path, sizeof(ctx->path), "%.*s?%.*s", (int)path.len, path.p, (int)query.len, query.p);
 
     return ctx;
 }
 
+static void influx_client_connect(influx_client_t *ctx)
+{
+    struct mg_connect_opts opts = {.user_data = ctx};
+    if (ctx->use_ssl) {
+#if MG_ENABLE_SSL
+        opts.ssl_ca_cert     = "*"; // TLS is enabled but no cert verification is performed.
+        opts.ssl_server_name = ctx->host;
+#else
+        fprintf(stderr, "InfluxDB https (TLS) not available\n");
+        exit(1);
+#endif
+    }
+    ctx->conn_ready = 0;
+    if ((ctx->conn = mg_connect_opt(ctx->mgr, ctx->address, influx_client_event, opts)) == NULL) {
+        fprintf(stderr, "Connect to InfluxDB (%s) failed\n", ctx->url);
+        influx_client_retry_later(ctx);
+        return;
+    }
+    mg_set_protocol_http_websocket(ctx->conn);
+}
+
+#ifdef ZLIB
+/// compress a request body with a gzip wrapper, returns 0 on success
+static int influx_gzip(struct mbuf *dst, char const *src, size_t len)
+{
+    z_stream zs = {0};
+    if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return -1;
+
+    size_t bound = deflateBound(&zs, len);
+    mbuf_resize(dst, bound);
+    zs.next_in   = (Bytef *)src;
+    zs.avail_in  = len;
+    zs.next_out  = (Bytef *)dst->buf;
+    zs.avail_out = bound;
+    int ret      = deflate(&zs, Z_FINISH);
+    dst->len     = bound - zs.avail_out;
+    deflateEnd(&zs);
+
+    return ret == Z_STREAM_END ? 0 : -1;
+}
+#endif
+
+static void influx_client_post(influx_client_t *ctx)
+{
+    char const *body = ctx->sendbuf.buf;
+    size_t len       = ctx->sendbuf.len;
+    char const *encoding = "";
+#ifdef ZLIB
+    if (ctx->gzip && influx_gzip(&ctx->zbuf, body, len) == 0) {
+        body     = ctx->zbuf.buf;
+        len      = ctx->zbuf.len;
+        encoding = "Content-Encoding: gzip\r\n";
+    }
+#endif
+
+    mg_printf(ctx->conn, "POST %s HTTP/1.1\r\n"
+                         "Host: %s\r\n"
+                         "Content-Type: text/plain; charset=utf-8\r\n"
+                         "Content-Length: %zu\r\n"
+                         "%s%s\r\n",
+            ctx->path, ctx->host, len, encoding, ctx->extra_headers);
+    mg_send(ctx->conn, body, len);
+    ctx->output.stats.bytes += len;
+}
+
+/// move the collected lines out of memory while the server is unreachable
+static void influx_client_shed(influx_client_t *ctx)
+{
+    if (ctx->spool && ctx->databuf.len >= ctx->batch_size) {
+        influx_client_requeue(ctx, &ctx->databuf);
+    }
+    else if (ctx->databuf.len > INFLUX_MEM_BATCHES * ctx->batch_size) {
+        fprintf(stderr, "InfluxDB unreachable, dropping %zu bytes of data\n", ctx->databuf.len);
+        ctx->output.stats.errors++;
+        ctx->databuf.len = 0;
+    }
+}
+
 static void influx_client_send(influx_client_t *ctx)
 {
-    struct mbuf *buf = &ctx->databufs[ctx->databufidxfill];
+    int spooled = ctx->spool && ctx->spool_pos < ctx->spool_len;
 
-    /*fprintf(stderr, "Influx %p msg: \"%s\" with %lu/%lu %s\n",
-            (void*)ctx, buf->buf, buf->len, buf->size,
-            ctx->conn ? "buffering" : "to be sent");*/
+    /*fprintf(stderr, "Influx %p msg: %lu/%lu spool %ld/%ld %s\n",
+            (void*)ctx, ctx->databuf.len, ctx->databuf.size, ctx->spool_pos, ctx->spool_len,
+            ctx->sendbuf.len ? "buffering" : "to be sent");*/
 
-    if (ctx->conn || !buf->len)
+    // nothing to send or still waiting for the reply to the previous request
+    if ((!ctx->databuf.len && !spooled) || ctx->sendbuf.len)
         return;
 
-    struct mg_connect_opts opts = {.user_data = ctx};
-    if ((ctx->conn = mg_connect_http_opt(ctx->mgr, influx_client_event, opts, ctx->url, ctx->extra_headers, buf->buf)) == NULL) {
-        fprintf(stderr, "Connect to InfluxDB (%s) failed\n", ctx->url);
+    double now = mg_time();
+    if (now < ctx->retry_time) {
+        influx_client_shed(ctx);
+        if (ctx->timer)
+            mg_set_timer(ctx->timer, ctx->retry_time);
+        return;
     }
-    else {
-        ctx->databufidxfill ^= 1;
-        buf->len = 0;
-        *buf->buf = '\0';
+
+    // connect ahead of time, the batch is sent on the kept-alive connection when due
+    if (!ctx->conn) {
+        influx_client_connect(ctx);
+        return;
+    }
+    if (!ctx->conn_ready)
+        return;
+
+    int due = spooled || ctx->databuf.len >= ctx->batch_size || now >= ctx->batch_deadline;
+    if (!due) {
+        if (ctx->timer)
+            mg_set_timer(ctx->timer, ctx->batch_deadline);
+        return;
+    }
+
+    // older spooled lines always go first
+    if (!spooled || !influx_spool_read(ctx)) {
+        struct mbuf tmp = ctx->sendbuf;
+        ctx->sendbuf    = ctx->databuf;
+        ctx->databuf    = tmp;
+        ctx->databuf.len = 0;
     }
+    influx_client_post(ctx);
 }
 
 /* Helper */
@@ -185,7 +455,7 @@ static void R_API_CALLCONV print_influx_array(data_output_t *output, data_array_
     UNUSED(array);
     UNUSED(format);
     influx_client_t *influx = (influx_client_t *)output;
-    struct mbuf *buf = &influx->databufs[influx->databufidxfill];
+    struct mbuf *buf = &influx->databuf;
     mbuf_snprintf(buf, "\"array\""); // TODO
 }
 
@@ -200,7 +470,7 @@ static void R_API_CALLCONV print_influx_string_escaped(data_output_t *output, ch
 {
     UNUSED(format);
     influx_client_t *influx = (influx_client_t *)output;
-    struct mbuf *databuf = &influx->databufs[influx->databufidxfill];
+    struct mbuf *databuf = &influx->databuf;
     size_t size = databuf->size - databuf->len;
     char *buf = &databuf->buf[databuf->len];
 
@@ -252,7 +522,7 @@ static void R_API_CALLCONV print_influx_string(data_output_t *output, char const
 {
     UNUSED(format);
     influx_client_t *influx = (influx_client_t *)output;
-    struct mbuf *buf = &influx->databufs[influx->databufidxfill];
+    struct mbuf *buf = &influx->databuf;
     mbuf_snprintf(buf, "%s", str);
 }
 
@@ -263,9 +533,13 @@ static void R_API_CALLCONV print_influx_data(data_output_t *output, data_t *data
     influx_client_t *influx = (influx_client_t *)output;
     char *str;
     char *end;
-    struct mbuf *buf = &influx->databufs[influx->databufidxfill];
+    struct mbuf *buf = &influx->databuf;
     bool comma = false;
 
+    // the first line of a new batch starts the latency timer
+    if (!buf->len)
+        influx->batch_deadline = mg_time() + influx->batch_latency;
+
     data_t *data_org = data;
     data_t *data_model = NULL;
     data_t *data_time = NULL;
@@ -380,7 +654,7 @@ static void R_API_CALLCONV print_influx_double(data_output_t *output, double dat
 {
     UNUSED(format);
     influx_client_t *influx = (influx_client_t *)output;
-    struct mbuf *buf = &influx->databufs[influx->databufidxfill];
+    struct mbuf *buf = &influx->databuf;
     mbuf_snprintf(buf, "%f", data);
 }
 
@@ -388,7 +662,7 @@ static void R_API_CALLCONV print_influx_int(data_output_t *output, int data, cha
 {
     UNUSED(format);
     influx_client_t *influx = (influx_client_t *)output;
-    struct mbuf *buf = &influx->databufs[influx->databufidxfill];
+    struct mbuf *buf = &influx->databuf;
     mbuf_snprintf(buf, "%d", data);
 }
 
@@ -404,7 +678,22 @@ static void R_API_CALLCONV data_output_influx_free(data_output_t *output)
         influx->conn->user_data = NULL;
         influx->conn->flags |= MG_F_CLOSE_IMMEDIATELY;
     }
+    if (influx->timer) {
+        influx->timer->user_data = NULL;
+        influx->timer->flags |= MG_F_CLOSE_IMMEDIATELY;
+    }
+
+    // keep unsent lines for the next run
+    if (influx->spool) {
+        if (influx->sendbuf.len && !influx->sendbuf_spooled)
+            influx_spool_write(influx, influx->sendbuf.buf, influx->sendbuf.len);
+        influx_spool_write(influx, influx->databuf.buf, influx->databuf.len);
+        fclose(influx->spool);
+    }
 
+    mbuf_free(&influx->databuf);
+    mbuf_free(&influx->sendbuf);
+    mbuf_free(&influx->zbuf);
     free(influx);
 }
 
@@ -424,6 +713,10 @@ struct data_output *data_output_influx_create(struct mg_mgr *mgr, char *opts)
     influx_sanitize_tag(influx->hostname, NULL);
 
     char *token = NULL;
+    char *spool = NULL;
+    influx->batch_size    = INFLUX_BATCH_SIZE;
+    influx->batch_latency = INFLUX_BATCH_LATENCY / 1000.0;
+    influx->spool_max     = INFLUX_SPOOL_MAX;
 
     // param/opts starts with URL
     char *url = opts;
@@ -459,12 +752,45 @@ struct data_output *data_output_influx_create(struct mg_mgr *mgr, char *opts)
             continue;
         else if (!strcasecmp(key, "t") || !strcasecmp(key, "token"))
             token = val;
+        else if (!strcasecmp(key, "b") || !strcasecmp(key, "batch"))
+            influx->batch_size = atouint32_metric(val, "batch= ");
+        else if (!strcasecmp(key, "l") || !strcasecmp(key, "latency"))
+            influx->batch_latency = atoiv(val, INFLUX_BATCH_LATENCY) / 1000.0;
+        else if (!strcasecmp(key, "z") || !strcasecmp(key, "gzip"))
+            influx->gzip = atobv(val, 1);
+        else if (!strcasecmp(key, "spool"))
+            spool = val;
+        else if (!strcasecmp(key, "spool_max"))
+            influx->spool_max = atouint32_metric(val, "spool_max= ");
         else {
             fprintf(stderr, "Invalid key \"%s\" option.\n", key);
             exit(1);
         }
     }
 
+#ifndef ZLIB
+    if (influx->gzip) {
+        fprintf(stderr, "InfluxDB gzip compression not available\n");
+        exit(1);
+    }
+#endif
+    if (!influx->batch_size)
+        influx->batch_size = 1;
+
+    if (spool && *spool) {
+        snprintf(influx->spool_path, sizeof(influx->spool_path), "%s", spool);
+        // replay lines left over from a previous run
+        influx->spool = fopen(influx->spool_path, "r+b");
+        if (!influx->spool)
+            influx->spool = fopen(influx->spool_path, "w+b");
+        if (!influx->spool) {
+            fprintf(stderr, "InfluxDB spool file \"%s\" can't be opened\n", influx->spool_path);
+            exit(1);
+        }
+        fseek(influx->spool, 0, SEEK_END);
+        influx->spool_len = ftell(influx->spool);
+    }
+
     influx->output.print_data   = print_influx_data;
     influx->output.print_array  = print_influx_array;
     influx->output.print_string = print_influx_string;
@@ -472,10 +798,17 @@ struct data_output *data_output_influx_create(struct mg_mgr *mgr, char *opts)
     influx->output.print_int    = print_influx_int;
     influx->output.output_free  = data_output_influx_free;
 
-    fprintf(stderr, "Publishing data to InfluxDB (%s)\n", url);
+    fprintf(stderr, "Publishing data to InfluxDB (%s) in batches of %zu bytes or %.0f ms%s\n", url,
+            influx->batch_size, influx->batch_latency * 1000.0, influx->gzip ? " (gzip)" : "");
 
     influx->mgr = mgr;
+    if (mgr) {
+        struct mg_add_sock_opts sock_opts = {0};
+        sock_opts.user_data = influx;
+        influx->timer = mg_add_sock_opt(mgr, INVALID_SOCKET, influx_timer_event, sock_opts);
+    }
     influx_client_init(influx, url, token);
+    influx_client_send(influx); // flush a non-empty spool
 
     return &influx->output;
 }
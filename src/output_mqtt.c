@@ -24,6 +24,9 @@
 
 /* MQTT client abstraction */
 
+#define MQTT_WINDOW_DEFAULT 20          // QoS 1 messages in flight, same as the mosquitto default
+#define MQTT_BACKLOG_MAX    (1024 * 1024) // QoS 1 messages held back while the window is full
+
 typedef struct mqtt_client {
     struct mg_connect_opts connect_opts;
     struct mg_send_mqtt_handshake_opts mqtt_opts;
@@ -33,8 +36,56 @@ typedef struct mqtt_client {
     char client_id[256];
     uint16_t message_id;
     int publish_flags; // MG_MQTT_RETAIN | MG_MQTT_QOS(0)
+    struct mbuf sendbuf; ///< PUBLISH packets of the current event, sent at once on flush
+    struct mbuf backlog; ///< QoS 1 PUBLISH packets waiting for the in-flight window
+    unsigned backlog_count;
+    unsigned inflight;
+    unsigned window; ///< max unacknowledged QoS 1 messages, 0 for unlimited
+    unsigned dropped;
+    data_output_stats_t *stats; ///< bytes sent and dropped messages are counted here
 } mqtt_client_t;
 
+/// length of the encoded MQTT packet at buf, 0 if incomplete
+static size_t mqtt_packet_len(char const *buf, size_t len)
+{
+    size_t remaining = 0;
+    for (size_t i = 1; i < len && i < 5; ++i) {
+        remaining |= (size_t)(buf[i] & 0x7f) << (7 * (i - 1));
+        if (!(buf[i] & 0x80))
+            return i + 1 + remaining <= len ? i + 1 + remaining : 0;
+    }
+    return 0;
+}
+
+/// move backlogged packets into the send buffer while the window allows
+static void mqtt_client_release(mqtt_client_t *ctx)
+{
+    size_t len = 0;
+    while (ctx->backlog_count && (!ctx->window || ctx->inflight < ctx->window)) {
+        size_t pkt_len = mqtt_packet_len(ctx->backlog.buf + len, ctx->backlog.len - len);
+        if (!pkt_len)
+            break;
+        len += pkt_len;
+        ctx->backlog_count--;
+        ctx->inflight++;
+    }
+    if (!len)
+        return;
+    mbuf_append(&ctx->sendbuf, ctx->backlog.buf, len);
+    mbuf_remove(&ctx->backlog, len);
+}
+
+static void mqtt_client_flush(mqtt_client_t *ctx)
+{
+    if (!ctx->sendbuf.len)
+        return;
+    if (ctx->conn && ctx->conn->proto_handler) {
+        mg_send(ctx->conn, ctx->sendbuf.buf, (int)ctx->sendbuf.len);
+        ctx->stats->bytes += ctx->sendbuf.len;
+    }
+    ctx->sendbuf.len = 0;
+}
+
 static void mqtt_client_event(struct mg_connection *nc, int ev, void *ev_data)
 {
     // note that while shutting down the ctx is NULL
@@ -70,10 +121,19 @@ static void mqtt_client_event(struct mg_connection *nc, int ev, void *ev_data)
         }
         else {
             fprintf(stderr, "MQTT Connection established.\n");
+            if (ctx) {
+                mqtt_client_release(ctx);
+                mqtt_client_flush(ctx);
+            }
         }
         break;
     case MG_EV_MQTT_PUBACK:
-        fprintf(stderr, "MQTT Message publishing acknowledged (msg_id: %u)\n", msg->message_id);
+        if (ctx) {
+            if (ctx->inflight)
+                ctx->inflight--;
+            mqtt_client_release(ctx);
+            mqtt_client_flush(ctx);
+        }
         break;
     case MG_EV_MQTT_SUBACK:
         fprintf(stderr, "MQTT Subscription acknowledged.\n");
@@ -88,6 +148,9 @@ static void mqtt_client_event(struct mg_connection *nc, int ev, void *ev_data)
             break; // shuttig down
         if (ctx->prev_status == 0)
             fprintf(stderr, "MQTT Connection failed...\n");
+        // unacknowledged messages are lost with the connection
+        ctx->inflight     = 0;
+        ctx->sendbuf.len  = 0;
         // reconnect
         char const *error_string = NULL;
         ctx->connect_opts.error_string = &error_string;
@@ -101,7 +164,7 @@ static void mqtt_client_event(struct mg_connection *nc, int ev, void *ev_data)
     }
 }
 
-static mqtt_client_t *mqtt_client_init(struct mg_mgr *mgr, tls_opts_t *tls_opts, char const *host, char const *port, char const *user, char const *pass, char const *client_id, int retain, int qos)
+static mqtt_client_t *mqtt_client_init(struct mg_mgr *mgr, tls_opts_t *tls_opts, char const *host, char const *port, char const *user, char const *pass, char const *client_id, int retain, int qos, unsigned window)
 {
     mqtt_client_t *ctx = calloc(1, sizeof(*ctx));
     if (!ctx)
@@ -110,6 +173,9 @@ static mqtt_client_t *mqtt_client_init(struct mg_mgr *mgr, tls_opts_t *tls_opts,
     ctx->mqtt_opts.user_name = user;
     ctx->mqtt_opts.password  = pass;
     ctx->publish_flags  = MG_MQTT_QOS(qos) | (retain ? MG_MQTT_RETAIN : 0);
+    ctx->window         = window;
+    mbuf_init(&ctx->sendbuf, 4096);
+    mbuf_init(&ctx->backlog, 0);
     // TODO: these should be user configurable options
     //ctx->opts.keepalive = 60;
     //ctx->timeout = 10000L;
@@ -151,13 +217,64 @@ static mqtt_client_t *mqtt_client_init(struct mg_mgr *mgr, tls_opts_t *tls_opts,
     return ctx;
 }
 
+/// Encode a PUBLISH packet into the send buffer, QoS 1 packets over the window go to the backlog.
 static void mqtt_client_publish(mqtt_client_t *ctx, char const *topic, char const *str)
 {
-    if (!ctx->conn || !ctx->conn->proto_handler)
+    if (!ctx->conn || !ctx->conn->proto_handler) {
+        ctx->stats->errors++; // not connected
         return;
+    }
 
-    ctx->message_id++;
-    mg_mqtt_publish(ctx->conn, topic, ctx->message_id, ctx->publish_flags, str, strlen(str));
+    int qos           = MG_MQTT_GET_QOS(ctx->publish_flags);
+    size_t topic_len  = strlen(topic);
+    size_t str_len    = strlen(str);
+    size_t remaining  = 2 + topic_len + (qos > 0 ? 2 : 0) + str_len;
+
+    struct mbuf *buf = &ctx->sendbuf;
+    if (qos == 1 && ctx->window && (ctx->inflight >= ctx->window || ctx->backlog_count)) {
+        if (ctx->backlog.len + remaining + 5 > MQTT_BACKLOG_MAX) {
+            if (!ctx->dropped++)
+                fprintf(stderr, "MQTT publish window full, dropping messages\n");
+            ctx->stats->errors++;
+            return;
+        }
+        buf = &ctx->backlog;
+        ctx->backlog_count++;
+    }
+    else if (qos == 1) {
+        ctx->inflight++;
+    }
+    if (buf == &ctx->sendbuf && ctx->dropped) {
+        fprintf(stderr, "MQTT publish window open again, %u messages dropped\n", ctx->dropped);
+        ctx->dropped = 0;
+    }
+
+    // fixed header with variable length encoding
+    uint8_t hdr[5];
+    size_t hdr_len = 1;
+    hdr[0] = (MG_MQTT_CMD_PUBLISH << 4) | ctx->publish_flags;
+    do {
+        hdr[hdr_len] = remaining % 0x80;
+        remaining /= 0x80;
+        if (remaining > 0)
+            hdr[hdr_len] |= 0x80;
+        hdr_len++;
+    } while (remaining > 0);
+    mbuf_append(buf, hdr, hdr_len);
+
+    uint8_t netbytes[2] = {(uint8_t)(topic_len >> 8), (uint8_t)topic_len};
+    mbuf_append(buf, netbytes, 2);
+    mbuf_append(buf, topic, topic_len);
+
+    if (qos > 0) {
+        if (!++ctx->message_id)
+            ctx->message_id = 1; // zero is not a valid message id
+        netbytes[0] = (uint8_t)(ctx->message_id >> 8);
+        netbytes[1] = (uint8_t)ctx->message_id;
+        mbuf_append(buf, netbytes, 2);
+    }
+
+    mbuf_append(buf, str, str_len);
 }
 
 static void mqtt_client_free(mqtt_client_t *ctx)
@@ -166,108 +283,82 @@ static void mqtt_client_free(mqtt_client_t *ctx)
         ctx->conn->user_data = NULL;
         ctx->conn->flags |= MG_F_CLOSE_IMMEDIATELY;
     }
+    if (ctx) {
+        mbuf_free(&ctx->sendbuf);
+        mbuf_free(&ctx->backlog);
+    }
     free(ctx);
 }
 
-/* Helper */
-
-/// clean the topic inplace to [-.A-Za-z0-9], esp. not whitespace, +, #, /, $
-static char *mqtt_sanitize_topic(char *topic)
-{
-    for (char *p = topic; *p; ++p)
-        if (*p != '-' && *p != '.' && (*p < 'A' || *p > 'Z') && (*p < 'a' || *p > 'z') && (*p < '0' || *p > '9'))
-            *p = '_';
-
-    return topic;
-}
-
-/* MQTT printer */
-
+/* Topic templates */
+
+/// Well-known top level keys usable in topic format strings.
+enum topic_key {
+    TOPIC_KEY_TYPE,
+    TOPIC_KEY_MODEL,
+    TOPIC_KEY_SUBTYPE,
+    TOPIC_KEY_CHANNEL,
+    TOPIC_KEY_ID,
+    TOPIC_KEY_PROTOCOL, // NOTE: needs "-M protocol"
+    TOPIC_KEY_COUNT,
+    TOPIC_KEY_HOSTNAME = TOPIC_KEY_COUNT,
+    TOPIC_KEY_NONE,
+};
+
+static char const *const topic_key_names[] = {
+        "type",
+        "model",
+        "subtype",
+        "channel",
+        "id",
+        "protocol",
+};
+
+/// A compiled topic format string token: literal text, then an optional key expansion.
 typedef struct {
-    struct data_output output;
-    mqtt_client_t *mqc;
-    char topic[256];
-    char hostname[64];
-    char *devices;
-    char *events;
-    char *states;
-    //char *homie;
-    //char *hass;
-} data_output_mqtt_t;
-
-static void R_API_CALLCONV print_mqtt_array(data_output_t *output, data_array_t *array, char const *format)
-{
-    data_output_mqtt_t *mqtt = (data_output_mqtt_t *)output;
-
-    char *orig = mqtt->topic + strlen(mqtt->topic); // save current topic
-
-    for (int c = 0; c < array->num_values; ++c) {
-        sprintf(orig, "/%d", c);
-        print_array_value(output, array, format, c);
-    }
-    *orig = '\0'; // restore topic
-}
-
-static char *append_topic(char *topic, data_t *data)
-{
-    if (data->type == DATA_STRING) {
-        strcpy(topic, data->value.v_ptr);
-        mqtt_sanitize_topic(topic);
-        topic += strlen(data->value.v_ptr);
-    }
-    else if (data->type == DATA_INT) {
-        topic += sprintf(topic, "%d", data->value.v_int);
-    }
-    else {
-        fprintf(stderr, "Can't append data type %d to topic\n", data->type);
-    }
+    char const *literal;
+    int literal_len;
+    int key; ///< enum topic_key
+    char leading_slash;
+    char const *def; ///< default if the key is missing, NULL for none
+    int def_len;
+} topic_token_t;
 
-    return topic;
-}
+typedef struct {
+    int num_tokens;
+    topic_token_t *tokens;
+} topic_template_t;
 
-static char *expand_topic(char *topic, char const *format, data_t *data, char const *hostname)
+/// Compile a topic format string, the tokens point into @p format which must outlive the template.
+static void topic_template_compile(topic_template_t *tmpl, char const *format)
 {
-    // collect well-known top level keys
-    data_t *data_type    = NULL;
-    data_t *data_model   = NULL;
-    data_t *data_subtype = NULL;
-    data_t *data_channel = NULL;
-    data_t *data_id      = NULL;
-    data_t *data_protocol = NULL;
-    for (data_t *d = data; d; d = d->next) {
-        if (!strcmp(d->key, "type"))
-            data_type = d;
-        else if (!strcmp(d->key, "model"))
-            data_model = d;
-        else if (!strcmp(d->key, "subtype"))
-            data_subtype = d;
-        else if (!strcmp(d->key, "channel"))
-            data_channel = d;
-        else if (!strcmp(d->key, "id"))
-            data_id = d;
-        else if (!strcmp(d->key, "protocol")) // NOTE: needs "-M protocol"
-            data_protocol = d;
-    }
+    int num_tokens = 1;
+    for (char const *p = format; *p; ++p)
+        num_tokens += *p == '[';
+    tmpl->tokens = calloc(num_tokens, sizeof(*tmpl->tokens));
+    if (!tmpl->tokens)
+        FATAL_CALLOC("topic_template_compile()");
 
     // consume entire format string
-    while (format && *format) {
-        data_t *data_token  = NULL;
-        char const *string_token = NULL;
-        int leading_slash   = 0;
+    topic_token_t *tok = tmpl->tokens;
+    while (*format) {
         char const *t_start = NULL;
         char const *t_end   = NULL;
-        char const *d_start = NULL;
-        char const *d_end   = NULL;
         // copy until '['
+        tok->literal = format;
         while (*format && *format != '[')
-            *topic++ = *format++;
+            ++format;
+        tok->literal_len = (int)(format - tok->literal);
+        tok->key         = TOPIC_KEY_NONE;
         // skip '['
-        if (!*format)
+        if (!*format) {
+            tok++;
             break;
+        }
         ++format;
         // read slash
-        if (!leading_slash && (*format < 'a' || *format > 'z')) {
-            leading_slash = *format;
+        if (*format < 'a' || *format > 'z') {
+            tok->leading_slash = *format;
             format++;
         }
         // read key until : or ]
@@ -276,9 +367,10 @@ static char *expand_topic(char *topic, char const *format, data_t *data, char co
             t_end = ++format;
         // read default until ]
         if (*format == ':') {
-            d_start = d_end = ++format;
+            tok->def = ++format;
             while (*format && *format != ']' && *format != '[')
-                d_end = ++format;
+                ++format;
+            tok->def_len = (int)(format - tok->def);
         }
         // check for proper closing
         if (*format != ']') {
@@ -288,42 +380,133 @@ static char *expand_topic(char *topic, char const *format, data_t *data, char co
         ++format;
 
         // resolve token
-        if (!strncmp(t_start, "hostname", t_end - t_start))
-            string_token = hostname;
-        else if (!strncmp(t_start, "type", t_end - t_start))
-            data_token = data_type;
-        else if (!strncmp(t_start, "model", t_end - t_start))
-            data_token = data_model;
-        else if (!strncmp(t_start, "subtype", t_end - t_start))
-            data_token = data_subtype;
-        else if (!strncmp(t_start, "channel", t_end - t_start))
-            data_token = data_channel;
-        else if (!strncmp(t_start, "id", t_end - t_start))
-            data_token = data_id;
-        else if (!strncmp(t_start, "protocol", t_end - t_start))
-            data_token = data_protocol;
+        if (!strncmp(t_start, "hostname", t_end - t_start)) {
+            tok->key = TOPIC_KEY_HOSTNAME;
+        }
         else {
+            for (int k = 0; k < TOPIC_KEY_COUNT; ++k) {
+                if (!strncmp(t_start, topic_key_names[k], t_end - t_start)) {
+                    tok->key = k;
+                    break;
+                }
+            }
+        }
+        if (tok->key == TOPIC_KEY_NONE) {
             fprintf(stderr, "%s: unknown token \"%.*s\"\n", __func__, (int)(t_end - t_start), t_start);
             exit(1);
         }
+        tok++;
+    }
+    tmpl->num_tokens = (int)(tok - tmpl->tokens);
+}
+
+static void topic_template_free(topic_template_t *tmpl)
+{
+    free(tmpl->tokens);
+    tmpl->tokens     = NULL;
+    tmpl->num_tokens = 0;
+}
+
+/// Collect the well-known top level keys of @p data, indexed by enum topic_key.
+static void topic_collect_keys(data_t *data, data_t *keys[TOPIC_KEY_COUNT])
+{
+    memset(keys, 0, TOPIC_KEY_COUNT * sizeof(*keys));
+    for (data_t *d = data; d; d = d->next) {
+        for (int k = 0; k < TOPIC_KEY_COUNT; ++k) {
+            if (!keys[k] && !strcmp(d->key, topic_key_names[k])) {
+                keys[k] = d;
+                break;
+            }
+        }
+    }
+}
+
+/// Append a data value to the topic, strings are sanitized to [-.A-Za-z0-9] while copying.
+static char *append_topic(char *topic, char const *end, data_t *data)
+{
+    if (data->type == DATA_STRING) {
+        for (char const *p = data->value.v_ptr; *p && topic < end; ++p)
+            *topic++ = (*p != '-' && *p != '.' && (*p < 'A' || *p > 'Z') && (*p < 'a' || *p > 'z') && (*p < '0' || *p > '9')) ? '_' : *p;
+    }
+    else if (data->type == DATA_INT) {
+        int n = snprintf(topic, end - topic + 1, "%d", data->value.v_int);
+        topic += n < end - topic ? n : end - topic;
+    }
+    else {
+        fprintf(stderr, "Can't append data type %d to topic\n", data->type);
+    }
+
+    return topic;
+}
+
+static char *append_str(char *topic, char const *end, char const *str, int len)
+{
+    while (len-- > 0 && *str && topic < end)
+        *topic++ = *str++;
+    return topic;
+}
+
+/// Expand a compiled topic template into @p topic of @p size bytes, returns the end of the topic.
+static char *expand_topic(char *topic, size_t size, topic_template_t const *tmpl, data_t *const keys[TOPIC_KEY_COUNT], char const *hostname)
+{
+    char const *end = topic + size - 1;
+
+    for (int i = 0; i < tmpl->num_tokens; ++i) {
+        topic_token_t const *tok = &tmpl->tokens[i];
+        topic = append_str(topic, end, tok->literal, tok->literal_len);
+        if (tok->key == TOPIC_KEY_NONE)
+            continue;
+
+        data_t *data_token       = tok->key < TOPIC_KEY_COUNT ? keys[tok->key] : NULL;
+        char const *string_token = tok->key == TOPIC_KEY_HOSTNAME ? hostname : NULL;
 
         // append token or default
-        if (!data_token && !string_token && !d_start)
+        if (!data_token && !string_token && !tok->def)
             continue;
-        if (leading_slash)
-            *topic++ = leading_slash;
+        if (tok->leading_slash && topic < end)
+            *topic++ = tok->leading_slash;
         if (data_token)
-            topic = append_topic(topic, data_token);
+            topic = append_topic(topic, end, data_token);
         else if (string_token)
-            topic += sprintf(topic, "%s", string_token);
+            topic = append_str(topic, end, string_token, (int)strlen(string_token));
         else
-            topic += sprintf(topic, "%.*s", (int)(d_end - d_start), d_start);
+            topic = append_str(topic, end, tok->def, tok->def_len);
     }
 
     *topic = '\0';
     return topic;
 }
 
+/* MQTT printer */
+
+typedef struct {
+    struct data_output output;
+    mqtt_client_t *mqc;
+    char topic[256];
+    char hostname[64];
+    char *devices;
+    char *events;
+    char *states;
+    //char *homie;
+    //char *hass;
+    topic_template_t devices_tmpl;
+    topic_template_t events_tmpl;
+    topic_template_t states_tmpl;
+} data_output_mqtt_t;
+
+static void R_API_CALLCONV print_mqtt_array(data_output_t *output, data_array_t *array, char const *format)
+{
+    data_output_mqtt_t *mqtt = (data_output_mqtt_t *)output;
+
+    char *orig = mqtt->topic + strlen(mqtt->topic); // save current topic
+
+    for (int c = 0; c < array->num_values; ++c) {
+        sprintf(orig, "/%d", c);
+        print_array_value(output, array, format, c);
+    }
+    *orig = '\0'; // restore topic
+}
+
 // <prefix>[/type][/model][/subtype][/channel][/id]/battery: "OK"|"LOW"
 static void R_API_CALLCONV print_mqtt_data(data_output_t *output, data_t *data, char const *format)
 {
@@ -336,14 +519,11 @@ static void R_API_CALLCONV print_mqtt_data(data_output_t *output, data_t *data,
     // top-level only
     if (!*mqtt->topic) {
         // collect well-known top level keys
-        data_t *data_model = NULL;
-        for (data_t *d = data; d; d = d->next) {
-            if (!strcmp(d->key, "model"))
-                data_model = d;
-        }
+        data_t *keys[TOPIC_KEY_COUNT];
+        topic_collect_keys(data, keys);
 
         // "states" topic
-        if (!data_model) {
+        if (!keys[TOPIC_KEY_MODEL]) {
             if (mqtt->states) {
                 size_t message_size = 20000; // state message need a large buffer
                 char *message       = malloc(message_size);
@@ -352,7 +532,7 @@ static void R_API_CALLCONV print_mqtt_data(data_output_t *output, data_t *data,
                     return; // NOTE: skip output on alloc failure.
                 }
                 data_print_jsons(data, message, message_size);
-                expand_topic(mqtt->topic, mqtt->states, data, mqtt->hostname);
+                expand_topic(mqtt->topic, sizeof(mqtt->topic), &mqtt->states_tmpl, keys, mqtt->hostname);
                 mqtt_client_publish(mqtt->mqc, mqtt->topic, message);
                 *mqtt->topic = '\0'; // clear topic
                 free(message);
@@ -364,7 +544,7 @@ static void R_API_CALLCONV print_mqtt_data(data_output_t *output, data_t *data,
         if (mqtt->events) {
             char message[2048]; // we expect the biggest strings to be around 500 bytes.
             data_print_jsons(data, message, sizeof(message));
-            expand_topic(mqtt->topic, mqtt->events, data, mqtt->hostname);
+            expand_topic(mqtt->topic, sizeof(mqtt->topic), &mqtt->events_tmpl, keys, mqtt->hostname);
             mqtt_client_publish(mqtt->mqc, mqtt->topic, message);
             *mqtt->topic = '\0'; // clear topic
         }
@@ -374,7 +554,7 @@ static void R_API_CALLCONV print_mqtt_data(data_output_t *output, data_t *data,
             return;
         }
 
-        end = expand_topic(mqtt->topic, mqtt->devices, data, mqtt->hostname);
+        end = expand_topic(mqtt->topic, sizeof(mqtt->topic), &mqtt->devices_tmpl, keys, mqtt->hostname);
     }
 
     while (data) {
@@ -428,6 +608,12 @@ static void R_API_CALLCONV print_mqtt_int(data_output_t *output, int data, char
     print_mqtt_string(output, str, format);
 }
 
+static void R_API_CALLCONV data_output_mqtt_flush(data_output_t *output)
+{
+    data_output_mqtt_t *mqtt = (data_output_mqtt_t *)output;
+    mqtt_client_flush(mqtt->mqc); // one send for all messages of the event
+}
+
 static void R_API_CALLCONV data_output_mqtt_free(data_output_t *output)
 {
     data_output_mqtt_t *mqtt = (data_output_mqtt_t *)output;
@@ -435,6 +621,9 @@ static void R_API_CALLCONV data_output_mqtt_free(data_output_t *output)
     if (!mqtt)
         return;
 
+    topic_template_free(&mqtt->devices_tmpl);
+    topic_template_free(&mqtt->events_tmpl);
+    topic_template_free(&mqtt->states_tmpl);
     free(mqtt->devices);
     free(mqtt->events);
     free(mqtt->states);
@@ -500,6 +689,7 @@ struct data_output *data_output_mqtt_create(struct mg_mgr *mgr, char *param, cha
     char *pass = NULL;
     int retain = 0;
     int qos = 0;
+    unsigned window = MQTT_WINDOW_DEFAULT;
 
     // parse host and port
     tls_opts_t tls_opts = {0};
@@ -527,6 +717,8 @@ struct data_output *data_output_mqtt_create(struct mg_mgr *mgr, char *param, cha
             retain = atobv(val, 1);
         else if (!strcasecmp(key, "q") || !strcasecmp(key, "qos"))
             qos = atoiv(val, 1);
+        else if (!strcasecmp(key, "w") || !strcasecmp(key, "window"))
+            window = atouint32_metric(val, "window= ");
         // Simple key-topic mapping
         else if (!strcasecmp(key, "d") || !strcasecmp(key, "devices"))
             mqtt->devices = mqtt_topic_default(val, base_topic, path_devices);
@@ -566,21 +758,29 @@ struct data_output *data_output_mqtt_create(struct mg_mgr *mgr, char *param, cha
         mqtt->events  = mqtt_topic_default(NULL, base_topic, path_events);
         mqtt->states  = mqtt_topic_default(NULL, base_topic, path_states);
     }
-    if (mqtt->devices)
+    if (mqtt->devices) {
         fprintf(stderr, "Publishing device info to MQTT topic \"%s\".\n", mqtt->devices);
-    if (mqtt->events)
+        topic_template_compile(&mqtt->devices_tmpl, mqtt->devices);
+    }
+    if (mqtt->events) {
         fprintf(stderr, "Publishing events info to MQTT topic \"%s\".\n", mqtt->events);
-    if (mqtt->states)
+        topic_template_compile(&mqtt->events_tmpl, mqtt->events);
+    }
+    if (mqtt->states) {
         fprintf(stderr, "Publishing states info to MQTT topic \"%s\".\n", mqtt->states);
+        topic_template_compile(&mqtt->states_tmpl, mqtt->states);
+    }
 
     mqtt->output.print_data   = print_mqtt_data;
     mqtt->output.print_array  = print_mqtt_array;
     mqtt->output.print_string = print_mqtt_string;
     mqtt->output.print_double = print_mqtt_double;
     mqtt->output.print_int    = print_mqtt_int;
+    mqtt->output.output_flush = data_output_mqtt_flush;
     mqtt->output.output_free  = data_output_mqtt_free;
 
-    mqtt->mqc = mqtt_client_init(mgr, &tls_opts, host, port, user, pass, client_id, retain, qos);
+    mqtt->mqc = mqtt_client_init(mgr, &tls_opts, host, port, user, pass, client_id, retain, qos, qos == 1 ? window : 0);
+    mqtt->mqc->stats = &mqtt->output.stats;
 
     return &mqtt->output;
 }
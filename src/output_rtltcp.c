@@ -14,6 +14,8 @@
 #include "rtl_433.h"
 #include "r_api.h"
 #include "r_util.h"
+#include "optparse.h"
+#include "ring_buf.h"
 #include "fatal.h"
 #include "compat_pthread.h"
 
@@ -22,6 +24,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <signal.h>
+#include <errno.h>
 
 #include <limits.h>
 // gethostname() needs _XOPEN_SOURCE 500 on unistd.h
@@ -45,6 +48,7 @@
     #include <sys/types.h>
     #include <sys/socket.h>
     #include <sys/select.h>
+    #include <fcntl.h>
     #include <netdb.h>
     #include <netinet/in.h>
 
@@ -85,26 +89,36 @@ typedef SSIZE_T ssize_t;
 /* rtl_tcp server */
 
 // Only available if Threads are enabled.
-// Currently serves a maximum of 1 client connection.
-// The data backing from the SDR is assumed to be persistent, which is the case
-// since we never restart the SDR with different parameters or close it while active.
-// Should use shared memory for sendfile() someday.
+// Serves a number of concurrent clients from a single thread.
+// The samples are read from the shared sample ring, each client with its own position,
+// sends are non-blocking so a slow client never holds up the others or the SDR.
+// New data in the ring is picked up by polling, there is no portable way to wake select().
 
 #ifdef THREADS
 
+#define RTLTCP_MAX_CLIENTS 8
+#define RTLTCP_POLL_US     10000 // 10 ms
+
+typedef struct rtltcp_client {
+    SOCKET sock;       ///< INVALID_SOCKET if the slot is free
+    uint64_t sent_pos; ///< data sent up to this ring position
+    unsigned drops;    ///< number of times the client fell behind
+    char host[INET6_ADDRSTRLEN];
+    char port[NI_MAXSERV];
+} rtltcp_client_t;
+
 typedef struct rtltcp_server {
     struct sockaddr_storage addr;
     socklen_t addr_len;
     SOCKET sock;
     int client_count; ///< number of connected clients
+    int max_clients;
+    int lag_disconnect; ///< disconnect instead of dropping data for clients that fall behind
+    rtltcp_client_t clients[RTLTCP_MAX_CLIENTS];
 
-    uint8_t const *data_buf; ///< data buffer with most recent data, NULL otherwise
-    uint32_t data_len;       ///< data buffer length in bytes, 0 otherwise
-    unsigned data_cnt;       ///< data buffer update counter
+    ring_buf_t *ring; ///< the shared sample ring
 
     pthread_t thread;
-    pthread_mutex_t lock; ///< lock for data buffer
-    pthread_cond_t cond;  ///< wait for data buffer
     r_cfg_t *cfg;
     struct raw_output *output;
 } rtltcp_server_t;
@@ -221,133 +235,198 @@ static int parse_command(r_cfg_t *cfg, uint8_t const *buf, int len)
     return 5;
 }
 
-// event handler to broadcast to all our sockets
-static void rtltcp_broadcast_send(rtltcp_server_t *srv, uint8_t const *data, uint32_t len)
+static int set_nonblocking(SOCKET sock)
 {
-    // fprintf(stderr, "%s: %d byte frame\n", __func__, len);
-    pthread_mutex_lock(&srv->lock);
-
-    // update the data buffer reference
-    srv->data_buf = data;
-    srv->data_len = len;
-    srv->data_cnt += 1;
-
-    pthread_mutex_unlock(&srv->lock);
-    pthread_cond_signal(&srv->cond);
-    // perhaps broadcast if we want to support multiple clients
-    //int pthread_cond_broadcast(&srv->cond);
+#ifdef _WIN32
+    u_long mode = 1;
+    return ioctlsocket(sock, FIONBIO, &mode);
+#else
+    int flags = fcntl(sock, F_GETFL, 0);
+    return flags < 0 ? -1 : fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+#endif
 }
 
-static THREAD_RETURN THREAD_CALL accept_thread(void *arg)
+static int would_block(void)
 {
-    rtltcp_server_t *srv = arg;
-
-    // Start listening for clients, waits for an incoming connection
-    listen(srv->sock, 1);
-    //fprintf(stderr, "rtl_tcp listening...\n");
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
 
-    for (;;) {
-        // Accept actual connection from the client
-        struct sockaddr_storage addr = {0};
-        unsigned addr_len = sizeof(addr);
-        int sock = accept(srv->sock, (struct sockaddr *)&addr, &addr_len);
+static void client_close(rtltcp_server_t *srv, rtltcp_client_t *client)
+{
+    fprintf(stderr, "rtl_tcp client disconnected from %s port %s\n", client->host, client->port);
+    closesocket(client->sock);
+    client->sock = INVALID_SOCKET;
+    srv->client_count -= 1;
+}
 
-        if (sock < 0) {
-            perror("ERROR on accept");
-            continue;
-        }
+static void client_accept(rtltcp_server_t *srv)
+{
+    // Accept actual connection from the client
+    struct sockaddr_storage addr = {0};
+    socklen_t addr_len = sizeof(addr);
+    SOCKET sock = accept(srv->sock, (struct sockaddr *)&addr, &addr_len);
+    if (sock == INVALID_SOCKET) {
+        perror("ERROR on accept");
+        return;
+    }
 
-        // Prevent SIGPIPE per file descriptor, supported on MacOS and most BSDs
+    // Prevent SIGPIPE per file descriptor, supported on MacOS and most BSDs
 #ifdef SO_NOSIGPIPE
-        int opt = 1;
-        if (setsockopt(sock, SOL_SOCKET, SO_NOSIGPIPE, &opt, sizeof(opt)) == -1) {
-            perror("setsockopt");
-            continue;
-        }
+    int opt = 1;
+    if (setsockopt(sock, SOL_SOCKET, SO_NOSIGPIPE, &opt, sizeof(opt)) == -1) {
+        perror("setsockopt");
+        closesocket(sock);
+        return;
+    }
 #endif
 
-        char host[INET6_ADDRSTRLEN] = {0};
-        char port[NI_MAXSERV]       = {0};
+    char host[INET6_ADDRSTRLEN] = {0};
+    char port[NI_MAXSERV]       = {0};
+    int err = getnameinfo((struct sockaddr *)&addr, addr_len,
+            host, sizeof(host), port, sizeof(port), NI_NUMERICHOST | NI_NUMERICSERV);
+    if (err != 0) {
+        fprintf(stderr, "failed to convert address to string (code=%d)\n", err);
+        closesocket(sock);
+        return;
+    }
 
-        int err = getnameinfo((struct sockaddr *)&addr, addr_len,
-                host, sizeof(host), port, sizeof(port), NI_NUMERICHOST | NI_NUMERICSERV);
-        if (err != 0) {
-            fprintf(stderr, "failed to convert address to string (code=%d)\n", err);
-            continue;
+    rtltcp_client_t *client = NULL;
+    for (int i = 0; i < srv->max_clients; ++i) {
+        if (srv->clients[i].sock == INVALID_SOCKET) {
+            client = &srv->clients[i];
+            break;
+        }
+    }
+    if (!client) {
+        fprintf(stderr, "rtl_tcp too many clients, refusing %s port %s\n", host, port);
+        closesocket(sock);
+        return;
+    }
+
+    send_header(sock); // always fits the fresh send buffer
+    if (set_nonblocking(sock) != 0) {
+        perror("rtl_tcp non-blocking");
+        closesocket(sock);
+        return;
+    }
+
+    client->sock     = sock;
+    client->sent_pos = ring_buf_head(srv->ring);
+    client->drops    = 0;
+    snprintf(client->host, sizeof(client->host), "%s", host);
+    snprintf(client->port, sizeof(client->port), "%s", port);
+    srv->client_count += 1;
+    fprintf(stderr, "rtl_tcp client connected from %s port %s (%d clients)\n", host, port, srv->client_count);
+}
+
+/// Read available commands, returns -1 if the client closed the connection.
+static int client_recv(rtltcp_server_t *srv, rtltcp_client_t *client)
+{
+    uint8_t buf[128] = {0};
+    ssize_t len = recv(client->sock, (char *)buf, sizeof(buf), 0);
+    //fprintf(stderr, "rtl_tcp recv %zd bytes\n", len);
+    if (len < 0 && would_block())
+        return 0;
+    if (len <= 0)
+        return -1;
+    int pos = 0;
+    while (pos + 5 <= len) {
+        pos += parse_command(srv->cfg, &buf[pos], (int)len - pos);
+    }
+    return 0;
+}
+
+/// Apply the lag policy, returns -1 if the client should be closed.
+static int client_check_lag(rtltcp_server_t *srv, rtltcp_client_t *client, uint64_t head)
+{
+    // Falling more than half the ring behind risks sending data the SDR overwrites
+    uint64_t lag = head - client->sent_pos;
+    if (lag <= srv->ring->size / 2)
+        return 0;
+
+    client->drops += 1;
+    if (srv->lag_disconnect) {
+        fprintf(stderr, "rtl_tcp client %s port %s too slow, disconnecting\n", client->host, client->port);
+        return -1;
+    }
+    // skip to the newest data, keep the alignment to whole samples
+    uint64_t skip = lag & ~(uint64_t)3;
+    fprintf(stderr, "rtl_tcp client %s port %s too slow, dropped %llu bytes (%u times)\n",
+            client->host, client->port, (unsigned long long)skip, client->drops);
+    client->sent_pos += skip;
+    return 0;
+}
+
+/// Send as much pending data as the socket takes, returns -1 if the client should be closed.
+static int client_send(rtltcp_server_t *srv, rtltcp_client_t *client, uint64_t head)
+{
+    uint64_t len = head - client->sent_pos;
+    if (!len)
+        return 0;
+
+    // The data is contiguous in the ring, send it from there
+    ssize_t ret = send(client->sock, (char const *)ring_buf_at(srv->ring, client->sent_pos), (size_t)len, MSG_NOSIGNAL); // ignore SIGPIPE
+    if (ret < 0)
+        return would_block() ? 0 : -1;
+    client->sent_pos += (uint64_t)ret;
+    return 0;
+}
+
+static THREAD_RETURN THREAD_CALL server_thread(void *arg)
+{
+    rtltcp_server_t *srv = arg;
+
+    // Start listening for clients
+    listen(srv->sock, srv->max_clients);
+    //fprintf(stderr, "rtl_tcp listening...\n");
+
+    for (;;) {
+        fd_set rfds, wfds;
+        FD_ZERO(&rfds);
+        FD_ZERO(&wfds);
+        FD_SET(srv->sock, &rfds);
+        SOCKET max_fd = srv->sock;
+
+        // Wait for commands from all clients, and writable sockets for clients with pending data
+        uint64_t head = ring_buf_head(srv->ring);
+        for (int i = 0; i < srv->max_clients; ++i) {
+            rtltcp_client_t *client = &srv->clients[i];
+            if (client->sock == INVALID_SOCKET)
+                continue;
+            FD_SET(client->sock, &rfds);
+            if (client->sent_pos != head)
+                FD_SET(client->sock, &wfds);
+            if (client->sock > max_fd)
+                max_fd = client->sock;
         }
-        fprintf(stderr, "rtl_tcp client connected from %s port %s\n", host, port);
-
-        pthread_mutex_lock(&srv->lock);
-        srv->client_count += 1;
-        unsigned prev_cnt = srv->data_cnt + 9; // data sent in previous loop, random value to get the current buffer
-        pthread_mutex_unlock(&srv->lock);
-
-        send_header(sock);
-
-        // Client loop
-        for (;;) {
-            // Read available commands
-            int abort = 0;
-            for (;;) {
-                fd_set fds;
-                FD_ZERO(&fds);
-                FD_SET(sock, &fds);
-                struct timeval timeout = {0};
-
-                int ready = select(sock + 1, &fds, NULL, NULL, &timeout);
-                if (ready <= 0)
-                    break;
-
-                uint8_t buf[128] = {0};
-                ssize_t len = recv(sock, buf, sizeof(buf), 0);
-                //fprintf(stderr, "rtl_tcp recv %zd bytes (%d)\n", len, ready);
-                if (len <= 0) {
-                    abort = 1;
-                    break;
-                }
-                int pos = 0;
-                while (pos + 5 <= len) {
-                    pos += parse_command(srv->cfg, &buf[pos], (int)len - pos);
-                }
-            }
-            if (abort) {
-                break;
-            }
-
-            // Send frames
-            fd_set fds;
-            FD_ZERO(&fds);
-            FD_SET(sock, &fds);
-            struct timeval timeout = {0};
-
-            int ready = select(sock + 1, NULL, &fds, NULL, &timeout);
-            if (ready <= 0) {
-                fprintf(stderr, "rtl_tcp send not ready for write?\n");
-                break;
-            }
-
-            pthread_mutex_lock(&srv->lock);
-            while (srv->data_cnt == prev_cnt || srv->data_buf == NULL)
-                pthread_cond_wait(&srv->cond, &srv->lock);
-            // Maybe timeout to check recv()
-            // pthread_cond_timedwait(&srv->cond, &srv->lock, const struct timespec *abstime);
-
-            // Get data buffer reference
-            void const *data = srv->data_buf;
-            int data_len     = srv->data_len;
-            prev_cnt         = srv->data_cnt;
-
-            pthread_mutex_unlock(&srv->lock);
-
-            send_all(sock, data, data_len, MSG_NOSIGNAL); // ignore SIGPIPE
+
+        struct timeval timeout = {0, RTLTCP_POLL_US};
+        int ready = select((int)max_fd + 1, &rfds, &wfds, NULL, &timeout);
+        if (ready < 0 && !would_block()) {
+            perror("rtl_tcp select");
+        }
+        if (ready < 0) {
+            FD_ZERO(&rfds);
+            FD_ZERO(&wfds);
         }
 
-        pthread_mutex_lock(&srv->lock);
-        srv->client_count -= 1;
-        pthread_mutex_unlock(&srv->lock);
+        // Clients that stalled are checked even if their socket is not writable
+        for (int i = 0; i < srv->max_clients; ++i) {
+            rtltcp_client_t *client = &srv->clients[i];
+            if (client->sock == INVALID_SOCKET)
+                continue;
+            if ((FD_ISSET(client->sock, &rfds) && client_recv(srv, client) != 0)
+                    || client_check_lag(srv, client, head) != 0
+                    || (FD_ISSET(client->sock, &wfds) && client_send(srv, client, head) != 0))
+                client_close(srv, client);
+        }
 
-        fprintf(stderr, "rtl_tcp client disconnected from %s port %s\n", host, port);
-        closesocket(sock);
+        if (FD_ISSET(srv->sock, &rfds))
+            client_accept(srv);
     }
     return 0;
 }
@@ -394,6 +473,9 @@ static int rtltcp_server_start(rtltcp_server_t *srv, char const *host, char cons
 
     srv->cfg     = cfg;
     srv->output  = output;
+    srv->ring    = get_sample_ring(cfg);
+    for (int i = 0; i < RTLTCP_MAX_CLIENTS; ++i)
+        srv->clients[i].sock = INVALID_SOCKET;
 
     char address[INET6_ADDRSTRLEN] = {0};
     char portstr[NI_MAXSERV] = {0};
@@ -406,9 +488,6 @@ static int rtltcp_server_start(rtltcp_server_t *srv, char const *host, char cons
     }
     fprintf(stderr, "Starting rtl_tcp server on address %s %s\n", address, portstr);
 
-    pthread_mutex_init(&srv->lock, NULL);
-    pthread_cond_init(&srv->cond, NULL);
-
 #ifndef _WIN32
     // Block all signals from the worker thread
     sigset_t sigset;
@@ -416,7 +495,7 @@ static int rtltcp_server_start(rtltcp_server_t *srv, char const *host, char cons
     sigfillset(&sigset);
     pthread_sigmask(SIG_SETMASK, &sigset, &oldset);
 #endif
-    int r = pthread_create(&srv->thread, NULL, accept_thread, srv);
+    int r = pthread_create(&srv->thread, NULL, server_thread, srv);
 #ifndef _WIN32
     pthread_sigmask(SIG_SETMASK, &oldset, NULL);
 #endif
@@ -433,14 +512,20 @@ static int rtltcp_server_stop(rtltcp_server_t *srv)
         return 0;
 
     fprintf(stderr, "Stopping rtl_tcp server...\n");
-    // thread is likely blocking in accept, recv, or send
+    // thread is likely waiting in select
     int r = pthread_cancel(srv->thread);
     if (r) {
         fprintf(stderr, "%s: error in pthread_cancel, rc: %d\n", __func__, r);
     }
-    pthread_mutex_destroy(&srv->lock);
-    pthread_cond_destroy(&srv->cond);
+    pthread_join(srv->thread, NULL);
 
+    // close client sockets
+    for (int i = 0; i < srv->max_clients; ++i) {
+        if (srv->clients[i].sock != INVALID_SOCKET) {
+            closesocket(srv->clients[i].sock);
+            srv->clients[i].sock = INVALID_SOCKET;
+        }
+    }
     srv->client_count = 0;
 
     // close server socket
@@ -466,9 +551,10 @@ typedef struct raw_output_rtltcp {
 
 static void raw_output_rtltcp_frame(raw_output_t *output, uint8_t const *data, uint32_t len)
 {
-    raw_output_rtltcp_t *rtltcp = (raw_output_rtltcp_t *)output;
-
-    rtltcp_broadcast_send(&rtltcp->server, data, len);
+    // nothing to do, the data is already in the ring and the server thread polls for it
+    UNUSED(output);
+    UNUSED(data);
+    UNUSED(len);
 }
 
 static void raw_output_rtltcp_free(raw_output_t *output)
@@ -483,8 +569,32 @@ static void raw_output_rtltcp_free(raw_output_t *output)
     free(rtltcp);
 }
 
-struct raw_output *raw_output_rtltcp_create(const char *host, const char *port, r_cfg_t *cfg)
+struct raw_output *raw_output_rtltcp_create(const char *host, const char *port, char *opts, r_cfg_t *cfg)
 {
+    int max_clients    = RTLTCP_MAX_CLIENTS;
+    int lag_disconnect = 0;
+    char *key, *val;
+    while (getkwargs(&opts, &key, &val)) {
+        key = remove_ws(key);
+        val = trim_ws(val);
+        if (!key || !*key)
+            continue;
+        else if (!strcasecmp(key, "clients"))
+            max_clients = atoiv(val, RTLTCP_MAX_CLIENTS);
+        else if (!strcasecmp(key, "lag") && val && !strcasecmp(val, "drop"))
+            lag_disconnect = 0;
+        else if (!strcasecmp(key, "lag") && val && !strcasecmp(val, "disconnect"))
+            lag_disconnect = 1;
+        else {
+            fprintf(stderr, "Invalid key \"%s\" option.\n", key);
+            exit(1);
+        }
+    }
+    if (max_clients < 1 || max_clients > RTLTCP_MAX_CLIENTS) {
+        fprintf(stderr, "rtl_tcp clients must be 1 to %d.\n", RTLTCP_MAX_CLIENTS);
+        exit(1);
+    }
+
     raw_output_rtltcp_t *rtltcp = calloc(1, sizeof(raw_output_rtltcp_t));
     if (!rtltcp) {
         WARN_CALLOC("raw_output_rtltcp_create()");
@@ -493,6 +603,8 @@ struct raw_output *raw_output_rtltcp_create(const char *host, const char *port,
 
     rtltcp->output.output_frame  = raw_output_rtltcp_frame;
     rtltcp->output.output_free   = raw_output_rtltcp_free;
+    rtltcp->server.max_clients    = max_clients;
+    rtltcp->server.lag_disconnect = lag_disconnect;
 
     int ret = rtltcp_server_start(&rtltcp->server, host, port, cfg, &rtltcp->output);
     if (ret != 0) {
@@ -504,10 +616,11 @@ struct raw_output *raw_output_rtltcp_create(const char *host, const char *port,
 
 #else
 
-struct raw_output *raw_output_rtltcp_create(const char *host, const char *port, r_cfg_t *cfg)
+struct raw_output *raw_output_rtltcp_create(const char *host, const char *port, char *opts, r_cfg_t *cfg)
 {
     UNUSED(host);
     UNUSED(port);
+    UNUSED(opts);
     UNUSED(cfg);
     fprintf(stderr, "\nWARNING: rtl_tcp not available in this build!\n\n");
     return NULL;
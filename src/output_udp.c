@@ -9,10 +9,16 @@
     (at your option) any later version.
 */
 
+// sendmmsg() needs _GNU_SOURCE on sys/socket.h
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #include "output_udp.h"
 
 #include "data.h"
 #include "abuf.h"
+#include "optparse.h"
 #include "r_util.h"
 #include "fatal.h"
 
@@ -50,6 +56,9 @@
 #endif
 
 #include <time.h>
+#include <errno.h>
+
+#include "mongoose.h"
 
 #ifdef _WIN32
     #define _POSIX_HOST_NAME_MAX  128
@@ -74,6 +83,7 @@ typedef struct {
     struct sockaddr_storage addr;
     socklen_t addr_len;
     SOCKET sock;
+    data_output_stats_t *stats; ///< bytes sent and send errors are counted here
 } datagram_client_t;
 
 static int datagram_client_open(datagram_client_t *client, const char *host, const char *port)
@@ -137,7 +147,103 @@ static void datagram_client_send(datagram_client_t *client, const char *message,
     int r =  sendto(client->sock, message, message_len, 0, (struct sockaddr *)&client->addr, client->addr_len);
     if (r == -1) {
         perror("sendto");
+        client->stats->errors++;
+    }
+    else {
+        client->stats->bytes += (unsigned long)r;
+    }
+}
+
+/* Datagram queue, flushed with a single sendmmsg() where available */
+
+#define DATAGRAM_MAX   1472 // fits an Ethernet MTU with IPv4 and UDP headers
+#define DATAGRAM_BATCH_MAX 64
+
+typedef struct {
+    char *buf; ///< DATAGRAM_MAX bytes for each datagram
+    size_t len[DATAGRAM_BATCH_MAX];
+    unsigned count; ///< datagrams queued, the last one might still take lines
+    unsigned batch; ///< flush when this many datagrams are queued
+    int lines;      ///< pack newline separated messages into each datagram
+    int no_sendmmsg;
+} datagram_queue_t;
+
+static void datagram_queue_flush(datagram_queue_t *queue, datagram_client_t *client)
+{
+    unsigned count = queue->count;
+    if (count && !queue->len[count - 1])
+        count--; // skip an empty last datagram
+    queue->count = 0;
+    if (!count)
+        return;
+
+#if defined(__linux__)
+    if (!queue->no_sendmmsg) {
+        struct mmsghdr msgs[DATAGRAM_BATCH_MAX];
+        struct iovec iovs[DATAGRAM_BATCH_MAX];
+        memset(msgs, 0, sizeof(msgs[0]) * count);
+        for (unsigned i = 0; i < count; ++i) {
+            iovs[i].iov_base               = queue->buf + i * DATAGRAM_MAX;
+            iovs[i].iov_len                = queue->len[i];
+            msgs[i].msg_hdr.msg_name       = &client->addr;
+            msgs[i].msg_hdr.msg_namelen    = client->addr_len;
+            msgs[i].msg_hdr.msg_iov        = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen     = 1;
+        }
+        unsigned sent = 0;
+        while (sent < count) {
+            int r = sendmmsg(client->sock, msgs + sent, count - sent, 0);
+            if (r == -1 && errno == ENOSYS) {
+                queue->no_sendmmsg = 1; // fall back to sendto()
+                break;
+            }
+            if (r <= 0) {
+                perror("sendmmsg");
+                client->stats->errors += count - sent;
+                return;
+            }
+            for (int i = 0; i < r; ++i)
+                client->stats->bytes += msgs[sent + i].msg_len;
+            sent += r;
+        }
+        if (sent == count)
+            return;
+        for (unsigned i = sent; i < count; ++i)
+            datagram_client_send(client, queue->buf + i * DATAGRAM_MAX, queue->len[i]);
+        return;
+    }
+#endif
+    for (unsigned i = 0; i < count; ++i)
+        datagram_client_send(client, queue->buf + i * DATAGRAM_MAX, queue->len[i]);
+}
+
+/// Queue a message, returns nonzero if the queue should be flushed.
+static int datagram_queue_push(datagram_queue_t *queue, datagram_client_t *client, const char *message, size_t message_len)
+{
+    if (message_len > DATAGRAM_MAX)
+        return 0; // we don't want to send more than fits the MTU
+
+    // append to the last datagram if there is room
+    if (queue->lines && queue->count) {
+        size_t *len = &queue->len[queue->count - 1];
+        if (*len + 1 + message_len <= DATAGRAM_MAX) {
+            char *dst = queue->buf + (queue->count - 1) * DATAGRAM_MAX;
+            if (*len)
+                dst[(*len)++] = '\n';
+            memcpy(dst + *len, message, message_len);
+            *len += message_len;
+            return 0;
+        }
     }
+
+    if (queue->count >= queue->batch)
+        datagram_queue_flush(queue, client);
+
+    memcpy(queue->buf + queue->count * DATAGRAM_MAX, message, message_len);
+    queue->len[queue->count++] = message_len;
+
+    // with lines the last datagram is kept open until the next one is needed
+    return !queue->lines && queue->count >= queue->batch;
 }
 
 /* Syslog UDP printer, RFC 5424 (IETF-syslog protocol) */
@@ -145,10 +251,23 @@ static void datagram_client_send(datagram_client_t *client, const char *message,
 typedef struct {
     struct data_output output;
     datagram_client_t client;
+    datagram_queue_t queue;
+    struct mg_connection *timer; ///< timer only connection to flush the queue
+    double latency;              ///< seconds a message may wait in the queue
+    double deadline;             ///< time the oldest queued message is due
     int pri;
     char hostname[_POSIX_HOST_NAME_MAX + 1];
 } data_output_syslog_t;
 
+static void syslog_timer_event(struct mg_connection *nc, int ev, void *ev_data)
+{
+    UNUSED(ev_data);
+    // note that while shutting down the user_data is NULL
+    data_output_syslog_t *syslog = (data_output_syslog_t *)nc->user_data;
+    if (ev == MG_EV_TIMER && syslog)
+        datagram_queue_flush(&syslog->queue, &syslog->client);
+}
+
 static void R_API_CALLCONV print_syslog_data(data_output_t *output, data_t *data, char const *format)
 {
     UNUSED(format);
@@ -178,7 +297,21 @@ static void R_API_CALLCONV print_syslog_data(data_output_t *output, data_t *data
         return; // abort on overflow, we don't actually want to send more than fits the MTU
 
     size_t abuf_len = msg.tail - msg.head;
-    datagram_client_send(&syslog->client, message, abuf_len);
+    if (!syslog->queue.buf) {
+        datagram_client_send(&syslog->client, message, abuf_len);
+        return;
+    }
+    int was_empty = !syslog->queue.count;
+    double now_s  = mg_time();
+    if (datagram_queue_push(&syslog->queue, &syslog->client, message, abuf_len)
+            || (!was_empty && now_s >= syslog->deadline)) {
+        datagram_queue_flush(&syslog->queue, &syslog->client); // full or overdue, e.g. if the timer is not polled
+    }
+    else if (was_empty) {
+        syslog->deadline = now_s + syslog->latency;
+        if (syslog->timer)
+            mg_set_timer(syslog->timer, syslog->deadline);
+    }
 }
 
 static void R_API_CALLCONV data_output_syslog_free(data_output_t *output)
@@ -188,12 +321,21 @@ static void R_API_CALLCONV data_output_syslog_free(data_output_t *output)
     if (!syslog)
         return;
 
+    if (syslog->queue.buf) {
+        datagram_queue_flush(&syslog->queue, &syslog->client);
+        free(syslog->queue.buf);
+    }
+    if (syslog->timer) {
+        syslog->timer->user_data = NULL;
+        syslog->timer->flags |= MG_F_CLOSE_IMMEDIATELY;
+    }
+
     datagram_client_close(&syslog->client);
 
     free(syslog);
 }
 
-struct data_output *data_output_syslog_create(const char *host, const char *port)
+struct data_output *data_output_syslog_create(struct mg_mgr *mgr, const char *host, const char *port, char *opts)
 {
     data_output_syslog_t *syslog = calloc(1, sizeof(data_output_syslog_t));
     if (!syslog) {
@@ -227,7 +369,51 @@ struct data_output *data_output_syslog_create(const char *host, const char *port
     gethostname(syslog->hostname, _POSIX_HOST_NAME_MAX + 1);
     #endif
     syslog->hostname[_POSIX_HOST_NAME_MAX] = '\0';
+    syslog->client.stats = &syslog->output.stats;
     datagram_client_open(&syslog->client, host, port);
 
+    // parse batching options
+    unsigned batch = 1;
+    int latency    = -1;
+    int lines      = 0;
+    char *key, *val;
+    while (getkwargs(&opts, &key, &val)) {
+        key = remove_ws(key);
+        val = trim_ws(val);
+        if (!key || !*key)
+            continue;
+        else if (!strcasecmp(key, "b") || !strcasecmp(key, "batch"))
+            batch = atoiv(val, DATAGRAM_BATCH_MAX);
+        else if (!strcasecmp(key, "l") || !strcasecmp(key, "latency"))
+            latency = atoiv(val, 100);
+        else if (!strcasecmp(key, "lines"))
+            lines = atobv(val, 1);
+        else {
+            fprintf(stderr, "Invalid key \"%s\" option.\n", key);
+            exit(1);
+        }
+    }
+    if (batch < 1 || batch > DATAGRAM_BATCH_MAX) {
+        fprintf(stderr, "Syslog batch must be 1 to %d datagrams.\n", DATAGRAM_BATCH_MAX);
+        exit(1);
+    }
+    if (latency < 0)
+        latency = batch > 1 || lines ? 100 : 0;
+
+    if (batch > 1 || lines) {
+        syslog->queue.buf = malloc(batch * DATAGRAM_MAX);
+        if (!syslog->queue.buf)
+            FATAL_MALLOC("data_output_syslog_create()");
+        syslog->queue.batch = batch;
+        syslog->queue.lines = lines;
+        syslog->latency     = latency / 1000.0;
+        if (mgr) {
+            struct mg_add_sock_opts sock_opts = {0};
+            sock_opts.user_data = syslog;
+            syslog->timer = mg_add_sock_opt(mgr, INVALID_SOCKET, syslog_timer_event, sock_opts);
+        }
+        fprintf(stderr, "Syslog batches of %u datagrams%s or %d ms\n", batch, lines ? " of newline separated messages" : "", latency);
+    }
+
     return &syslog->output;
 }
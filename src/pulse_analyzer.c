@@ -214,6 +214,7 @@ void pulse_analyzer(pulse_data_t *data, int package_type)
     // Generate pulse period data
     int pulse_total_period = 0;
     pulse_data_t pulse_periods = {0};
+    pulse_data_reserve(&pulse_periods, data->num_pulses);
     pulse_periods.num_pulses = data->num_pulses;
     for (unsigned n = 0; n < pulse_periods.num_pulses; ++n) {
         pulse_periods.pulse[n] = data->pulse[n] + data->gap[n];
@@ -230,6 +231,7 @@ void pulse_analyzer(pulse_data_t *data, int package_type)
     histogram_sum(&hist_pulses, data->pulse, data->num_pulses, TOLERANCE);
     histogram_sum(&hist_gaps, data->gap, data->num_pulses - 1, TOLERANCE);                      // Leave out last gap (end)
     histogram_sum(&hist_periods, pulse_periods.pulse, pulse_periods.num_pulses - 1, TOLERANCE); // Leave out last gap (end)
+    pulse_data_free(&pulse_periods);
     histogram_sum(&hist_timings, data->pulse, data->num_pulses, TOLERANCE);
     histogram_sum(&hist_timings, data->gap, data->num_pulses, TOLERANCE);
 
@@ -0,0 +1,306 @@
+/** @file
+    Binary pulse data files, a compact and fast to load alternative to the OOK text format.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "pulse_bin.h"
+#include "le_util.h"
+#include "fatal.h"
+
+#define FILE_HEADER_SIZE   16
+#define RECORD_HEADER_SIZE 72
+#define VARINT_MAX         5 // bytes for a 32 bit value
+#define RECORD_SIZE(n)     (RECORD_HEADER_SIZE + (size_t)(n) * 2 * VARINT_MAX) // largest record for n pulses
+
+static char const file_magic[8]   = {'R', 'T', 'L', '4', '3', '3', 'P', 'B'};
+static char const record_magic[4] = {'P', 'U', 'L', 'S'};
+
+/// Encode an unsigned LEB128 varint, returns the number of bytes.
+static unsigned put_varint(uint8_t *p, uint32_t v)
+{
+    unsigned n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+/// Decode an unsigned LEB128 varint, returns the number of bytes or 0 if it's truncated or too long.
+static unsigned get_varint(uint8_t const *p, uint8_t const *end, uint32_t *v)
+{
+    // short widths are the common case
+    if (p < end && p[0] < 0x80) {
+        *v = p[0];
+        return 1;
+    }
+    uint32_t val = 0;
+    for (unsigned n = 0; n < VARINT_MAX && p + n < end; ++n) {
+        val |= (uint32_t)(p[n] & 0x7f) << (7 * n);
+        if (!(p[n] & 0x80)) {
+            *v = val;
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+pulse_bin_writer_t *pulse_bin_open(char const *path, int overwrite)
+{
+    pulse_bin_writer_t *writer = calloc(1, sizeof(*writer));
+    if (!writer) {
+        WARN_CALLOC("pulse_bin_open()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+
+    writer->file = fopen(path, overwrite ? "w+b" : "a+b");
+    if (!writer->file) {
+        fprintf(stderr, "Failed to open %s\n", path);
+        free(writer);
+        return NULL;
+    }
+
+    // an existing file is appended to, check that it really is a pulse file
+    fseek(writer->file, 0, SEEK_END);
+    long len = ftell(writer->file);
+    if (len > 0) {
+        uint8_t header[FILE_HEADER_SIZE];
+        rewind(writer->file);
+        if (fread(header, 1, sizeof(header), writer->file) != sizeof(header)
+                || memcmp(header, file_magic, sizeof(file_magic))
+                || get_u32(&header[8]) != PULSE_BIN_VERSION) {
+            fprintf(stderr, "Not a pulse file, refusing to append to %s\n", path);
+            fclose(writer->file);
+            free(writer);
+            return NULL;
+        }
+        fseek(writer->file, 0, SEEK_END);
+    }
+    else {
+        uint8_t header[FILE_HEADER_SIZE] = {0};
+        memcpy(header, file_magic, sizeof(file_magic));
+        put_u32(&header[8], PULSE_BIN_VERSION);
+        fwrite(header, 1, sizeof(header), writer->file);
+        len = FILE_HEADER_SIZE;
+    }
+    writer->offset = (uint64_t)len;
+
+    size_t path_len  = strlen(path);
+    char *index_path = malloc(path_len + 5);
+    if (!index_path) {
+        WARN_MALLOC("pulse_bin_open()");
+        fclose(writer->file);
+        free(writer);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    memcpy(index_path, path, path_len);
+    memcpy(&index_path[path_len], ".idx", 5);
+    writer->index = fopen(index_path, overwrite ? "wb" : "ab");
+    if (!writer->index) {
+        fprintf(stderr, "Failed to open %s\n", index_path);
+        free(index_path);
+        fclose(writer->file);
+        free(writer);
+        return NULL;
+    }
+    free(index_path);
+
+    return writer;
+}
+
+int pulse_bin_write(pulse_bin_writer_t *writer, pulse_data_t const *data)
+{
+    unsigned num_pulses = data->num_pulses < PD_MAX_PULSES ? data->num_pulses : PD_MAX_PULSES;
+    // the record buffer grows with the longest package written
+    if (RECORD_SIZE(num_pulses) > writer->record_size) {
+        size_t record_size = RECORD_SIZE(num_pulses < PD_MIN_CAPACITY ? PD_MIN_CAPACITY : num_pulses);
+        uint8_t *buf = realloc(writer->record, record_size);
+        if (!buf) {
+            WARN_REALLOC("pulse_bin_write()");
+            return -1;
+        }
+        writer->record      = buf;
+        writer->record_size = record_size;
+    }
+    uint8_t *record = writer->record;
+
+    memcpy(record, record_magic, sizeof(record_magic));
+    put_u64(&record[8], data->offset);
+    put_u32(&record[16], data->sample_rate);
+    put_u32(&record[20], data->depth_bits);
+    put_u32(&record[24], num_pulses);
+    put_u32(&record[28], (uint32_t)data->fsk_f1_est);
+    put_u32(&record[32], (uint32_t)data->fsk_f2_est);
+    put_u32(&record[36], (uint32_t)data->ook_low_estimate);
+    put_u32(&record[40], (uint32_t)data->ook_high_estimate);
+    put_f32(&record[44], data->centerfreq_hz);
+    put_f32(&record[48], data->freq1_hz);
+    put_f32(&record[52], data->freq2_hz);
+    put_f32(&record[56], data->range_db);
+    put_f32(&record[60], data->rssi_db);
+    put_f32(&record[64], data->snr_db);
+    put_f32(&record[68], data->noise_db);
+
+    size_t len = RECORD_HEADER_SIZE;
+    for (unsigned i = 0; i < num_pulses; ++i) {
+        // widths are never negative, clamp just in case
+        len += put_varint(&record[len], data->pulse[i] > 0 ? (uint32_t)data->pulse[i] : 0);
+        len += put_varint(&record[len], data->gap[i] > 0 ? (uint32_t)data->gap[i] : 0);
+    }
+    put_u32(&record[4], (uint32_t)len);
+
+    if (fwrite(record, 1, len, writer->file) != len) {
+        fprintf(stderr, "Short write on pulse file\n");
+        return -1;
+    }
+
+    uint8_t entry[PULSE_BIN_INDEX_SIZE];
+    put_u64(&entry[0], writer->offset);
+    put_u64(&entry[8], data->offset);
+    put_u32(&entry[16], num_pulses);
+    put_u32(&entry[20], data->fsk_f2_est ? PULSE_DATA_FSK : PULSE_DATA_OOK);
+    if (fwrite(entry, 1, sizeof(entry), writer->index) != sizeof(entry)) {
+        fprintf(stderr, "Short write on pulse file index\n");
+        return -1;
+    }
+
+    writer->offset += len;
+    writer->count++;
+    return 0;
+}
+
+void pulse_bin_close(pulse_bin_writer_t *writer)
+{
+    if (!writer)
+        return;
+    if (writer->file)
+        fclose(writer->file);
+    if (writer->index)
+        fclose(writer->index);
+    free(writer->record);
+    free(writer);
+}
+
+int pulse_bin_reader_open(pulse_bin_reader_t *reader, FILE *file)
+{
+    memset(reader, 0, sizeof(*reader));
+
+    if (file_map_open(&reader->map, file) == 0) {
+        reader->data = reader->map.data;
+        reader->len  = reader->map.len;
+    }
+    else {
+        // pipes and stdin are read into memory as a whole
+        size_t size = 0;
+        size_t n;
+        do {
+            if (reader->len == size) {
+                size = size ? size * 2 : 1024 * 1024;
+                uint8_t *buf = realloc(reader->buf, size);
+                if (!buf)
+                    FATAL_REALLOC("pulse_bin_reader_open()");
+                reader->buf = buf;
+            }
+            n = fread(&reader->buf[reader->len], 1, size - reader->len, file);
+            reader->len += n;
+        } while (n > 0);
+        reader->data = reader->buf;
+    }
+
+    if (reader->len < FILE_HEADER_SIZE
+            || memcmp(reader->data, file_magic, sizeof(file_magic))
+            || get_u32(&reader->data[8]) != PULSE_BIN_VERSION) {
+        pulse_bin_reader_close(reader);
+        return -1;
+    }
+    reader->pos = FILE_HEADER_SIZE;
+    return 0;
+}
+
+int pulse_bin_read(pulse_bin_reader_t *reader, pulse_data_t *data)
+{
+    if (reader->pos >= reader->len)
+        return 0; // end of file
+    if (reader->len - reader->pos < RECORD_HEADER_SIZE)
+        return -1;
+
+    uint8_t const *record = &reader->data[reader->pos];
+    uint32_t len          = get_u32(&record[4]);
+    uint32_t num_pulses   = get_u32(&record[24]);
+    if (memcmp(record, record_magic, sizeof(record_magic))
+            || len < RECORD_HEADER_SIZE || len > reader->len - reader->pos
+            || num_pulses > PD_MAX_PULSES)
+        return -1;
+    file_map_advise(&reader->map, reader->pos, len);
+
+    pulse_data_clear(data);
+    pulse_data_reserve(data, num_pulses);
+    data->offset            = get_u64(&record[8]);
+    data->sample_rate       = get_u32(&record[16]);
+    data->depth_bits        = get_u32(&record[20]);
+    data->num_pulses        = num_pulses;
+    data->fsk_f1_est        = (int32_t)get_u32(&record[28]);
+    data->fsk_f2_est        = (int32_t)get_u32(&record[32]);
+    data->ook_low_estimate  = (int32_t)get_u32(&record[36]);
+    data->ook_high_estimate = (int32_t)get_u32(&record[40]);
+    data->centerfreq_hz     = get_f32(&record[44]);
+    data->freq1_hz          = get_f32(&record[48]);
+    data->freq2_hz          = get_f32(&record[52]);
+    data->range_db          = get_f32(&record[56]);
+    data->rssi_db           = get_f32(&record[60]);
+    data->snr_db            = get_f32(&record[64]);
+    data->noise_db          = get_f32(&record[68]);
+
+    uint8_t const *p   = &record[RECORD_HEADER_SIZE];
+    uint8_t const *end = &record[len];
+    for (unsigned i = 0; i < num_pulses; ++i) {
+        uint32_t pulse, gap;
+        unsigned n = get_varint(p, end, &pulse);
+        if (!n)
+            return -1;
+        p += n;
+        n = get_varint(p, end, &gap);
+        if (!n)
+            return -1;
+        p += n;
+        data->pulse[i] = (int)pulse;
+        data->gap[i]   = (int)gap;
+    }
+    if (p != end)
+        return -1;
+
+    reader->pos += len;
+    return 1;
+}
+
+void pulse_bin_reader_close(pulse_bin_reader_t *reader)
+{
+    file_map_close(&reader->map);
+    free(reader->buf);
+    memset(reader, 0, sizeof(*reader));
+}
+
+int pulse_bin_read_index(FILE *index, unsigned num, pulse_bin_index_t *entry)
+{
+    uint8_t buf[PULSE_BIN_INDEX_SIZE];
+    if (fseek(index, (long)num * PULSE_BIN_INDEX_SIZE, SEEK_SET) != 0
+            || fread(buf, 1, sizeof(buf), index) != sizeof(buf))
+        return -1;
+
+    entry->record_offset = get_u64(&buf[0]);
+    entry->offset        = get_u64(&buf[8]);
+    entry->num_pulses    = get_u32(&buf[16]);
+    entry->package_type  = get_u32(&buf[20]);
+    return 0;
+}
@@ -22,16 +22,112 @@
 #include <stdlib.h>
 #include <string.h>
 
+// Pulse storage blocks hold the pulses and then the gaps, in power of two sizes from PD_MIN_CAPACITY.
+// Released blocks are kept in a free list per size, packages reuse them without allocations.
+#define PULSE_POOL_SIZES 8 // PD_MIN_CAPACITY << 7 == PD_MAX_PULSES
+#define PULSE_POOL_KEEP  4 // blocks kept per size
+
+typedef struct pulse_block {
+    struct pulse_block *next;
+} pulse_block_t;
+
+static struct {
+    pulse_block_t *free[PULSE_POOL_SIZES];
+    unsigned count[PULSE_POOL_SIZES];
+} pulse_pool;
+
+/// Pool index of a block size, PULSE_POOL_SIZES if it is not pooled.
+static unsigned pulse_pool_index(unsigned capacity)
+{
+    unsigned idx = 0;
+    while (idx < PULSE_POOL_SIZES && ((unsigned)PD_MIN_CAPACITY << idx) != capacity)
+        idx++;
+    return idx;
+}
+
+static int *pulse_pool_take(unsigned capacity)
+{
+    unsigned idx = pulse_pool_index(capacity);
+    if (idx < PULSE_POOL_SIZES && pulse_pool.free[idx]) {
+        pulse_block_t *block  = pulse_pool.free[idx];
+        pulse_pool.free[idx]  = block->next;
+        pulse_pool.count[idx]--;
+        return (int *)block;
+    }
+    int *storage = malloc(2 * (size_t)capacity * sizeof(*storage));
+    if (!storage)
+        FATAL_MALLOC("pulse_data_reserve()");
+    return storage;
+}
+
+static void pulse_pool_give(int *storage, unsigned capacity)
+{
+    unsigned idx = pulse_pool_index(capacity);
+    if (idx >= PULSE_POOL_SIZES || pulse_pool.count[idx] >= PULSE_POOL_KEEP) {
+        free(storage);
+        return;
+    }
+    pulse_block_t *block = (pulse_block_t *)storage;
+    block->next          = pulse_pool.free[idx];
+    pulse_pool.free[idx] = block;
+    pulse_pool.count[idx]++;
+}
+
 void pulse_data_clear(pulse_data_t *data)
 {
+    unsigned capacity = data->capacity;
+    int *pulse        = data->pulse;
+    int *gap          = data->gap;
+    *data = (pulse_data_t const){0};
+    data->capacity = capacity;
+    data->pulse    = pulse;
+    data->gap      = gap;
+}
+
+void pulse_data_reserve(pulse_data_t *data, unsigned num_pulses)
+{
+    if (num_pulses <= data->capacity)
+        return;
+
+    unsigned capacity = PD_MIN_CAPACITY;
+    while (capacity < num_pulses)
+        capacity *= 2;
+    int *storage = pulse_pool_take(capacity);
+    // copy all of the old storage, detectors store a pulse before counting it
+    if (data->capacity) {
+        memcpy(storage, data->pulse, data->capacity * sizeof(*storage));
+        memcpy(storage + capacity, data->gap, data->capacity * sizeof(*storage));
+        pulse_pool_give(data->pulse, data->capacity);
+    }
+    data->capacity = capacity;
+    data->pulse    = storage;
+    data->gap      = storage + capacity;
+}
+
+void pulse_data_free(pulse_data_t *data)
+{
+    if (data->capacity)
+        pulse_pool_give(data->pulse, data->capacity);
     *data = (pulse_data_t const){0};
 }
 
+void pulse_data_pool_free(void)
+{
+    for (unsigned idx = 0; idx < PULSE_POOL_SIZES; ++idx) {
+        while (pulse_pool.free[idx]) {
+            pulse_block_t *block = pulse_pool.free[idx];
+            pulse_pool.free[idx] = block->next;
+            free(block);
+        }
+        pulse_pool.count[idx] = 0;
+    }
+}
+
 void pulse_data_shift(pulse_data_t *data)
 {
-    int offs = PD_MAX_PULSES / 2; // shift out half the data
-    memmove(data->pulse, &data->pulse[offs], (PD_MAX_PULSES - offs) * sizeof(*data->pulse));
-    memmove(data->gap, &data->gap[offs], (PD_MAX_PULSES - offs) * sizeof(*data->gap));
+    unsigned offs = data->num_pulses / 2; // shift out half the data
+    memmove(data->pulse, &data->pulse[offs], (data->num_pulses - offs) * sizeof(*data->pulse));
+    memmove(data->gap, &data->gap[offs], (data->num_pulses - offs) * sizeof(*data->gap));
     data->num_pulses -= offs;
     data->offset += offs;
 }
@@ -123,7 +219,7 @@ void pulse_data_load(FILE *file, pulse_data_t *data, uint32_t sample_rate)
 {
     char s[1024];
     int i    = 0;
-    int size = sizeof(data->pulse) / sizeof(*data->pulse);
+    int size = PD_MAX_PULSES;
 
     pulse_data_clear(data);
     data->sample_rate = sample_rate;
@@ -137,6 +233,9 @@ void pulse_data_load(FILE *file, pulse_data_t *data, uint32_t sample_rate)
         if (!strncmp(s, ";freq2", 6)) {
             data->freq2_hz = strtol(s + 6, NULL, 10);
         }
+        if (!strncmp(s, ";offset", 7)) {
+            data->offset = (uint64_t)(to_sample * strtod(s + 7, NULL));
+        }
         if (*s == ';') {
             if (i) {
                 break; // end or next header found
@@ -157,6 +256,7 @@ void pulse_data_load(FILE *file, pulse_data_t *data, uint32_t sample_rate)
         p          = endptr + 1;
         long space = strtol(p, &endptr, 10);
         //fprintf(stderr, "read: mark %ld space %ld\n", mark, space);
+        pulse_data_reserve(data, i + 1);
         data->pulse[i] = (int)(to_sample * mark);
         data->gap[i++] = (int)(to_sample * space);
     }
@@ -187,6 +287,7 @@ void pulse_data_dump(FILE *file, pulse_data_t *data)
         chk_ret(fprintf(file, ";freq1 %.0f\n", data->freq1_hz));
     }
     chk_ret(fprintf(file, ";centerfreq %.0f Hz\n", data->centerfreq_hz));
+    chk_ret(fprintf(file, ";offset %.0f us\n", data->offset * 1e6 / data->sample_rate));
     chk_ret(fprintf(file, ";samplerate %u Hz\n", data->sample_rate));
     chk_ret(fprintf(file, ";sampledepth %u bits\n", data->depth_bits));
     chk_ret(fprintf(file, ";range %.1f dB\n", data->range_db));
@@ -203,7 +304,11 @@ void pulse_data_dump(FILE *file, pulse_data_t *data)
 
 data_t *pulse_data_print_data(pulse_data_t *data)
 {
-    int pulses[2 * PD_MAX_PULSES];
+    int *pulses = malloc(2 * (data->num_pulses + 1) * sizeof(*pulses));
+    if (!pulses) {
+        WARN_MALLOC("pulse_data_print_data()");
+        return NULL;
+    }
     double to_us = 1e6 / data->sample_rate;
     for (unsigned i = 0; i < data->num_pulses; ++i) {
         pulses[i * 2 + 0] = data->pulse[i] * to_us;
@@ -211,7 +316,7 @@ data_t *pulse_data_print_data(pulse_data_t *data)
     }
 
     /* clang-format off */
-    return data_make(
+    data_t *out = data_make(
             "mod",              "", DATA_STRING, (data->fsk_f2_est) ? "FSK" : "OOK",
             "count",            "", DATA_INT,    data->num_pulses,
             "pulses",           "", DATA_ARRAY,  data_array(2 * data->num_pulses, DATA_INT, pulses),
@@ -226,6 +331,8 @@ data_t *pulse_data_print_data(pulse_data_t *data)
             "noise_dB",         "", DATA_FORMAT, "%.1f dB", DATA_DOUBLE, data->noise_db,
             NULL);
     /* clang-format on */
+    free(pulses);
+    return out;
 }
 
 // OOK adaptive level estimator constants
@@ -398,6 +505,10 @@ int pulse_detect_package(pulse_detect_t *pulse_detect, int16_t const *envelope_d
     pulse_detect_t *s = pulse_detect;
     s->ook_high_estimate = MAX(s->ook_high_estimate, pulse_detect->ook_min_high_level);    // Be sure to set initial minimum level
 
+    // detectors store the next pulse before counting it
+    pulse_data_reserve(pulses, pulses->num_pulses + 1);
+    pulse_data_reserve(fsk_pulses, fsk_pulses->num_pulses + 1);
+
     if (s->data_counter == 0) {
         // age the pulse_data if this is a fresh buffer
         pulses->start_ago += len;
@@ -552,6 +663,7 @@ int pulse_detect_package(pulse_detect_t *pulse_detect, int16_t const *envelope_d
                             print_att_hist("PULSE_DATA_OOK MAX_PULSES", att_hist);
                         return PULSE_DATA_OOK;    // End Of Package!!
                     }
+                    pulse_data_reserve(pulses, pulses->num_pulses + 1);
 
                     s->pulse_length = 0;
                     s->ook_state = PD_OOK_STATE_PULSE;
@@ -62,6 +62,7 @@ void pulse_FSK_detect(int16_t fm_n, pulse_data_t *fsk_pulses, pulse_FSK_state_t
                     fsk_pulses->pulse[0] = 0;        // Initial frequency was a gap...
                     fsk_pulses->gap[0] = s->fsk_pulse_length;        // Store gap width
                     fsk_pulses->num_pulses++;
+                    pulse_data_reserve(fsk_pulses, fsk_pulses->num_pulses + 1);
                     s->fsk_pulse_length = 0;
                 }
                 // Negative Frequency delta - Initial frequency was high (pulse)
@@ -121,6 +122,7 @@ void pulse_FSK_detect(int16_t fm_n, pulse_data_t *fsk_pulses, pulse_FSK_state_t
                         // TODO: workaround, specifically for the Inkbird-ITH20R: free some of the buffer
                         pulse_data_shift(fsk_pulses);
                     }
+                    pulse_data_reserve(fsk_pulses, fsk_pulses->num_pulses + 1);
                 }
                 // Else rewind to last pulse
                 else {
@@ -218,6 +220,7 @@ void pulse_FSK_detect_mm(int16_t fm_n, pulse_data_t *fsk_pulses, pulse_FSK_state
                         // TODO: workaround, specifically for the Inkbird-ITH20R: free some of the buffer
                         pulse_data_shift(fsk_pulses);
                     }
+                    pulse_data_reserve(fsk_pulses, fsk_pulses->num_pulses + 1);
                 }
                 s->fm_f1_est += fm_n / FSK_EST_SLOW - s->fm_f1_est / FSK_EST_SLOW; // Slow estimator
                 break;
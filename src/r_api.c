@@ -23,10 +23,14 @@
 #include "rtl_433_devices.h"
 #include "r_device.h"
 #include "pulse_slicer.h"
+#include "bitbuffer.h"
 #include "pulse_detect_fsk.h"
 #include "sdr.h"
 #include "data.h"
 #include "data_tag.h"
+#include "data_dedup.h"
+#include "burst_store.h"
+#include "sigmf.h"
 #include "list.h"
 #include "optparse.h"
 #include "output_file.h"
@@ -140,8 +144,19 @@ void set_gain_str(struct r_cfg *cfg, char const *gain_str)
 
 /* general */
 
+/// The protocol registry, the device templates in protocol number order.
+/// The templates are not changed, the protocol number is set on each registered copy.
+static r_device *const protocol_registry[] = {
+#define DECL(name) &name,
+        DEVICES
+#undef DECL
+};
+
 void r_init_cfg(r_cfg_t *cfg)
 {
+    // note the start time first, for the time to the first sample
+    metrics_init(&cfg->metrics);
+
     cfg->out_block_size  = DEFAULT_BUF_LENGTH;
     cfg->samp_rate       = DEFAULT_SAMPLE_RATE;
     cfg->conversion_mode = CONVERT_NATIVE;
@@ -150,22 +165,9 @@ void r_init_cfg(r_cfg_t *cfg)
     list_ensure_size(&cfg->in_files, 100);
     list_ensure_size(&cfg->output_handler, 16);
 
-    // collect devices list, this should be a module
-    r_device r_devices[] = {
-#define DECL(name) name,
-            DEVICES
-#undef DECL
-    };
-
-    cfg->num_r_devices = sizeof(r_devices) / sizeof(*r_devices);
-    for (unsigned i = 0; i < cfg->num_r_devices; i++) {
-        r_devices[i].protocol_num = i + 1;
-    }
-    cfg->devices = malloc(sizeof(r_devices));
-    if (!cfg->devices)
-        FATAL_CALLOC("r_init_cfg()");
-
-    memcpy(cfg->devices, r_devices, sizeof(r_devices));
+    // decoders are instantiated from the templates when registered
+    cfg->devices       = protocol_registry;
+    cfg->num_r_devices = sizeof(protocol_registry) / sizeof(*protocol_registry);
 
     cfg->demod = calloc(1, sizeof(*cfg->demod));
     if (!cfg->demod)
@@ -206,12 +208,18 @@ void r_free_cfg(r_cfg_t *cfg)
 
     free(cfg->gain_str);
 
+    // stop the raw outputs first, they read from the sample ring
+    list_free_elems(&cfg->raw_handler, (list_elem_free_fn)raw_output_free);
+
     for (void **iter = cfg->demod->dumper.elems; iter && *iter; ++iter) {
         file_info_t const *dumper = *iter;
         if (dumper->file && (dumper->file != stdout))
             fclose(dumper->file);
     }
     list_free_elems(&cfg->demod->dumper, free);
+    list_free_elems(&cfg->demod->burst_stores, (list_elem_free_fn)burst_store_close);
+    list_free_elems(&cfg->demod->sigmf_writers, (list_elem_free_fn)sigmf_writer_close);
+    list_free_elems(&cfg->demod->pulse_writers, (list_elem_free_fn)pulse_bin_close);
 
     list_free_elems(&cfg->demod->r_devs, (list_elem_free_fn)free_protocol);
 
@@ -219,12 +227,23 @@ void r_free_cfg(r_cfg_t *cfg)
         am_analyze_free(cfg->demod->am_analyze);
 
     pulse_detect_free(cfg->demod->pulse_detect);
+    pulse_data_free(&cfg->demod->pulse_data);
+    pulse_data_free(&cfg->demod->fsk_pulse_data);
 
-    free(cfg->demod);
+    free(cfg->demod->am_buf);
+    free(cfg->demod->buf.fm);
+    free(cfg->demod->u8_buf);
+    free(cfg->demod->conv_buf);
 
-    free(cfg->devices);
+    if (cfg->demod->samp_grab)
+        samp_grab_free(cfg->demod->samp_grab);
+    ring_buf_free(cfg->demod->sample_ring);
 
-    list_free_elems(&cfg->raw_handler, (list_elem_free_fn)raw_output_free);
+    free(cfg->demod);
+
+    if (cfg->dedup)
+        flush_dedup_data(cfg, 1);
+    data_dedup_free(cfg->dedup);
 
     list_free_elems(&cfg->output_handler, (list_elem_free_fn)data_output_free);
 
@@ -232,6 +251,9 @@ void r_free_cfg(r_cfg_t *cfg)
 
     list_free_elems(&cfg->in_files, NULL);
 
+    pulse_data_pool_free();
+    bitbuffer_pool_free();
+
     mg_mgr_free(cfg->mgr);
     free(cfg->mgr);
 
@@ -240,7 +262,17 @@ void r_free_cfg(r_cfg_t *cfg)
 
 /* device decoder protocols */
 
-void register_protocol(r_cfg_t *cfg, r_device *r_dev, char *arg)
+/// The protocol number of a registry template, 0 for other decoders, e.g. flex.
+static unsigned protocol_number(r_cfg_t *cfg, r_device const *r_dev)
+{
+    for (unsigned i = 0; i < cfg->num_r_devices; i++) {
+        if (cfg->devices[i] == r_dev)
+            return i + 1;
+    }
+    return 0;
+}
+
+static void register_protocol_num(r_cfg_t *cfg, r_device *r_dev, unsigned protocol_num, char *arg)
 {
     // use arg of 'v', 'vv', 'vvv' as device verbosity
     int dev_verbose = 0;
@@ -260,7 +292,7 @@ void register_protocol(r_cfg_t *cfg, r_device *r_dev, char *arg)
     }
     else {
         if (arg && *arg) {
-            fprintf(stderr, "Protocol [%u] \"%s\" does not take arguments \"%s\"!\n", r_dev->protocol_num, r_dev->name, arg);
+            fprintf(stderr, "Protocol [%u] \"%s\" does not take arguments \"%s\"!\n", protocol_num, r_dev->name, arg);
         }
         p  = malloc(sizeof(*p));
         if (!p)
@@ -268,6 +300,7 @@ void register_protocol(r_cfg_t *cfg, r_device *r_dev, char *arg)
         *p = *r_dev; // copy
     }
 
+    p->protocol_num = protocol_num;
     p->verbose      = dev_verbose ? dev_verbose : (cfg->verbosity > 0 ? cfg->verbosity - 1 : 0);
     p->verbose_bits = cfg->verbose_bits;
 
@@ -277,10 +310,15 @@ void register_protocol(r_cfg_t *cfg, r_device *r_dev, char *arg)
     list_push(&cfg->demod->r_devs, p);
 
     if (cfg->verbosity) {
-        fprintf(stderr, "Registering protocol [%u] \"%s\"\n", r_dev->protocol_num, r_dev->name);
+        fprintf(stderr, "Registering protocol [%u] \"%s\"\n", protocol_num, r_dev->name);
     }
 }
 
+void register_protocol(r_cfg_t *cfg, r_device *r_dev, char *arg)
+{
+    register_protocol_num(cfg, r_dev, protocol_number(cfg, r_dev), arg);
+}
+
 void free_protocol(r_device *r_dev)
 {
     // free(r_dev->name);
@@ -301,10 +339,11 @@ void unregister_protocol(r_cfg_t *cfg, r_device *r_dev)
 
 void register_all_protocols(r_cfg_t *cfg, unsigned disabled)
 {
+    list_ensure_size(&cfg->demod->r_devs, cfg->demod->r_devs.len + cfg->num_r_devices + 1);
     for (int i = 0; i < cfg->num_r_devices; i++) {
         // register all device protocols that are not disabled
-        if (cfg->devices[i].disabled <= disabled) {
-            register_protocol(cfg, &cfg->devices[i], NULL);
+        if (cfg->devices[i]->disabled <= disabled) {
+            register_protocol_num(cfg, cfg->devices[i], i + 1, NULL);
         }
     }
 }
@@ -582,6 +621,25 @@ int run_fsk_demods(list_t *r_devs, pulse_data_t *fsk_pulse_data)
 
 /* handlers */
 
+/// Print to all output handlers, the time spent is accounted to the output stage.
+static void print_outputs(r_cfg_t *cfg, data_t *data)
+{
+    pipeline_metrics_t *metrics = &cfg->metrics;
+    double start      = metrics_cpu_time();
+    double wall_start = metrics_wall_time();
+    double wall       = wall_start;
+    for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
+        data_output_print(cfg->output_handler.elems[i], data);
+        double now = metrics_wall_time();
+        if (i < METRICS_OUTPUTS_MAX && cfg->output_handler.elems[i])
+            metrics_latency_observe(&metrics->output_latency[i], now - wall);
+        wall = now;
+    }
+    metrics_stage_end(metrics, METRICS_STAGE_OUTPUT, start);
+    metrics->output_wall_seconds += wall - wall_start;
+    metrics_latency_add(metrics, METRICS_LATENCY_OUTPUT, wall - wall_start);
+}
+
 /** Pass the data structure to all output handlers. Frees data afterwards. */
 void event_occurred_handler(r_cfg_t *cfg, data_t *data)
 {
@@ -594,17 +652,55 @@ void event_occurred_handler(r_cfg_t *cfg, data_t *data)
                 NULL);
     }
 
-    for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
-        data_output_print(cfg->output_handler.elems[i], data);
-    }
+    print_outputs(cfg, data);
     data_free(data);
 }
 
+/// Sample time in seconds, monotonic across input files and independent of the processing speed.
+static double dedup_time(r_cfg_t *cfg)
+{
+    return cfg->samp_rate ? (double)cfg->input_pos / cfg->samp_rate : 0.0;
+}
+
+/// Add a model to a comma separated list, unless already listed.
+static void add_model(char *list, size_t size, char const *model)
+{
+    size_t model_len = strlen(model);
+    char const *p    = list;
+    while (*p) {
+        size_t n = strcspn(p, ",");
+        if (n == model_len && !strncmp(p, model, n))
+            return;
+        p += n + (p[n] == ',');
+    }
+    size_t len = p - list;
+    if (len + model_len + 2 > size)
+        return; // no room
+    if (len)
+        list[len++] = ',';
+    strcpy(&list[len], model);
+}
+
+/// Note the model of an event in the current package and frame, for burst stores and SigMF annotations.
+static void add_frame_model(struct dm_state *demod, data_t *data)
+{
+    for (data_t *d = data; d; d = d->next) {
+        if (d->type == DATA_STRING && !strcmp(d->key, "model")) {
+            add_model(demod->frame_models, sizeof(demod->frame_models), d->value.v_ptr);
+            add_model(demod->package_models, sizeof(demod->package_models), d->value.v_ptr);
+            return;
+        }
+    }
+}
+
 /** Pass the data structure to all output handlers. Frees data afterwards. */
 void data_acquired_handler(r_device *r_dev, data_t *data)
 {
     r_cfg_t *cfg = r_dev->output_ctx;
 
+    if (cfg->demod->burst_stores.len || cfg->demod->sigmf_writers.len)
+        add_frame_model(cfg->demod, data);
+
 #ifndef NDEBUG
     // check for undeclared csv fields
     for (data_t *d = data; d; d = d->next) {
@@ -807,6 +903,14 @@ void data_acquired_handler(r_device *r_dev, data_t *data)
                 NULL);
     }
 
+    // the wall clock end of the package, if known
+    double end_time = cfg->demod->fsk_pulse_data.fsk_f2_est ? cfg->demod->fsk_pulse_data.end_time : cfg->demod->pulse_data.end_time;
+    if (cfg->report_latency && end_time > 0.0) {
+        data_append(data,
+                "latency_us", "Latency", DATA_FORMAT, "%d us", DATA_INT, (int)((metrics_wall_time() - end_time) * 1e6),
+                NULL);
+    }
+
     // prepend "time" if requested
     if (cfg->report_time != REPORT_TIME_OFF) {
         char time_str[LOCAL_TIME_BUFLEN];
@@ -822,12 +926,36 @@ void data_acquired_handler(r_device *r_dev, data_t *data)
         data            = data_tag_apply(tag, data, cfg->in_filename);
     }
 
-    for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
-        data_output_print(cfg->output_handler.elems[i], data);
+    // drop or hold repeated events
+    if (cfg->dedup) {
+        data = data_dedup_apply(cfg->dedup, data, dedup_time(cfg));
+        if (!data)
+            return;
     }
+
+    print_outputs(cfg, data);
+    data_free(data);
+
+    // events held back by dedup are not traced
+    if (end_time > 0.0)
+        metrics_latency_add(&cfg->metrics, METRICS_LATENCY_TOTAL, metrics_wall_time() - end_time);
+}
+
+void event_forward_handler(r_cfg_t *cfg, data_t *data)
+{
+    print_outputs(cfg, data);
     data_free(data);
 }
 
+void flush_dedup_data(r_cfg_t *cfg, int all)
+{
+    data_t *data;
+    while ((data = data_dedup_expire(cfg->dedup, all ? -1.0 : dedup_time(cfg)))) {
+        print_outputs(cfg, data);
+        data_free(data);
+    }
+}
+
 // level 0: do not report (don't call this), 1: report successful devices, 2: report active devices, 3: report all
 data_t *create_report_data(r_cfg_t *cfg, int level)
 {
@@ -886,11 +1014,77 @@ data_t *create_report_data(r_cfg_t *cfg, int level)
     char since_str[LOCAL_TIME_BUFLEN];
     format_time_str(since_str, "%Y-%m-%dT%H:%M:%S", cfg->report_time_tz, cfg->frames_since);
 
+    if (cfg->dedup) {
+        data_dedup_t *dedup = cfg->dedup;
+        data_append(data,
+                "dedup", "", DATA_DATA, data_make(
+                        "lookups",  "", DATA_INT, dedup->lookups,
+                        "hits",     "", DATA_INT, dedup->hits,
+                        "hit_rate", "", DATA_DOUBLE, dedup->lookups ? (double)dedup->hits / dedup->lookups : 0.0,
+                        "entries",  "", DATA_INT, data_dedup_entries(dedup, dedup_time(cfg)),
+                        "held",     "", DATA_INT, dedup->held,
+                        "memory",   "", DATA_INT, (int)data_dedup_memory(dedup),
+                        NULL),
+                NULL);
+    }
+
+    // input counters are since the start of the device
+    sdr_stats_t const *sdr_stats = sdr_get_stats(cfg->dev);
+    data_t *input_data = NULL;
+    if (sdr_stats) {
+        input_data = data_make(
+                "buffers",      "", DATA_INT, (int)sdr_stats->buffers,
+                "samples",      "", DATA_DOUBLE, (double)sdr_stats->samples,
+                "expected",     "", DATA_DOUBLE, (double)sdr_stats->samples_expected,
+                "dropped",      "", DATA_INT, (int)sdr_stats->dropped,
+                "gaps",         "", DATA_INT, (int)sdr_stats->gaps,
+                "overruns",     "", DATA_INT, (int)sdr_stats->overruns,
+                "late",         "", DATA_INT, (int)sdr_stats->late,
+                "callback_max_ms", "", DATA_DOUBLE, sdr_stats->callback_max * 1000.0,
+                "load",         "", DATA_DOUBLE, sdr_stats->buffer_seconds > 0.0 ? sdr_stats->callback_seconds / sdr_stats->buffer_seconds : 0.0,
+                NULL);
+    }
+
+    // pipeline counters are since start
+    pipeline_metrics_t const *metrics = &cfg->metrics;
+    data_t *stage_data = NULL;
+    for (int i = 0; i < METRICS_STAGE_COUNT; ++i) {
+        stage_data = data_append(stage_data,
+                metrics_stage_name(i), "", DATA_DOUBLE, metrics->stage_seconds[i] * 1000.0,
+                NULL);
+    }
+    data_t *pipeline_data = data_make(
+            "buffers",          "", DATA_INT, (int)metrics->buffers,
+            "samples",          "", DATA_DOUBLE, (double)metrics->samples,
+            "packages_ook",     "", DATA_INT, (int)metrics->packages_ook,
+            "packages_fsk",     "", DATA_INT, (int)metrics->packages_fsk,
+            "startup_ms",       "", DATA_DOUBLE, metrics->startup_seconds * 1000.0,
+            "cpu_ms",           "", DATA_DATA, stage_data,
+            NULL);
+
+    data_t *latency_data[METRICS_LATENCY_COUNT];
+    int latency_len = 0;
+    for (int i = 0; i < METRICS_LATENCY_COUNT; ++i) {
+        metrics_latency_t const *lat = &cfg->metrics.latency_interval[i];
+        if (!lat->count)
+            continue;
+        latency_data[latency_len++] = data_make(
+                "stage",        "", DATA_STRING, metrics_latency_name(i),
+                "count",        "", DATA_INT, (int)lat->count,
+                "p50_us",       "", DATA_INT, (int)(metrics_latency_quantile(lat, 0.5) * 1e6),
+                "p99_us",       "", DATA_INT, (int)(metrics_latency_quantile(lat, 0.99) * 1e6),
+                "max_us",       "", DATA_INT, (int)(lat->max * 1e6),
+                NULL);
+    }
+
     data = data_make(
             "enabled",          "", DATA_INT, r_devs->len,
             "since",            "", DATA_STRING, since_str,
             "frames",           "", DATA_DATA, data,
             "stats",            "", DATA_ARRAY, data_array(dev_data_list.len, DATA_DATA, dev_data_list.elems),
+            "pipeline",         "", DATA_DATA, pipeline_data,
+            "latency",          "", DATA_COND, latency_len > 0, DATA_ARRAY, data_array(latency_len, DATA_DATA, latency_data),
+            "input",            "", DATA_COND, input_data != NULL, DATA_DATA, input_data,
             NULL);
 
     list_free_elems(&dev_data_list, NULL);
@@ -906,9 +1100,22 @@ void flush_report_data(r_cfg_t *cfg)
     cfg->frames_fsk = 0;
     cfg->frames_events = 0;
 
+    if (cfg->dedup) {
+        cfg->dedup->lookups = 0;
+        cfg->dedup->hits    = 0;
+    }
+
+    memset(cfg->metrics.latency_interval, 0, sizeof(cfg->metrics.latency_interval));
+
     for (void **iter = r_devs->elems; iter && *iter; ++iter) {
         r_device *r_dev = *iter;
 
+        r_dev->total_events += r_dev->decode_events;
+        r_dev->total_ok += r_dev->decode_ok;
+        r_dev->total_messages += r_dev->decode_messages;
+        for (int i = 0; i < 5; ++i)
+            r_dev->total_fails[i] += r_dev->decode_fails[i];
+
         r_dev->decode_events = 0;
         r_dev->decode_ok = 0;
         r_dev->decode_messages = 0;
@@ -936,18 +1143,36 @@ static FILE *fopen_output(char *param)
     return file;
 }
 
+/// Add an output handler, named for the statistics.
+static void push_output(r_cfg_t *cfg, data_output_t *output, char const *name)
+{
+    if (output)
+        output->name = name;
+    list_push(&cfg->output_handler, output);
+}
+
 void add_json_output(r_cfg_t *cfg, char *param)
 {
-    list_push(&cfg->output_handler, data_output_json_create(fopen_output(param)));
+    push_output(cfg, data_output_json_create(fopen_output(param)), "json");
 }
 
 void add_csv_output(r_cfg_t *cfg, char *param)
 {
-    list_push(&cfg->output_handler, data_output_csv_create(fopen_output(param)));
+    push_output(cfg, data_output_csv_create(fopen_output(param)), "csv");
 }
 
 void start_outputs(r_cfg_t *cfg, char const *const *well_known)
 {
+    // only the CSV output needs the fields, don't collect them otherwise
+    int needs_fields = 0;
+    for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
+        data_output_t *output = cfg->output_handler.elems[i];
+        if (output && output->output_start)
+            needs_fields = 1;
+    }
+    if (!needs_fields)
+        return;
+
     int num_output_fields;
     char const **output_fields = determine_csv_fields(cfg, well_known, &num_output_fields);
 
@@ -960,27 +1185,27 @@ void start_outputs(r_cfg_t *cfg, char const *const *well_known)
 
 void add_kv_output(r_cfg_t *cfg, char *param)
 {
-    list_push(&cfg->output_handler, data_output_kv_create(fopen_output(param)));
+    push_output(cfg, data_output_kv_create(fopen_output(param)), "kv");
 }
 
 void add_mqtt_output(r_cfg_t *cfg, char *param)
 {
-    list_push(&cfg->output_handler, data_output_mqtt_create(get_mgr(cfg), param, cfg->dev_query));
+    push_output(cfg, data_output_mqtt_create(get_mgr(cfg), param, cfg->dev_query), "mqtt");
 }
 
 void add_influx_output(r_cfg_t *cfg, char *param)
 {
-    list_push(&cfg->output_handler, data_output_influx_create(get_mgr(cfg), param));
+    push_output(cfg, data_output_influx_create(get_mgr(cfg), param), "influx");
 }
 
 void add_syslog_output(r_cfg_t *cfg, char *param)
 {
     char *host = "localhost";
     char *port = "514";
-    hostport_param(param, &host, &port);
+    char *opts = hostport_param(param, &host, &port);
     fprintf(stderr, "Syslog UDP datagrams to %s port %s\n", host, port);
 
-    list_push(&cfg->output_handler, data_output_syslog_create(host, port));
+    push_output(cfg, data_output_syslog_create(get_mgr(cfg), host, port, opts), "syslog");
 }
 
 void add_http_output(r_cfg_t *cfg, char *param)
@@ -990,12 +1215,12 @@ void add_http_output(r_cfg_t *cfg, char *param)
     hostport_param(param, &host, &port);
     fprintf(stderr, "HTTP server at %s port %s\n", host, port);
 
-    list_push(&cfg->output_handler, data_output_http_create(get_mgr(cfg), host, port, cfg));
+    push_output(cfg, data_output_http_create(get_mgr(cfg), host, port, cfg), "http");
 }
 
 void add_trigger_output(r_cfg_t *cfg, char *param)
 {
-    list_push(&cfg->output_handler, data_output_trigger_create(fopen_output(param)));
+    push_output(cfg, data_output_trigger_create(fopen_output(param)), "trigger");
 }
 
 void add_null_output(r_cfg_t *cfg, char *param)
@@ -1008,10 +1233,29 @@ void add_rtltcp_output(r_cfg_t *cfg, char *param)
 {
     char *host = "localhost";
     char *port = "1234";
-    hostport_param(param, &host, &port);
+    char *opts = hostport_param(param, &host, &port);
     fprintf(stderr, "rtl_tcp server at %s port %s\n", host, port);
 
-    list_push(&cfg->raw_handler, raw_output_rtltcp_create(host, port, cfg));
+    list_push(&cfg->raw_handler, raw_output_rtltcp_create(host, port, opts, cfg));
+}
+
+ring_buf_t *get_sample_ring(r_cfg_t *cfg)
+{
+    if (!cfg->demod->sample_ring) {
+        cfg->demod->sample_ring = ring_buf_create(SIGNAL_GRABBER_BUFFER);
+        if (!cfg->demod->sample_ring)
+            exit(1);
+    }
+    return cfg->demod->sample_ring;
+}
+
+void add_samp_grab(r_cfg_t *cfg)
+{
+    if (cfg->demod->samp_grab)
+        return;
+    cfg->demod->samp_grab = samp_grab_create(get_sample_ring(cfg));
+    if (!cfg->demod->samp_grab)
+        exit(1);
 }
 
 void add_sr_dumper(r_cfg_t *cfg, char const *spec, int overwrite)
@@ -1035,6 +1279,9 @@ void close_dumpers(struct r_cfg *cfg)
             dumper->file = NULL;
         }
     }
+    list_clear(&cfg->demod->burst_stores, (list_elem_free_fn)burst_store_close);
+    list_clear(&cfg->demod->sigmf_writers, (list_elem_free_fn)sigmf_writer_close);
+    list_clear(&cfg->demod->pulse_writers, (list_elem_free_fn)pulse_bin_close);
 
     char const *labels[] = {
             "FRAME", // probe1
@@ -1064,9 +1311,38 @@ void add_dumper(r_cfg_t *cfg, char const *spec, int overwrite)
     file_info_t *dumper = calloc(1, sizeof(*dumper));
     if (!dumper)
         FATAL_CALLOC("add_dumper()");
+    file_info_parse_filename(dumper, spec);
+
+    if (dumper->format == BURST_IQ) {
+        // bursts are cut from the signal grabber buffer and appended to the store
+        burst_store_t *store = burst_store_open(dumper->path, overwrite);
+        if (!store)
+            exit(1);
+        list_push(&cfg->demod->burst_stores, store);
+        add_samp_grab(cfg);
+        free(dumper);
+        return;
+    }
+    if (dumper->format == SIGMF_IQ) {
+        // the samples are written as received, packages are annotated
+        sigmf_writer_t *writer = sigmf_writer_open(dumper->path, overwrite);
+        if (!writer)
+            exit(1);
+        list_push(&cfg->demod->sigmf_writers, writer);
+        free(dumper);
+        return;
+    }
+    if (dumper->format == PULSE_BIN) {
+        // packages are appended as they are detected, with an index
+        pulse_bin_writer_t *writer = pulse_bin_open(dumper->path, overwrite);
+        if (!writer)
+            exit(1);
+        list_push(&cfg->demod->pulse_writers, writer);
+        free(dumper);
+        return;
+    }
     list_push(&cfg->demod->dumper, dumper);
 
-    file_info_parse_filename(dumper, spec);
     if (strcmp(dumper->path, "-") == 0) { /* Write samples to stdout */
         dumper->file = stdout;
 #ifdef _WIN32
@@ -1101,3 +1377,9 @@ void add_data_tag(struct r_cfg *cfg, char *param)
 {
     list_push(&cfg->data_tags, data_tag_create(param, get_mgr(cfg)));
 }
+
+void add_dedup(struct r_cfg *cfg, char *param)
+{
+    data_dedup_free(cfg->dedup);
+    cfg->dedup = data_dedup_create(param);
+}
@@ -143,6 +143,8 @@ static bool parse_rfraw(pulse_data_t *data, char const **p)
         int w = hexstr_get_nibble(p);
         aligned = !aligned;
         if (w < 0) return false;
+        if (data->num_pulses >= PD_MAX_PULSES - 1) return false;
+        pulse_data_reserve(data, data->num_pulses + 2);
         if (w >= 8 || (oldfmt && !aligned)) { // pulse
             if (!pulse_needed) {
                 data->gap[data->num_pulses] = 0;
@@ -164,6 +166,7 @@ static bool parse_rfraw(pulse_data_t *data, char const **p)
 
     unsigned pkt_pulses = data->num_pulses - prev_pulses;
     for (int i = 1; i < repeats && data->num_pulses + pkt_pulses <= PD_MAX_PULSES; ++i) {
+        pulse_data_reserve(data, data->num_pulses + pkt_pulses);
         memcpy(&data->pulse[data->num_pulses], &data->pulse[prev_pulses], pkt_pulses * sizeof (*data->pulse));
         memcpy(&data->gap[data->num_pulses], &data->gap[prev_pulses], pkt_pulses * sizeof (*data->pulse));
         data->num_pulses += pkt_pulses;
@@ -0,0 +1,188 @@
+/** @file
+    Double-mapped ring buffer of raw samples, one writer and any number of readers.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+// memfd syscall needs _GNU_SOURCE on some libcs
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "ring_buf.h"
+#include "fatal.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#endif
+
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+// The head is published with release semantics and read with acquire semantics.
+#if defined(__GNUC__) || defined(__clang__)
+#define HEAD_LOAD(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define HEAD_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#else
+// aligned 64-bit volatile accesses are ordered on the MSVC targets
+#define HEAD_LOAD(p)     (*(uint64_t volatile *)(p))
+#define HEAD_STORE(p, v) (*(uint64_t volatile *)(p) = (v))
+#endif
+
+#ifndef _WIN32
+
+/// An unlinked shared memory file descriptor of @p size bytes, -1 on failure.
+static int shared_fd(size_t size)
+{
+    int fd = -1;
+#if defined(__linux__) && defined(SYS_memfd_create)
+    fd = (int)syscall(SYS_memfd_create, "rtl_433_ring", 1U); // MFD_CLOEXEC
+#elif !defined(__ANDROID__)
+    static unsigned counter = 0;
+    char name[32]; // macOS limits shared memory names to 31 chars
+    snprintf(name, sizeof(name), "/rtl433_%ld_%u", (long)getpid(), counter++);
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd >= 0)
+        shm_unlink(name);
+#endif
+    if (fd >= 0 && ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+/// Map the same memory twice, back to back, returns NULL on failure.
+static uint8_t *map_double(size_t size)
+{
+    int fd = shared_fd(size);
+    if (fd < 0)
+        return NULL;
+
+    // reserve the address range, then map the file over both halves
+    uint8_t *base = mmap(NULL, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+    if (mmap(base, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED
+            || mmap(base + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(base, 2 * size);
+        close(fd);
+        return NULL;
+    }
+    close(fd); // the mappings keep the memory
+    return base;
+}
+
+static size_t page_size(void)
+{
+    long size = sysconf(_SC_PAGESIZE);
+    return size > 0 ? (size_t)size : 4096;
+}
+
+#else
+
+static uint8_t *map_double(size_t size)
+{
+    (void)size;
+    return NULL; // not mapped on Windows, the mirrored copy is used
+}
+
+static size_t page_size(void)
+{
+    return 4096;
+}
+
+#endif
+
+ring_buf_t *ring_buf_create(size_t min_size)
+{
+    ring_buf_t *ring = calloc(1, sizeof(*ring));
+    if (!ring) {
+        WARN_CALLOC("ring_buf_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+
+    size_t page = page_size();
+    ring->size  = (min_size + page - 1) / page * page;
+    if (!ring->size)
+        ring->size = page;
+
+    ring->buf = map_double(ring->size);
+    if (!ring->buf) {
+        ring->mirrored = 1;
+        ring->buf      = malloc(2 * ring->size);
+        if (!ring->buf) {
+            WARN_MALLOC("ring_buf_create()");
+            free(ring);
+            return NULL; // NOTE: returns NULL on alloc failure.
+        }
+    }
+
+    return ring;
+}
+
+void ring_buf_free(ring_buf_t *ring)
+{
+    if (!ring)
+        return;
+    if (ring->mirrored)
+        free(ring->buf);
+#ifndef _WIN32
+    else
+        munmap(ring->buf, 2 * ring->size);
+#endif
+    free(ring);
+}
+
+void ring_buf_write(ring_buf_t *ring, void const *data, size_t len)
+{
+    uint8_t const *src = data;
+    uint64_t head      = ring->head; // only the writer changes the head
+    if (len > ring->size) {
+        // only the newest data fits
+        src += len - ring->size;
+        head += len - ring->size;
+        len = ring->size;
+    }
+
+    size_t off = (size_t)(head % ring->size);
+    memcpy(&ring->buf[off], src, len);
+    if (ring->mirrored) {
+        // keep both halves the same, the write might have spilled into the second half
+        size_t first_len = len < ring->size - off ? len : ring->size - off;
+        memcpy(&ring->buf[off + ring->size], src, first_len);
+        if (len > first_len)
+            memcpy(&ring->buf[0], src + first_len, len - first_len);
+    }
+
+    HEAD_STORE(&ring->head, head + len);
+}
+
+uint64_t ring_buf_head(ring_buf_t *ring)
+{
+    return HEAD_LOAD(&ring->head);
+}
+
+uint64_t ring_buf_tail(ring_buf_t *ring)
+{
+    uint64_t head = ring_buf_head(ring);
+    return head > ring->size ? head - ring->size : 0;
+}
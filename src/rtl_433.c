@@ -44,8 +44,12 @@
 #include "r_util.h"
 #include "optparse.h"
 #include "abuf.h"
+#include "batch.h"
 #include "fileformat.h"
+#include "file_map.h"
 #include "samp_grab.h"
+#include "burst_store.h"
+#include "sigmf.h"
 #include "am_analyze.h"
 #include "confparse.h"
 #include "term_ctl.h"
@@ -123,6 +127,7 @@ static void delay_timer_wait(delay_timer_t *delay_timer, unsigned delay_us)
 }
 
 r_device *flex_create_device(char *spec); // maybe put this in some header file?
+int flex_check_spec(char const *spec);
 
 static void print_version(void)
 {
@@ -170,14 +175,16 @@ static void usage(int exit_code)
             "  [-S none | all | unknown | known] Signal auto save. Creates one file per signal.\n"
             "       Note: Saves raw I/Q samples (uint8 pcm, 2 channel). Preferred mode for generating test files.\n"
             "  [-r <filename> | help] Read data from input file instead of a receiver\n"
+            "  [-j <jobs>[,ordered][,split]] Read input files in parallel worker processes\n"
             "  [-w <filename> | help] Save data stream to output file (a '-' dumps samples to stdout)\n"
             "  [-W <filename> | help] Save data stream to output file, overwrite existing file\n"
             "\t\t= Data output options =\n"
             "  [-F kv | json | csv | mqtt | influx | syslog | trigger | null | help] Produce decoded output in given format.\n"
             "       Append output to file with :<filename> (e.g. -F csv:log.csv), defaults to stdout.\n"
             "       Specify host/port for syslog with e.g. -F syslog:127.0.0.1:1514\n"
-            "  [-M time[:<options>] | protocol | level | noise[:secs] | stats | bits | help] Add various meta data to each output.\n"
+            "  [-M time[:<options>] | protocol | level | noise[:secs] | stats | latency | bits | help] Add various meta data to each output.\n"
             "  [-K FILE | PATH | <tag> | <key>=<tag>] Add an expanded token or fixed tag to every output line.\n"
+            "  [-k <ms>[,collapse][,fields=<key>+<key>] | help] Drop repeated events within a time window.\n"
             "  [-C native | si | customary] Convert units in decoded output.\n"
             "  [-n <value>] Specify number of samples to take (each sample is an I/Q pair)\n"
             "  [-T <seconds>] Specify number of seconds to run, also 12:34 or 1h23m45s\n"
@@ -189,7 +196,7 @@ static void usage(int exit_code)
 }
 
 _Noreturn
-static void help_protocols(r_device *devices, unsigned num_devices, int exit_code)
+static void help_protocols(r_device *const *devices, unsigned num_devices, int exit_code)
 {
     unsigned i;
     char disabledc;
@@ -197,9 +204,9 @@ static void help_protocols(r_device *devices, unsigned num_devices, int exit_cod
     if (devices) {
         term_help_printf("\t\t= Supported device protocols =\n");
         for (i = 0; i < num_devices; i++) {
-            disabledc = devices[i].disabled ? '*' : ' ';
-            if (devices[i].disabled <= 2) // if not hidden
-                fprintf(stderr, "    [%02u]%c %s\n", i + 1, disabledc, devices[i].name);
+            disabledc = devices[i]->disabled ? '*' : ' ';
+            if (devices[i]->disabled <= 2) // if not hidden
+                fprintf(stderr, "    [%02u]%c %s\n", i + 1, disabledc, devices[i]->name);
         }
         fprintf(stderr, "\n* Disabled by default, use -R n or a conf file to enable\n");
     }
@@ -228,7 +235,9 @@ static void help_device(void)
             "  [-d driver=rtlsdr] Open e.g. specific SoapySDR device\n"
             "\tTo set gain for SoapySDR use -g ELEM=val,ELEM=val,... e.g. -g LNA=20,TIA=8,PGA=2 (for LimeSDR).\n"
             "  [-d rtl_tcp[:[//]host[:port]] (default: localhost:1234)\n"
-            "\tSpecify host/port to connect to with e.g. -d rtl_tcp:127.0.0.1:1234\n");
+            "\tSpecify host/port to connect to with e.g. -d rtl_tcp:127.0.0.1:1234\n"
+            "\tAdd rtl_tcp options with e.g. -d rtl_tcp:127.0.0.1:1234,buffers=32,rcvbuf=8M\n"
+            "\t  buffers=<n> read-ahead buffers (default: 15), rcvbuf=<bytes> socket receive buffer (default: 4M)\n");
     exit(0);
 }
 
@@ -254,7 +263,7 @@ static void help_output(void)
             "\tAppend output to file with :<filename> (e.g. -F csv:log.csv), defaults to stdout.\n"
             "\tSpecify MQTT server with e.g. -F mqtt://localhost:1883\n"
             "\tAdd MQTT options with e.g. -F \"mqtt://host:1883,opt=arg\"\n"
-            "\tMQTT options are: user=foo, pass=bar, retain[=0|1], <format>[=topic]\n"
+            "\tMQTT options are: user=foo, pass=bar, retain[=0|1], qos=<0|1>, window=<n> (default: 20), <format>[=topic]\n"
             "\tSupported MQTT formats: (default is all)\n"
             "\t  events: posts JSON event data\n"
             "\t  states: posts JSON state data\n"
@@ -265,8 +274,15 @@ static void help_output(void)
             "\tIf you use multiple RTL-SDR, perhaps set a serial and select by that (helps not to get the wrong antenna).\n"
             "\tSpecify InfluxDB 2.0 server with e.g. -F \"influx://localhost:9999/api/v2/write?org=<org>&bucket=<bucket>,token=<authtoken>\"\n"
             "\tSpecify InfluxDB 1.x server with e.g. -F \"influx://localhost:8086/write?db=<db>&p=<password>&u=<user>\"\n"
+            "\t  InfluxDB options are: token=<authtoken>, batch=<bytes> (default: 64k), latency=<ms> (default: 1000),\n"
+            "\t  gzip[=0|1], spool=<file> to keep data while the server is down, spool_max=<bytes> (default: 10M)\n"
             "\t  Additional parameter -M time:unix:usec:utc for correct timestamps in InfluxDB recommended\n"
-            "\tSpecify host/port for syslog with e.g. -F syslog:127.0.0.1:1514\n");
+            "\tSpecify host/port for syslog with e.g. -F syslog:127.0.0.1:1514\n"
+            "\t  Syslog options are: batch=<n> datagrams per send (default: 1), latency=<ms> (default: 100),\n"
+            "\t  lines[=0|1] to send newline separated events in each datagram\n"
+            "\tServe the raw samples to rtl_tcp clients with e.g. -F rtl_tcp:0.0.0.0:1234\n"
+            "\t  rtl_tcp options are: clients=<n> concurrent clients (default: 8),\n"
+            "\t  lag=drop|disconnect for clients that fall behind (default: drop)\n");
     exit(0);
 }
 
@@ -291,12 +307,28 @@ static void help_tags(void)
     exit(0);
 }
 
+_Noreturn
+static void help_dedup(void)
+{
+    term_help_printf(
+            "\t\t= De-duplication option =\n"
+            "  [-k <ms>[,collapse][,fields=<key>+<key>]] Drop repeated events within a time window.\n"
+            "\tEvents are repeats if the model, id, channel, and all fields except meta data (time, mod, freq, rssi, snr, noise) match.\n"
+            "\tThe window (default: 1000 ms of sample time) restarts with each repeat.\n"
+            "\tPulse files (.ook, .pbin) use the package offsets as sample time, older .ook files without offsets the package lengths.\n"
+            "\t\t\"-k 2000\" (drop repeats within 2 seconds)\n"
+            "\t\t\"-k 1000,collapse\" (output one event after the window, with a \"dedup_count\" of copies)\n"
+            "\t\t\"-k 1000,fields=temperature_C+humidity\" (compare only model, id, channel, and these fields)\n"
+            "\tUse \"-M stats\" to report the hit rate and table size.\n");
+    exit(0);
+}
+
 _Noreturn
 static void help_meta(void)
 {
     term_help_printf(
             "\t\t= Meta information option =\n"
-            "  [-M time[:<options>]|protocol|level|noise[:<secs>]|stats|bits] Add various metadata to every output line.\n"
+            "  [-M time[:<options>]|protocol|level|noise[:<secs>]|stats|latency|bits] Add various metadata to every output line.\n"
             "\tUse \"time\" to add current date and time meta data (preset for live inputs).\n"
             "\tUse \"time:rel\" to add sample position meta data (preset for read-file and stdin).\n"
             "\tUse \"time:unix\" to show the seconds since unix epoch as time meta data.\n"
@@ -313,6 +345,7 @@ static void help_meta(void)
             "\tUse \"noise[:secs]\" to report estimated noise level at intervals (default: 10 seconds).\n"
             "\tUse \"stats[:[<level>][:<interval>]]\" to report statistics (default: 600 seconds).\n"
             "\t  level 0: no report, 1: report successful devices, 2: report active devices, 3: report all\n"
+            "\tUse \"latency\" to add the time from the end of the transmission to the output in microseconds.\n"
             "\tUse \"bits\" to add bit representation to code outputs (for debug).\n");
     exit(0);
 }
@@ -330,12 +363,20 @@ static void help_read(void)
             "\t'sps', 'ksps', 'Msps', or 'Gsps'.\n\n"
             "\tFile content and format are detected as parameters, possible options are:\n"
             "\t'cu8', 'cs16', 'cf32' ('IQ' implied), and 'am.s16'.\n\n"
+            "\tA SigMF recording (.sigmf-meta) is read with its format, sample rate, and frequency,\n"
+            "\tif it is annotated only the annotated regions are read.\n\n"
+            "\tA binary pulse file (.pbin) is replayed without demodulation, as with 'ook'.\n\n"
             "\tParameters must be separated by non-alphanumeric chars and are case-insensitive.\n"
             "\tOverrides can be prefixed, separated by colon (':')\n\n"
             "\tE.g. default detection by extension: path/filename.am.s16\n"
             "\tforced overrides: am:s16:path/filename.ext\n\n"
             "\tReading from pipes also support format options.\n"
-            "\tE.g reading complex 32-bit float: CU32:-\n");
+            "\tE.g reading complex 32-bit float: CU32:-\n\n"
+            "\tUse \"-j <jobs>\" to read many input files in parallel worker processes,\n"
+            "\tevents are output as they arrive, or in the order of the files with \"-j <jobs>,ordered\".\n"
+            "\tE.g. -j 8 -K FILE -F json:events.json *.cu8\n"
+            "\tUse \"-j <jobs>,split\" to also split long I/Q files at silent gaps,\n"
+            "\tthe events of the parts are output in order.\n");
     exit(0);
 }
 
@@ -351,6 +392,14 @@ static void help_write(void)
             "\t'cu8', 'cs8', 'cs16', 'cf32' ('IQ' implied),\n"
             "\t'am.s16', 'am.f32', 'fm.s16', 'fm.f32',\n"
             "\t'i.f32', 'q.f32', 'logic.u8', 'ook', and 'vcd'.\n\n"
+            "\tUse 'burst' to append only the I/Q samples of detected bursts to a store,\n"
+            "\twith time, frequency, sample rate, levels and decoded models, and an index (.idx).\n"
+            "\tThe store can be read back with \"-r\", e.g. -w bursts.burst and -r bursts.burst\n\n"
+            "\tUse 'sigmf' to record I/Q samples as SigMF dataset and metadata files,\n"
+            "\twith annotations for all detected packages and the models decoded from them.\n"
+            "\tE.g. -w rec.sigmf writes rec.sigmf-data and rec.sigmf-meta\n\n"
+            "\tUse 'pbin' to append detected pulse data in a compact binary format with an index (.idx),\n"
+            "\tlike 'ook' but lossless and much faster to read back, e.g. -w pulses.pbin and -r pulses.pbin\n\n"
             "\tParameters must be separated by non-alphanumeric chars and are case-insensitive.\n"
             "\tOverrides can be prefixed, separated by colon (':')\n\n"
             "\tE.g. default detection by extension: path/filename.am.s16\n"
@@ -358,6 +407,137 @@ static void help_write(void)
     exit(0);
 }
 
+/// Keep the levels of the strongest package in the current frame.
+static void update_frame_levels(struct dm_state *demod, pulse_data_t const *pulses, int new_frame)
+{
+    if (new_frame || pulses->rssi_db > demod->frame_rssi_db) {
+        demod->frame_rssi_db  = pulses->rssi_db;
+        demod->frame_snr_db   = pulses->snr_db;
+        demod->frame_noise_db = pulses->noise_db;
+    }
+}
+
+/// Annotate a package in all SigMF recordings with the models decoded from it.
+static void annotate_package(struct dm_state *demod, pulse_data_t const *pulses, char const *type)
+{
+    for (void **iter = demod->sigmf_writers.elems; iter && *iter; ++iter) {
+        sigmf_writer_annotate(*iter, pulses->start_ago, pulses->end_ago, demod->package_models, type);
+    }
+    demod->package_models[0] = '\0';
+}
+
+/// Append the samples of the current frame to all burst stores.
+static void store_burst(r_cfg_t *cfg, unsigned grab_len, unsigned grab_end)
+{
+    struct dm_state *demod = cfg->demod;
+    char const *samples = NULL;
+    unsigned len = samp_grab_range(demod->samp_grab, grab_len, grab_end, &samples);
+    if (!len)
+        return;
+
+    burst_info_t info = {0};
+    info.num_samples      = len / demod->sample_size;
+    uint64_t ago_us       = (uint64_t)(info.num_samples + grab_end) * 1000000 / cfg->samp_rate;
+    info.time_us          = (uint64_t)demod->now.tv_sec * 1000000 + demod->now.tv_usec - ago_us;
+    info.center_frequency = cfg->center_frequency;
+    info.sample_rate      = cfg->samp_rate;
+    info.format           = demod->sample_size == 2 ? CU8_IQ : CS16_IQ;
+    info.rssi_db          = demod->frame_rssi_db;
+    info.snr_db           = demod->frame_snr_db;
+    info.noise_db         = demod->frame_noise_db;
+    info.events           = demod->frame_event_count;
+    memcpy(info.models, demod->frame_models, sizeof(info.models));
+
+    for (void **iter = demod->burst_stores.elems; iter && *iter; ++iter) {
+        if (burst_store_write(*iter, &info, samples, len, NULL, 0)) {
+            fprintf(stderr, "Short write, bursts lost, exiting!\n");
+            cfg->exit_async = 1;
+        }
+    }
+}
+
+/// Append a package to all binary pulse files.
+static void write_pulses(r_cfg_t *cfg, pulse_data_t const *pulses)
+{
+    for (void **iter = cfg->demod->pulse_writers.elems; iter && *iter; ++iter) {
+        if (pulse_bin_write(*iter, pulses)) {
+            fprintf(stderr, "Short write, pulses lost, exiting!\n");
+            cfg->exit_async = 1;
+        }
+    }
+}
+
+/// Start times of running the decoders, with the time spent in the outputs so far.
+typedef struct decode_mark {
+    double cpu;
+    double cpu_output;
+    double wall;
+    double wall_output;
+} decode_mark_t;
+
+static decode_mark_t start_decode_stage(r_cfg_t *cfg, double cpu_start)
+{
+    decode_mark_t mark = {
+            .cpu         = cpu_start,
+            .cpu_output  = cfg->metrics.stage_seconds[METRICS_STAGE_OUTPUT],
+            .wall        = metrics_wall_time(),
+            .wall_output = cfg->metrics.output_wall_seconds,
+    };
+    return mark;
+}
+
+/// Add the CPU time and latency of running the decoders, the outputs called from the decoders are accounted separately.
+static void end_decode_stage(r_cfg_t *cfg, decode_mark_t const *mark)
+{
+    pipeline_metrics_t *metrics = &cfg->metrics;
+    metrics_stage_end(metrics, METRICS_STAGE_DECODE, mark->cpu);
+    metrics->stage_seconds[METRICS_STAGE_DECODE] -= metrics->stage_seconds[METRICS_STAGE_OUTPUT] - mark->cpu_output;
+    double wall = metrics_wall_time() - mark->wall - (metrics->output_wall_seconds - mark->wall_output);
+    metrics_latency_add(metrics, METRICS_LATENCY_DECODE, wall);
+}
+
+/// Estimate the wall clock time at the end of a package from the buffer arrival, add the latency to its detection.
+static void trace_package(r_cfg_t *cfg, pulse_data_t *pulses, double arrival)
+{
+    // the end of package is detected after the trailing gap
+    unsigned trailing_gap = pulses->num_pulses && pulses->gap[pulses->num_pulses - 1] > 0 ? pulses->gap[pulses->num_pulses - 1] : 0;
+    pulses->end_time = arrival - (double)(pulses->end_ago + trailing_gap) / cfg->samp_rate;
+    metrics_latency_add(&cfg->metrics, METRICS_LATENCY_EOP, metrics_wall_time() - pulses->end_time);
+}
+
+/// Size the demodulation buffers for a sample buffer, they only grow if the buffer length changes.
+static void reserve_demod_buffers(struct dm_state *demod, unsigned long n_samples)
+{
+    if (n_samples <= demod->buf_samples)
+        return;
+
+    // the contents are not kept, the buffers are filled anew for each sample buffer
+    free(demod->am_buf);
+    demod->am_buf = malloc(n_samples * sizeof(*demod->am_buf));
+    if (!demod->am_buf)
+        FATAL_MALLOC("reserve_demod_buffers()");
+    free(demod->buf.fm);
+    demod->buf.fm = malloc(n_samples * sizeof(*demod->buf.fm));
+    if (!demod->buf.fm)
+        FATAL_MALLOC("reserve_demod_buffers()");
+    demod->buf_samples = (unsigned)n_samples;
+}
+
+/// Grow a dumper buffer to at least @p size bytes, the contents are not kept.
+static uint8_t *reserve_dumper_buffer(uint8_t **buf, size_t *buf_size, size_t size)
+{
+    if (size > *buf_size) {
+        free(*buf);
+        *buf = malloc(size);
+        if (!*buf)
+            FATAL_MALLOC("reserve_dumper_buffer()");
+        *buf_size = size;
+    }
+    return *buf;
+}
+
+static void reload_swap(r_cfg_t *cfg);
+
 static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
 {
     r_cfg_t *cfg = ctx;
@@ -365,20 +545,28 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
     char time_str[LOCAL_TIME_BUFLEN];
     unsigned long n_samples;
 
+    if ((cfg->bytes_to_read > 0) && (cfg->bytes_to_read <= len)) {
+        len = cfg->bytes_to_read;
+        cfg->exit_async = 1;
+    }
+
+    // the samples are written once, the grabber and raw outputs read from the ring
+    if (demod->sample_ring) {
+        ring_buf_write(demod->sample_ring, iq_buf, len);
+    }
+
     // do this here and not in sdr_handler so realtime replay can use rtl_tcp output
     for (void **iter = cfg->raw_handler.elems; iter && *iter; ++iter) {
         raw_output_t *output = *iter;
         raw_output_frame(output, iq_buf, len);
     }
 
-    if ((cfg->bytes_to_read > 0) && (cfg->bytes_to_read <= len)) {
-        len = cfg->bytes_to_read;
-        cfg->exit_async = 1;
-    }
-
     // save last frame time to see if a new second started
     time_t last_frame_sec = demod->now.tv_sec;
     get_time_now(&demod->now);
+    // input files and sources without a receive time arrive just now
+    double arrival = demod->buffer_arrival ? demod->buffer_arrival : demod->now.tv_sec + demod->now.tv_usec / 1e6;
+    demod->buffer_arrival = 0;
 
     n_samples = len / demod->sample_size;
     if (n_samples * demod->sample_size != len) {
@@ -388,6 +576,7 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
         fprintf(stderr, "Sample buffer too short!\n");
         return; // keep the watchdog timer running
     }
+    reserve_demod_buffers(demod, n_samples);
 
     // age the frame position if there is one
     if (demod->frame_start_ago)
@@ -397,11 +586,22 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
 
     alarm(3); // require callback to run every 3 second, abort otherwise
 
-    if (demod->samp_grab) {
-        samp_grab_push(demod->samp_grab, iq_buf, len);
+    if (!cfg->metrics.buffers)
+        cfg->metrics.startup_seconds = metrics_wall_time() - cfg->metrics.start_time;
+    cfg->metrics.buffers++;
+    cfg->metrics.samples += n_samples;
+    double buffer_start = metrics_cpu_time();
+
+    for (void **iter = demod->sigmf_writers.elems; iter && *iter; ++iter) {
+        uint32_t format = demod->sample_size == 2 ? CU8_IQ : CS16_IQ;
+        if (sigmf_writer_write(*iter, iq_buf, len, format, cfg->samp_rate, cfg->center_frequency)) {
+            fprintf(stderr, "Short write, samples lost, exiting!\n");
+            cfg->exit_async = 1;
+        }
     }
 
     // AM demodulation
+    double demod_start = metrics_cpu_time();
     float avg_db;
     if (demod->sample_size == 2) { // CU8
         if (demod->use_mag_est) {
@@ -438,6 +638,9 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
     } else {
         demod->noise_level = (demod->noise_level * 31 + avg_db) / 32; // slow rise over 32 frames
     }
+    cfg->metrics.noise_db = demod->noise_level;
+    if (!process_frame)
+        cfg->metrics.buffers_squelched++;
     // Report noise every report_noise seconds, but only for the first frame that second
     if (cfg->report_noise && last_frame_sec != demod->now.tv_sec && demod->now.tv_sec % cfg->report_noise == 0) {
         fprintf(stderr, "Current %s level %.1f dB, estimated noise %.1f dB\n",
@@ -468,16 +671,18 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
 
     // Handle special input formats
     if (demod->load_info.format == S16_AM) { // The IQ buffer is really AM demodulated data
-        if (len > sizeof(demod->am_buf))
+        if (len > demod->buf_samples * sizeof(*demod->am_buf))
             FATAL("Buffer too small");
         memcpy(demod->am_buf, iq_buf, len);
     } else if (demod->load_info.format == S16_FM) { // The IQ buffer is really FM demodulated data
         // we would need AM for the envelope too
-        if (len > sizeof(demod->buf.fm))
+        if (len > demod->buf_samples * sizeof(*demod->buf.fm))
             FATAL("Buffer too small");
         memcpy(demod->buf.fm, iq_buf, len);
     }
 
+    metrics_stage_end(&cfg->metrics, METRICS_STAGE_DEMOD, demod_start);
+
     int d_events = 0; // Sensor events successfully detected
     if (demod->r_devs.len || demod->analyze_pulses || demod->dumper.len || demod->samp_grab) {
         // Detect a package and loop through demodulators with pulse data
@@ -485,13 +690,17 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
         for (void **iter = demod->dumper.elems; iter && *iter; ++iter) {
             file_info_t const *dumper = *iter;
             if (dumper->format == U8_LOGIC) {
+                reserve_dumper_buffer(&demod->u8_buf, &demod->u8_buf_size, n_samples);
                 memset(demod->u8_buf, 0, n_samples);
                 break;
             }
         }
         while (package_type && process_frame) {
             int p_events = 0; // Sensor events successfully detected per package
+            double detect_start = metrics_cpu_time();
             package_type = pulse_detect_package(demod->pulse_detect, demod->am_buf, demod->buf.fm, n_samples, cfg->samp_rate, cfg->input_pos, &demod->pulse_data, &demod->fsk_pulse_data, fpdm);
+            decode_mark_t decode_mark = start_decode_stage(cfg, metrics_stage_end(&cfg->metrics, METRICS_STAGE_DETECT, detect_start));
+            int new_frame = !demod->frame_start_ago;
             if (package_type) {
                 // new package: set a first frame start if we are not tracking one already
                 if (!demod->frame_start_ago)
@@ -500,12 +709,18 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
                 demod->frame_end_ago = demod->pulse_data.end_ago;
             }
             if (package_type == PULSE_DATA_OOK) {
+                trace_package(cfg, &demod->pulse_data, arrival);
                 calc_rssi_snr(cfg, &demod->pulse_data);
+                update_frame_levels(demod, &demod->pulse_data, new_frame);
                 if (demod->analyze_pulses) fprintf(stderr, "Detected OOK package\t%s\n", time_pos_str(cfg, demod->pulse_data.start_ago, time_str));
 
                 p_events += run_ook_demods(&demod->r_devs, &demod->pulse_data);
+                end_decode_stage(cfg, &decode_mark);
+                cfg->metrics.packages_ook++;
+                metrics_histogram_observe(&cfg->metrics.package_pulses, demod->pulse_data.num_pulses);
                 cfg->frames_count++;
                 cfg->frames_events += p_events > 0;
+                annotate_package(demod, &demod->pulse_data, "OOK");
 
                 for (void **iter = demod->dumper.elems; iter && *iter; ++iter) {
                     file_info_t const *dumper = *iter;
@@ -513,6 +728,7 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
                     if (dumper->format == U8_LOGIC) pulse_data_dump_raw(demod->u8_buf, n_samples, cfg->input_pos, &demod->pulse_data, 0x02);
                     if (dumper->format == PULSE_OOK) pulse_data_dump(dumper->file, &demod->pulse_data);
                 }
+                write_pulses(cfg, &demod->pulse_data);
 
                 if (cfg->verbosity > 2) pulse_data_print(&demod->pulse_data);
                 if (cfg->raw_mode == 1 || (cfg->raw_mode == 2 && p_events == 0) || (cfg->raw_mode == 3 && p_events > 0)) {
@@ -524,12 +740,18 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
                 }
 
             } else if (package_type == PULSE_DATA_FSK) {
+                trace_package(cfg, &demod->fsk_pulse_data, arrival);
                 calc_rssi_snr(cfg, &demod->fsk_pulse_data);
+                update_frame_levels(demod, &demod->fsk_pulse_data, new_frame);
                 if (demod->analyze_pulses) fprintf(stderr, "Detected FSK package\t%s\n", time_pos_str(cfg, demod->fsk_pulse_data.start_ago, time_str));
 
                 p_events += run_fsk_demods(&demod->r_devs, &demod->fsk_pulse_data);
+                end_decode_stage(cfg, &decode_mark);
+                cfg->metrics.packages_fsk++;
+                metrics_histogram_observe(&cfg->metrics.package_pulses, demod->fsk_pulse_data.num_pulses);
                 cfg->frames_fsk++;
                 cfg->frames_events += p_events > 0;
+                annotate_package(demod, &demod->fsk_pulse_data, "FSK");
 
                 for (void **iter = demod->dumper.elems; iter && *iter; ++iter) {
                     file_info_t const *dumper = *iter;
@@ -537,6 +759,7 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
                     if (dumper->format == U8_LOGIC) pulse_data_dump_raw(demod->u8_buf, n_samples, cfg->input_pos, &demod->fsk_pulse_data, 0x04);
                     if (dumper->format == PULSE_OOK) pulse_data_dump(dumper->file, &demod->fsk_pulse_data);
                 }
+                write_pulses(cfg, &demod->fsk_pulse_data);
 
                 if (cfg->verbosity > 2) pulse_data_print(&demod->fsk_pulse_data);
                 if (cfg->raw_mode == 1 || (cfg->raw_mode == 2 && p_events == 0) || (cfg->raw_mode == 3 && p_events > 0)) {
@@ -556,18 +779,22 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
         // end frame tracking if older than a whole buffer
         if (demod->frame_start_ago && demod->frame_end_ago > n_samples) {
             if (demod->samp_grab) {
+                unsigned frame_pad = n_samples / 8; // this could also be a fixed value, e.g. 10000 samples
+                unsigned start_padded = demod->frame_start_ago + frame_pad;
+                unsigned end_padded = demod->frame_end_ago - frame_pad;
+                unsigned len_padded = start_padded - end_padded;
                 if (cfg->grab_mode == 1
                         || (cfg->grab_mode == 2 && demod->frame_event_count == 0)
                         || (cfg->grab_mode == 3 && demod->frame_event_count > 0)) {
-                    unsigned frame_pad = n_samples / 8; // this could also be a fixed value, e.g. 10000 samples
-                    unsigned start_padded = demod->frame_start_ago + frame_pad;
-                    unsigned end_padded = demod->frame_end_ago - frame_pad;
-                    unsigned len_padded = start_padded - end_padded;
                     samp_grab_write(demod->samp_grab, len_padded, end_padded);
                 }
+                if (demod->burst_stores.len) {
+                    store_burst(cfg, len_padded, end_padded);
+                }
             }
             demod->frame_start_ago = 0;
             demod->frame_event_count = 0;
+            demod->frame_models[0] = '\0';
         }
 
         // dump partial pulse_data for this buffer
@@ -593,45 +820,47 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
             continue;
         uint8_t *out_buf = iq_buf;  // Default is to dump IQ samples
         unsigned long out_len = n_samples * demod->sample_size;
+        uint8_t **conv_buf = &demod->conv_buf; // format conversion buffer, allocated on first use
+        size_t *conv_size  = &demod->conv_buf_size;
 
         if (dumper->format == CU8_IQ) {
             if (demod->sample_size == 4) {
+                out_buf = reserve_dumper_buffer(conv_buf, conv_size, n_samples * 2 * sizeof(uint8_t));
                 for (unsigned long n = 0; n < n_samples * 2; ++n)
-                    ((uint8_t *)demod->buf.temp)[n] = (((int16_t *)iq_buf)[n] / 256) + 128; // scale Q0.15 to Q0.7
-                out_buf = (uint8_t *)demod->buf.temp;
+                    out_buf[n] = (((int16_t *)iq_buf)[n] / 256) + 128; // scale Q0.15 to Q0.7
                 out_len = n_samples * 2 * sizeof(uint8_t);
             }
         }
         else if (dumper->format == CS16_IQ) {
             if (demod->sample_size == 2) {
+                out_buf = reserve_dumper_buffer(conv_buf, conv_size, n_samples * 2 * sizeof(int16_t));
                 for (unsigned long n = 0; n < n_samples * 2; ++n)
-                    ((int16_t *)demod->buf.temp)[n] = (iq_buf[n] * 256) - 32768; // scale Q0.7 to Q0.15
-                out_buf = (uint8_t *)demod->buf.temp; // this buffer is too small if out_block_size is large
+                    ((int16_t *)out_buf)[n] = (iq_buf[n] * 256) - 32768; // scale Q0.7 to Q0.15
                 out_len = n_samples * 2 * sizeof(int16_t);
             }
         }
         else if (dumper->format == CS8_IQ) {
+            out_buf = reserve_dumper_buffer(conv_buf, conv_size, n_samples * 2 * sizeof(int8_t));
             if (demod->sample_size == 2) {
                 for (unsigned long n = 0; n < n_samples * 2; ++n)
-                    ((int8_t *)demod->buf.temp)[n] = (iq_buf[n] - 128);
+                    ((int8_t *)out_buf)[n] = (iq_buf[n] - 128);
             }
             else if (demod->sample_size == 4) {
                 for (unsigned long n = 0; n < n_samples * 2; ++n)
-                    ((int8_t *)demod->buf.temp)[n] = ((int16_t *)iq_buf)[n] >> 8;
+                    ((int8_t *)out_buf)[n] = ((int16_t *)iq_buf)[n] >> 8;
             }
-            out_buf = (uint8_t *)demod->buf.temp;
             out_len = n_samples * 2 * sizeof(int8_t);
         }
         else if (dumper->format == CF32_IQ) {
+            out_buf = reserve_dumper_buffer(conv_buf, conv_size, n_samples * 2 * sizeof(float));
             if (demod->sample_size == 2) {
                 for (unsigned long n = 0; n < n_samples * 2; ++n)
-                    ((float *)demod->buf.temp)[n] = (iq_buf[n] - 128) / 128.0f;
+                    ((float *)out_buf)[n] = (iq_buf[n] - 128) / 128.0f;
             }
             else if (demod->sample_size == 4) {
                 for (unsigned long n = 0; n < n_samples * 2; ++n)
-                    ((float *)demod->buf.temp)[n] = ((int16_t *)iq_buf)[n] / 32768.0f;
+                    ((float *)out_buf)[n] = ((int16_t *)iq_buf)[n] / 32768.0f;
             }
-            out_buf = (uint8_t *)demod->buf.temp; // this buffer is too small if out_block_size is large
             out_len = n_samples * 2 * sizeof(float);
         }
         else if (dumper->format == S16_AM) {
@@ -643,35 +872,35 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
             out_len = n_samples * sizeof(int16_t);
         }
         else if (dumper->format == F32_AM) {
+            out_buf = reserve_dumper_buffer(conv_buf, conv_size, n_samples * sizeof(float));
             for (unsigned long n = 0; n < n_samples; ++n)
-                demod->f32_buf[n] = demod->am_buf[n] * (1.0f / 0x8000); // scale from Q0.15
-            out_buf = (uint8_t *)demod->f32_buf;
+                ((float *)out_buf)[n] = demod->am_buf[n] * (1.0f / 0x8000); // scale from Q0.15
             out_len = n_samples * sizeof(float);
         }
         else if (dumper->format == F32_FM) {
+            out_buf = reserve_dumper_buffer(conv_buf, conv_size, n_samples * sizeof(float));
             for (unsigned long n = 0; n < n_samples; ++n)
-                demod->f32_buf[n] = demod->buf.fm[n] * (1.0f / 0x8000); // scale from Q0.15
-            out_buf = (uint8_t *)demod->f32_buf;
+                ((float *)out_buf)[n] = demod->buf.fm[n] * (1.0f / 0x8000); // scale from Q0.15
             out_len = n_samples * sizeof(float);
         }
         else if (dumper->format == F32_I) {
+            out_buf = reserve_dumper_buffer(conv_buf, conv_size, n_samples * sizeof(float));
             if (demod->sample_size == 2)
                 for (unsigned long n = 0; n < n_samples; ++n)
-                    demod->f32_buf[n] = (iq_buf[n * 2] - 128) * (1.0f / 0x80); // scale from Q0.7
+                    ((float *)out_buf)[n] = (iq_buf[n * 2] - 128) * (1.0f / 0x80); // scale from Q0.7
             else
                 for (unsigned long n = 0; n < n_samples; ++n)
-                    demod->f32_buf[n] = ((int16_t *)iq_buf)[n * 2] * (1.0f / 0x8000); // scale from Q0.15
-            out_buf = (uint8_t *)demod->f32_buf;
+                    ((float *)out_buf)[n] = ((int16_t *)iq_buf)[n * 2] * (1.0f / 0x8000); // scale from Q0.15
             out_len = n_samples * sizeof(float);
         }
         else if (dumper->format == F32_Q) {
+            out_buf = reserve_dumper_buffer(conv_buf, conv_size, n_samples * sizeof(float));
             if (demod->sample_size == 2)
                 for (unsigned long n = 0; n < n_samples; ++n)
-                    demod->f32_buf[n] = (iq_buf[n * 2 + 1] - 128) * (1.0f / 0x80); // scale from Q0.7
+                    ((float *)out_buf)[n] = (iq_buf[n * 2 + 1] - 128) * (1.0f / 0x80); // scale from Q0.7
             else
                 for (unsigned long n = 0; n < n_samples; ++n)
-                    demod->f32_buf[n] = ((int16_t *)iq_buf)[n * 2 + 1] * (1.0f / 0x8000); // scale from Q0.15
-            out_buf = (uint8_t *)demod->f32_buf;
+                    ((float *)out_buf)[n] = ((int16_t *)iq_buf)[n * 2 + 1] * (1.0f / 0x8000); // scale from Q0.15
             out_len = n_samples * sizeof(float);
         }
         else if (dumper->format == U8_LOGIC) { // state data
@@ -686,6 +915,9 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
     }
 
     cfg->input_pos += n_samples;
+    if (cfg->dedup)
+        flush_dedup_data(cfg, 0);
+    metrics_histogram_observe(&cfg->metrics.buffer_seconds, metrics_cpu_time() - buffer_start);
     if (cfg->bytes_to_read > 0)
         cfg->bytes_to_read -= len;
 
@@ -722,6 +954,9 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
             cfg->stats_now--;
     }
 
+    // between buffers no package is being decoded, swap in the decoders and outputs of a reload here
+    reload_swap(cfg);
+
     if (cfg->hop_now && !cfg->exit_async) {
         cfg->hop_now = 0;
         time(&cfg->hop_start_time);
@@ -744,7 +979,81 @@ static int hasopt(int test, int argc, char *argv[], char const *optstring)
 
 static void parse_conf_option(r_cfg_t *cfg, int opt, char *arg);
 
-#define OPTSTRING "hVvqDc:x:z:p:a:AI:S:m:M:r:w:W:l:d:t:f:H:g:s:b:n:R:X:F:K:C:T:UGy:E:Y:"
+/// Copy of the command line as given, the parsers change the args in place.
+static list_t conf_args;
+/// An output and its -F option, to keep unchanged outputs on reload.
+typedef struct output_arg {
+    char *arg;   ///< the option as given
+    char *param; ///< a copy for the output, which may change it and keep pointers into it
+} output_arg_t;
+/// The output_arg of each entry in cfg->output_handler.
+static list_t output_args;
+/// The outputs and output_args of the previous config while reloading, taken entries are set to NULL.
+static list_t reload_outputs;
+static list_t reload_output_args;
+static int reloading;
+static int reload_checking; ///< only check the decoder and output options while reloading
+static int reload_errors;   ///< count of errors in the options while reloading
+/// The decoders and outputs of a config, with the output_args of the outputs.
+typedef struct reload_lists {
+    list_t r_devs;
+    list_t output_handler;
+    list_t output_args;
+    int enable_FM_demod;
+} reload_lists_t;
+/// The lists prepared by reload_prepare() if reload_ready, and those swapped out by reload_swap().
+static reload_lists_t reload_next;
+static reload_lists_t reload_prev;
+static int reload_ready;
+
+static void free_output_arg(output_arg_t *output_arg)
+{
+    if (!output_arg)
+        return;
+    free(output_arg->arg);
+    free(output_arg->param);
+    free(output_arg);
+}
+
+/// Free the command line copy and the output args at exit.
+static void free_conf_args(void)
+{
+    list_free_elems(&conf_args, free);
+    list_free_elems(&output_args, (list_elem_free_fn)free_output_arg);
+}
+
+/// Record the -F option of a new output, returns the copy to give to the output.
+static char *push_output_arg(char const *arg)
+{
+    output_arg_t *output_arg = calloc(1, sizeof(*output_arg));
+    if (!output_arg)
+        FATAL_CALLOC("push_output_arg()");
+    output_arg->arg = strdup(arg);
+    if (!output_arg->arg)
+        FATAL_STRDUP("push_output_arg()");
+    output_arg->param = strdup(arg);
+    if (!output_arg->param)
+        FATAL_STRDUP("push_output_arg()");
+    list_push(&output_args, output_arg);
+    return output_arg->param;
+}
+
+/// Take over an output with the same -F option from the previous config.
+static int reuse_output(r_cfg_t *cfg, char const *arg)
+{
+    for (size_t i = 0; i < reload_output_args.len; ++i) {
+        output_arg_t *output_arg = reload_output_args.elems[i];
+        if (output_arg && !strcmp(output_arg->arg, arg)) {
+            reload_output_args.elems[i] = NULL; // taken
+            list_push(&cfg->output_handler, reload_outputs.elems[i]);
+            list_push(&output_args, output_arg);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+#define OPTSTRING "hVvqDc:x:z:p:a:AI:S:m:M:r:j:w:W:l:d:t:f:H:g:s:b:n:R:X:F:K:k:C:T:UGy:E:Y:"
 
 // these should match the short options exactly
 static struct conf_keywords const conf_keywords[] = {
@@ -770,6 +1079,7 @@ static struct conf_keywords const conf_keywords[] = {
         {"analyze_pulses", 'A'},
         {"include_only", 'I'},
         {"read_file", 'r'},
+        {"jobs", 'j'},
         {"write_file", 'w'},
         {"overwrite_file", 'W'},
         {"signal_grabber", 'S'},
@@ -778,6 +1088,7 @@ static struct conf_keywords const conf_keywords[] = {
         {"pulse_detect", 'Y'},
         {"output", 'F'},
         {"output_tag", 'K'},
+        {"dedup", 'k'},
         {"convert", 'C'},
         {"duration", 'T'},
         {"test_data", 'y'},
@@ -804,7 +1115,11 @@ static void parse_conf_file(r_cfg_t *cfg, char const *path)
         return;
 
     char *conf = readconf(path);
+    if (!conf && reloading)
+        reload_errors++; // readconf() printed the error
     parse_conf_text(cfg, conf);
+    if (reloading)
+        free(conf); // the reloaded options keep no pointers into the text
     //free(conf); // TODO: check no args are dangling, then use free
 }
 
@@ -812,9 +1127,11 @@ static void parse_conf_try_default_files(r_cfg_t *cfg)
 {
     char **paths = compat_get_default_conf_paths();
     for (int a = 0; paths[a]; a++) {
-        fprintf(stderr, "Trying conf file at \"%s\"...\n", paths[a]);
+        if (!reload_checking)
+            fprintf(stderr, "Trying conf file at \"%s\"...\n", paths[a]);
         if (hasconf(paths[a])) {
-            fprintf(stderr, "Reading conf from \"%s\".\n", paths[a]);
+            if (!reload_checking)
+                fprintf(stderr, "Reading conf from \"%s\".\n", paths[a]);
             parse_conf_file(cfg, paths[a]);
             break;
         }
@@ -833,6 +1150,35 @@ static void parse_conf_args(r_cfg_t *cfg, int argc, char *argv[])
     }
 }
 
+/// The -F output formats.
+static char const *const output_formats[] = {"json", "csv", "kv", "mqtt", "influx", "syslog", "http", "trigger", "null", "rtl_tcp", NULL};
+
+/// Check a decoder or output option without creating anything, returns -1 on errors.
+static int check_conf_option(r_cfg_t *cfg, int opt, char const *arg)
+{
+    if (opt == 'R') {
+        int n = atoi(arg);
+        if (n > cfg->num_r_devices || -n > cfg->num_r_devices
+                || (n > 0 && cfg->devices[n - 1]->disabled > 2)
+                || (n < 0 && cfg->devices[-n - 1]->disabled > 2)) {
+            fprintf(stderr, "Protocol number specified (%d) is invalid\n", n);
+            return -1;
+        }
+    }
+    else if (opt == 'X') {
+        return flex_check_spec(arg);
+    }
+    else if (opt == 'F') {
+        for (int i = 0; output_formats[i]; ++i) {
+            if (!strncmp(arg, output_formats[i], strlen(output_formats[i])))
+                return 0;
+        }
+        fprintf(stderr, "Invalid output format %s\n", arg);
+        return -1;
+    }
+    return 0;
+}
+
 static void parse_conf_option(r_cfg_t *cfg, int opt, char *arg)
 {
     int n;
@@ -842,6 +1188,19 @@ static void parse_conf_option(r_cfg_t *cfg, int opt, char *arg)
         arg = NULL; // remove the arg if it's a request for the usage help
     }
 
+    if (reloading && opt != 'c' && opt != 'R' && opt != 'X' && opt != 'F') {
+        return; // only decoders and outputs are reloaded
+    }
+    if (reloading && !arg) {
+        fprintf(stderr, "Option -%c needs an argument.\n", opt);
+        reload_errors++; // don't print the help on reload
+        return;
+    }
+    if (reload_checking && opt != 'c') {
+        reload_errors += check_conf_option(cfg, opt, arg) < 0;
+        return;
+    }
+
     switch (opt) {
     case 'h':
         usage(0);
@@ -945,6 +1304,27 @@ static void parse_conf_option(r_cfg_t *cfg, int opt, char *arg)
         add_infile(cfg, arg);
         // TODO: file_info_check_read()
         break;
+    case 'j':
+        if (!arg)
+            usage(1);
+        char *endptr = NULL;
+        cfg->batch_jobs = (int)strtol(arg, &endptr, 10);
+        while (endptr && *endptr == ',') {
+            char *flag = endptr + 1;
+            endptr     = strchr(flag, ',');
+            size_t len = endptr ? (size_t)(endptr - flag) : strlen(flag);
+            if (len == 7 && !strncasecmp(flag, "ordered", len))
+                cfg->batch_ordered = 1;
+            else if (len == 5 && !strncasecmp(flag, "split", len))
+                cfg->batch_split = 1;
+            else
+                endptr = flag; // invalid
+        }
+        if (cfg->batch_jobs < 1 || (endptr && *endptr)) {
+            fprintf(stderr, "Invalid jobs option \"%s\", use -j <jobs>[,ordered][,split]\n", arg);
+            exit(1);
+        }
+        break;
     case 'w':
         if (!arg)
             help_write();
@@ -968,8 +1348,8 @@ static void parse_conf_option(r_cfg_t *cfg, int opt, char *arg)
             cfg->grab_mode = 3;
         else
             cfg->grab_mode = atobv(arg, 1);
-        if (cfg->grab_mode && !cfg->demod->samp_grab)
-            cfg->demod->samp_grab = samp_grab_create(SIGNAL_GRABBER_BUFFER);
+        if (cfg->grab_mode)
+            add_samp_grab(cfg);
         break;
     case 'm':
         fprintf(stderr, "sample mode option is deprecated.\n");
@@ -1044,6 +1424,8 @@ static void parse_conf_option(r_cfg_t *cfg, int opt, char *arg)
             cfg->report_noise = atoiv(arg_param(arg), 10); // atoi_time_default()
         else if (!strcasecmp(arg, "bits"))
             cfg->verbose_bits = 1;
+        else if (!strcasecmp(arg, "latency"))
+            cfg->report_latency = 1;
         else if (!strcasecmp(arg, "description"))
             cfg->report_description = 1;
         else if (!strcasecmp(arg, "newmodel"))
@@ -1081,7 +1463,7 @@ static void parse_conf_option(r_cfg_t *cfg, int opt, char *arg)
             fprintf(stderr, "Protocol number specified (%d) is larger than number of protocols\n\n", n);
             help_protocols(cfg->devices, cfg->num_r_devices, 1);
         }
-        if ((n > 0 && cfg->devices[n - 1].disabled > 2) || (n < 0 && cfg->devices[-n - 1].disabled > 2)) {
+        if ((n > 0 && cfg->devices[n - 1]->disabled > 2) || (n < 0 && cfg->devices[-n - 1]->disabled > 2)) {
             fprintf(stderr, "Protocol number specified (%d) is invalid\n\n", n);
             help_protocols(cfg->devices, cfg->num_r_devices, 1);
         }
@@ -1092,10 +1474,10 @@ static void parse_conf_option(r_cfg_t *cfg, int opt, char *arg)
         cfg->no_default_devices = 1;
 
         if (n >= 1) {
-            register_protocol(cfg, &cfg->devices[n - 1], arg_param(arg));
+            register_protocol(cfg, cfg->devices[n - 1], arg_param(arg));
         }
         else if (n <= -1) {
-            unregister_protocol(cfg, &cfg->devices[-n - 1]);
+            unregister_protocol(cfg, cfg->devices[-n - 1]);
         }
         else {
             fprintf(stderr, "Disabling all device decoders.\n");
@@ -1116,6 +1498,14 @@ static void parse_conf_option(r_cfg_t *cfg, int opt, char *arg)
         if (!arg)
             help_output();
 
+        if (reloading && reuse_output(cfg, arg)) {
+            break;
+        }
+        // the rtl_tcp output is not in output_handler
+        if (strncmp(arg, "rtl_tcp", 7) != 0) {
+            arg = push_output_arg(arg);
+        }
+
         if (strncmp(arg, "json", 4) == 0) {
             add_json_output(cfg, arg_param(arg));
         }
@@ -1144,7 +1534,9 @@ static void parse_conf_option(r_cfg_t *cfg, int opt, char *arg)
             add_null_output(cfg, arg_param(arg));
         }
         else if (strncmp(arg, "rtl_tcp", 7) == 0) {
-            add_rtltcp_output(cfg, arg_param(arg));
+            // a raw output on the SDR stream, kept on reload
+            if (!reloading)
+                add_rtltcp_output(cfg, arg_param(arg));
         }
         else {
             fprintf(stderr, "Invalid output format %s\n", arg);
@@ -1156,6 +1548,11 @@ static void parse_conf_option(r_cfg_t *cfg, int opt, char *arg)
             help_tags();
         add_data_tag(cfg, arg);
         break;
+    case 'k':
+        if (!arg || !strcmp(arg, "help"))
+            help_dedup();
+        add_dedup(cfg, arg);
+        break;
     case 'C':
         if (!arg)
             usage(1);
@@ -1240,6 +1637,187 @@ static void parse_conf_option(r_cfg_t *cfg, int opt, char *arg)
     }
 }
 
+/// Check if any of the decoders needs FM demodulation.
+static int needs_fm_demod(list_t *r_devs)
+{
+    for (void **iter = r_devs->elems; iter && *iter; ++iter) {
+        r_device *r_dev = *iter;
+        if (r_dev->modulation >= FSK_DEMOD_MIN_VAL) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/// Print the number and ranges of the registered decoders.
+static void print_registered_protocols(r_cfg_t *cfg)
+{
+    struct dm_state *demod = cfg->demod;
+    char decoders_str[1024];
+    decoders_str[0] = '\0';
+    if (!cfg->verbosity) {
+        abuf_t p = {0};
+        abuf_init(&p, decoders_str, sizeof(decoders_str));
+        // print registered decoder ranges
+        abuf_printf(&p, " [");
+        for (void **iter = demod->r_devs.elems; iter && *iter; ++iter) {
+            r_device *r_dev = *iter;
+            unsigned num = r_dev->protocol_num;
+            if (num == 0)
+                continue;
+            while (iter[1]
+                    && r_dev->protocol_num + 1 == ((r_device *)iter[1])->protocol_num)
+                r_dev = *++iter;
+            if (num == r_dev->protocol_num)
+                abuf_printf(&p, " %u", num);
+            else
+                abuf_printf(&p, " %u-%u", num, r_dev->protocol_num);
+        }
+        abuf_printf(&p, " ]");
+    }
+    fprintf(stderr, "Registered %zu out of %u device decoding protocols%s\n",
+            demod->r_devs.len, cfg->num_r_devices, decoders_str);
+}
+
+/// Parse the decoder and output options of a fresh copy of the command line as given, and of the config files.
+static void reload_parse(r_cfg_t *cfg)
+{
+    list_t args = {0};
+    for (void **iter = conf_args.elems; iter && *iter; ++iter) {
+        char *arg = strdup(*iter);
+        if (!arg)
+            FATAL_STRDUP("reload_parse()");
+        list_push(&args, arg);
+    }
+    int argc    = (int)args.len;
+    char **argv = (char **)args.elems;
+
+    cfg->no_default_devices = 0;
+    reloading = 1;
+    if (!hasopt('c', argc, argv, OPTSTRING)) {
+        parse_conf_try_default_files(cfg);
+    }
+    parse_conf_args(cfg, argc, argv);
+    reloading = 0;
+    list_free_elems(&args, free); // the reloaded options keep no pointers into the args
+}
+
+/// Check the decoder and output options of the config, without creating anything, returns -1 on errors.
+static int reload_check(r_cfg_t *cfg)
+{
+    int no_default_devices = cfg->no_default_devices;
+    reload_checking = 1;
+    reload_errors   = 0;
+    reload_parse(cfg);
+    reload_checking = 0;
+    cfg->no_default_devices = no_default_devices;
+    return reload_errors ? -1 : 0;
+}
+
+/// Parse the config again into new decoders and outputs for reload_swap(), keeps the current ones on errors.
+///
+/// Outputs with an unchanged -F option are taken over, the SDR and the demodulator state are kept.
+static void reload_prepare(r_cfg_t *cfg)
+{
+    struct dm_state *demod = cfg->demod;
+
+    fprintf(stderr, "Reloading decoders and outputs...\n");
+    if (reload_check(cfg)) {
+        fprintf(stderr, "Reload failed, keeping the current decoders and outputs.\n");
+        return;
+    }
+    alarm(0); // cancel the watchdog timer, new outputs might take a while to connect
+
+    // parse into new lists, the current outputs are set aside to be taken over
+    reload_lists_t cur = {
+            .r_devs         = demod->r_devs,
+            .output_handler = cfg->output_handler,
+            .output_args    = output_args,
+    };
+    demod->r_devs       = (list_t){0};
+    cfg->output_handler = (list_t){0};
+    output_args         = (list_t){0};
+    reload_outputs      = cur.output_handler;
+    reload_output_args  = cur.output_args; // shares the elems, taken entries are set to NULL in cur
+
+    reload_parse(cfg);
+
+    if (!cfg->output_handler.len && !reuse_output(cfg, "kv")) {
+        add_kv_output(cfg, NULL);
+        push_output_arg("kv");
+    }
+    if (!cfg->no_default_devices) {
+        register_all_protocols(cfg, 0); // register all defaults
+    }
+    print_registered_protocols(cfg);
+
+    // start the new outputs, taken outputs are already running
+    char const **well_known = well_known_output_fields(cfg);
+    char const **output_fields = NULL;
+    int num_output_fields = 0;
+    for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
+        data_output_t *output = cfg->output_handler.elems[i];
+        int kept = 0;
+        for (size_t j = 0; j < reload_outputs.len; ++j) {
+            kept |= output == reload_outputs.elems[j] && !reload_output_args.elems[j];
+        }
+        if (kept || !output || !output->output_start)
+            continue;
+        if (!output_fields)
+            output_fields = determine_csv_fields(cfg, well_known, &num_output_fields);
+        data_output_start(output, output_fields, num_output_fields);
+    }
+    free((void *)output_fields);
+    free((void *)well_known);
+
+    reload_next = (reload_lists_t){
+            .r_devs          = demod->r_devs,
+            .output_handler  = cfg->output_handler,
+            .output_args     = output_args,
+            .enable_FM_demod = needs_fm_demod(&demod->r_devs),
+    };
+    reload_ready = 1;
+
+    demod->r_devs       = cur.r_devs;
+    cfg->output_handler = cur.output_handler;
+    output_args         = cur.output_args;
+    reload_outputs      = (list_t){0};
+    reload_output_args  = (list_t){0};
+}
+
+/// Swap in the decoders and outputs prepared by reload_prepare(), if any.
+static void reload_swap(r_cfg_t *cfg)
+{
+    struct dm_state *demod = cfg->demod;
+
+    if (!reload_ready)
+        return;
+    reload_prev = (reload_lists_t){
+            .r_devs         = demod->r_devs,
+            .output_handler = cfg->output_handler,
+            .output_args    = output_args,
+    };
+    demod->r_devs          = reload_next.r_devs;
+    demod->enable_FM_demod = reload_next.enable_FM_demod;
+    cfg->output_handler    = reload_next.output_handler;
+    output_args            = reload_next.output_args;
+    reload_next            = (reload_lists_t){0};
+    reload_ready           = 0;
+}
+
+/// Free the decoders and outputs swapped out by reload_swap(), except the outputs taken over.
+static void reload_free(void)
+{
+    // the outputs before their args
+    for (size_t i = 0; i < reload_prev.output_handler.len; ++i) {
+        if (reload_prev.output_args.elems[i])
+            data_output_free(reload_prev.output_handler.elems[i]);
+    }
+    list_free_elems(&reload_prev.output_handler, NULL);
+    list_free_elems(&reload_prev.output_args, (list_elem_free_fn)free_output_arg);
+    list_free_elems(&reload_prev.r_devs, (list_elem_free_fn)free_protocol);
+}
+
 static r_cfg_t g_cfg;
 
 // TODO: SIGINFO is not in POSIX...
@@ -1297,6 +1875,10 @@ static void sighandler(int signum)
         g_cfg.hop_now = 1;
         return;
     }
+    else if (signum == SIGHUP) {
+        g_cfg.reload_now = 1;
+        return;
+    }
     else if (signum == SIGALRM) {
         write_err("Async read stalled, exiting!\n");
         g_cfg.exit_code = 3;
@@ -1347,24 +1929,425 @@ static void sdr_handler(sdr_event_t *ev, void *ctx)
     }
 
     if (ev->ev == SDR_EV_DATA) {
+        cfg->demod->buffer_arrival = ev->arrival;
         if (cfg->mgr) {
             int max_polls = 16;
             while (max_polls-- && mg_mgr_poll(cfg->mgr, 0));
         }
 
-        if (!cfg->exit_async)
+        if (!cfg->exit_async) {
+            // build a reload outside of the sample processing, sdr_callback() swaps it in
+            if (cfg->reload_now && !reload_ready) {
+                cfg->reload_now = 0;
+                reload_prepare(cfg);
+            }
             sdr_callback((unsigned char *)ev->buf, ev->len, ctx);
+            reload_free();
+        }
     }
 
     if (cfg->exit_async)
         sdr_stop(cfg->dev);
 }
 
+/// Buffers for reading input files.
+typedef struct input_buffers {
+    uint32_t sample_rate_0; ///< sample rate if not given by the file name
+    unsigned char *test_mode_buf;
+    float *test_mode_float_buf;
+} input_buffers_t;
+
+/// Read and process a range of samples, the whole input if @p start and @p end are 0.
+/// Returns the number of blocks read, or -1 if the range can't be read.
+static int read_samples(r_cfg_t *cfg, FILE *in_file, file_map_t *in_map, uint64_t start, uint64_t end, input_buffers_t *bufs)
+{
+    struct dm_state *demod = cfg->demod;
+    unsigned char *test_mode_buf = bufs->test_mode_buf;
+    float *test_mode_float_buf = bufs->test_mode_float_buf;
+    size_t map_pos = 0;
+    size_t map_end = in_map->len;
+    uint64_t file_pos = 0; // position in the sample buffer data, i.e. after conversion
+    size_t block_len = DEFAULT_BUF_LENGTH;
+    if (start || end) {
+        // a segment of a file split for parallel decoding, or an annotated region
+        if (!in_map->data) {
+            fprintf(stderr, "Reading a range of samples needs a regular file: %s\n", cfg->in_filename);
+            return -1;
+        }
+        unsigned file_sample_size = demod->load_info.format == CF32_IQ ? 8 : demod->sample_size;
+        map_pos = start * file_sample_size;
+        if (end && end * file_sample_size < map_end)
+            map_end = end * file_sample_size;
+        if (map_pos > map_end)
+            map_pos = map_end;
+        file_pos       = start * demod->sample_size;
+        cfg->input_pos = start;
+        // align the following blocks with those of a full read for the same sample positions
+        if (file_pos % DEFAULT_BUF_LENGTH)
+            block_len = DEFAULT_BUF_LENGTH - file_pos % DEFAULT_BUF_LENGTH;
+    }
+    int n_blocks = 0;
+    unsigned long n_read;
+    delay_timer_t delay_timer;
+    delay_timer_init(&delay_timer);
+    do {
+        unsigned char *block = test_mode_buf;
+        // Replay in realtime if requested
+        if (cfg->in_replay) {
+            // per block delay
+            unsigned delay_us = (unsigned)(1000000llu * DEFAULT_BUF_LENGTH / cfg->samp_rate / demod->sample_size / cfg->in_replay);
+            if (demod->load_info.format == CF32_IQ)
+                delay_us /= 2; // adjust for float only reading half as many samples
+            delay_timer_wait(&delay_timer, delay_us);
+        }
+        // Convert CF32 file to CS16 buffer
+        if (demod->load_info.format == CF32_IQ) {
+            float const *float_buf = test_mode_float_buf;
+            if (in_map->data) {
+                n_read = (map_end - map_pos) / sizeof(float);
+                if (n_read > block_len / 2)
+                    n_read = block_len / 2;
+                float_buf = (float const *)(in_map->data + map_pos);
+                file_map_advise(in_map, map_pos, n_read * sizeof(float));
+                map_pos += n_read * sizeof(float);
+            } else {
+                n_read = fread(test_mode_float_buf, sizeof(float), DEFAULT_BUF_LENGTH / 2, in_file);
+            }
+            // clamp float to [-1,1] and scale to Q0.15
+            for (unsigned long n = 0; n < n_read; n++) {
+                int s_tmp = float_buf[n] * INT16_MAX;
+                if (s_tmp < -INT16_MAX)
+                    s_tmp = -INT16_MAX;
+                else if (s_tmp > INT16_MAX)
+                    s_tmp = INT16_MAX;
+                ((int16_t *)test_mode_buf)[n] = s_tmp;
+            }
+            n_read *= 2; // convert to byte count
+        } else {
+            if (in_map->data) {
+                n_read = map_end - map_pos;
+                if (n_read > block_len)
+                    n_read = block_len;
+                block = in_map->data + map_pos; // hand out the mapping, sdr_callback() only reads
+                file_map_advise(in_map, map_pos, n_read);
+                map_pos += n_read;
+            } else {
+                n_read = fread(test_mode_buf, 1, DEFAULT_BUF_LENGTH, in_file);
+            }
+
+            // Convert CS8 file to CU8 buffer
+            if (demod->load_info.format == CS8_IQ) {
+                for (unsigned long n = 0; n < n_read; n++) {
+                    test_mode_buf[n] = ((int8_t)block[n]) + 128;
+                }
+                block = test_mode_buf;
+            }
+        }
+        if (n_read == 0) break;  // sdr_callback() will Segmentation Fault with len=0
+        file_pos += n_read;
+        block_len = DEFAULT_BUF_LENGTH;
+        demod->sample_file_pos = (float)file_pos / cfg->samp_rate / demod->sample_size;
+        n_blocks++;
+        sdr_callback(block, n_read, cfg);
+    } while (n_read != 0 && !cfg->exit_async);
+
+    // Call a last time with cleared samples to ensure EOP detection
+    if (demod->sample_size == 2) { // CU8
+        memset(test_mode_buf, 128, DEFAULT_BUF_LENGTH); // 128 is 0 in unsigned data
+        // or is 127.5 a better 0 in cu8 data?
+        //for (unsigned long n = 0; n < DEFAULT_BUF_LENGTH/2; n++)
+        //    ((uint16_t *)test_mode_buf)[n] = 0x807f;
+    }
+    else { // CF32, CS16
+            memset(test_mode_buf, 0, DEFAULT_BUF_LENGTH);
+    }
+    uint64_t end_blocks = (file_pos + DEFAULT_BUF_LENGTH - 1) / DEFAULT_BUF_LENGTH;
+    demod->sample_file_pos = ((float)end_blocks + 1) * DEFAULT_BUF_LENGTH / cfg->samp_rate / demod->sample_size;
+    sdr_callback(test_mode_buf, DEFAULT_BUF_LENGTH, cfg);
+    alarm(0); // cancel the watchdog timer
+
+    return n_blocks;
+
+}
+
+/// Read and process all bursts in a burst store, returns non-zero on failure.
+static int read_burst_store(r_cfg_t *cfg, FILE *in_file, input_buffers_t *bufs)
+{
+    struct dm_state *demod = cfg->demod;
+    char time_str[LOCAL_TIME_BUFLEN];
+
+    if (burst_store_read_header(in_file) != 0) {
+        fprintf(stderr, "Not a burst store: %s\n", cfg->in_filename);
+        return -1;
+    }
+
+    uint8_t *buf    = NULL;
+    size_t buf_size = 0;
+    double stream_s = 0.0; // position in the stream of bursts
+    unsigned n_bursts = 0;
+    burst_info_t info;
+    long len = 0;
+    while (!cfg->exit_async && (len = burst_store_read(in_file, &info, &buf, &buf_size)) > 0) {
+        n_bursts++;
+        cfg->samp_rate        = info.sample_rate;
+        cfg->center_frequency = info.center_frequency;
+        demod->sample_size    = burst_sample_size(info.format);
+        if (cfg->verbosity) {
+            struct timeval tv = {.tv_sec = (time_t)(info.time_us / 1000000), .tv_usec = (long)(info.time_us % 1000000)};
+            fprintf(stderr, "Burst %u at %s, %s, %u sps, %u samples, RSSI %.1f dB, %u events %s\n",
+                    n_bursts, usecs_time_str(time_str, NULL, 0, &tv), nice_freq(info.center_frequency),
+                    info.sample_rate, info.num_samples, info.rssi_db, info.events, info.models);
+        }
+
+        // the burst samples, then a block of silence to end the frame
+        for (long pos = 0; pos < len && !cfg->exit_async;) {
+            unsigned long n = len - pos > DEFAULT_BUF_LENGTH ? DEFAULT_BUF_LENGTH : (unsigned long)(len - pos);
+            stream_s += (double)n / demod->sample_size / cfg->samp_rate;
+            demod->sample_file_pos = (float)stream_s;
+            sdr_callback(buf + pos, n, cfg);
+            pos += n;
+        }
+        memset(bufs->test_mode_buf, demod->sample_size == 2 ? 128 : 0, DEFAULT_BUF_LENGTH);
+        stream_s += (double)DEFAULT_BUF_LENGTH / demod->sample_size / cfg->samp_rate;
+        demod->sample_file_pos = (float)stream_s;
+        sdr_callback(bufs->test_mode_buf, DEFAULT_BUF_LENGTH, cfg);
+    }
+    alarm(0); // cancel the watchdog timer
+    free(buf);
+
+    if (len < 0) {
+        fprintf(stderr, "Malformed burst after %u bursts in %s\n", n_bursts, cfg->in_filename);
+        return -1;
+    }
+    if (cfg->verbosity) {
+        fprintf(stderr, "Burst store issued %u bursts\n", n_bursts);
+    }
+    return 0;
+}
+
+/// Run the decoders and pulse outputs on a package loaded from a pulse file.
+static void replay_pulse_package(r_cfg_t *cfg)
+{
+    struct dm_state *demod = cfg->demod;
+
+    for (void **iter = demod->dumper.elems; iter && *iter; ++iter) {
+        file_info_t const *dumper = *iter;
+        if (dumper->format == VCD_LOGIC) {
+            pulse_data_print_vcd(dumper->file, &demod->pulse_data, '\'');
+        } else if (dumper->format == PULSE_OOK) {
+            pulse_data_dump(dumper->file, &demod->pulse_data);
+        } else {
+            fprintf(stderr, "Dumper (%s) not supported on OOK input\n", dumper->spec);
+            exit(1);
+        }
+    }
+    write_pulses(cfg, &demod->pulse_data);
+
+    metrics_histogram_observe(&cfg->metrics.package_pulses, demod->pulse_data.num_pulses);
+    if (demod->pulse_data.fsk_f2_est) {
+        cfg->metrics.packages_fsk++;
+        run_fsk_demods(&demod->r_devs, &demod->pulse_data);
+    }
+    else {
+        cfg->metrics.packages_ook++;
+        int p_events = run_ook_demods(&demod->r_devs, &demod->pulse_data);
+        if (cfg->verbosity > 2)
+            pulse_data_print(&demod->pulse_data);
+        if (demod->analyze_pulses && (cfg->grab_mode <= 1 || (cfg->grab_mode == 2 && p_events == 0) || (cfg->grab_mode == 3 && p_events > 0))) {
+            pulse_analyzer(&demod->pulse_data, PULSE_DATA_OOK);
+        }
+    }
+    if (cfg->dedup)
+        flush_dedup_data(cfg, 0);
+}
+
+/// Read and process all packages in a binary pulse file, returns non-zero on failure.
+static int read_pulse_file(r_cfg_t *cfg, FILE *in_file)
+{
+    struct dm_state *demod = cfg->demod;
+    pulse_bin_reader_t reader;
+
+    if (pulse_bin_reader_open(&reader, in_file) != 0) {
+        fprintf(stderr, "Not a pulse file: %s\n", cfg->in_filename);
+        return -1;
+    }
+
+    unsigned n_packages = 0;
+    int r = 0;
+    uint64_t file_pos = cfg->input_pos;
+    while (!cfg->exit_async && (r = pulse_bin_read(&reader, &demod->pulse_data)) > 0) {
+        n_packages++;
+        // the package offset runs the dedup clock, in samples at the configured rate
+        pulse_data_t const *pulses = &demod->pulse_data;
+        uint64_t offset = pulses->offset;
+        if (pulses->sample_rate && pulses->sample_rate != cfg->samp_rate)
+            offset = (uint64_t)((double)offset * cfg->samp_rate / pulses->sample_rate);
+        cfg->input_pos = file_pos + offset;
+        replay_pulse_package(cfg);
+    }
+    alarm(0); // cancel the watchdog timer
+    pulse_bin_reader_close(&reader);
+
+    if (r < 0) {
+        fprintf(stderr, "Malformed package after %u packages in %s\n", n_packages, cfg->in_filename);
+        return -1;
+    }
+    if (cfg->verbosity) {
+        fprintf(stderr, "Pulse file issued %u packages\n", n_packages);
+    }
+    return 0;
+}
+
+/// Read and process one input file or a range of samples in a file, returns non-zero on failure.
+static int read_input_file(r_cfg_t *cfg, batch_input_t const *input, void *ctx)
+{
+    input_buffers_t *bufs = ctx;
+    struct dm_state *demod = cfg->demod;
+    FILE *in_file;
+
+    cfg->in_filename = input->filename;
+
+    file_info_clear(&demod->load_info); // reset all info
+    file_info_parse_filename(&demod->load_info, cfg->in_filename);
+    // apply file info or default
+    cfg->samp_rate        = demod->load_info.sample_rate ? demod->load_info.sample_rate : bufs->sample_rate_0;
+    cfg->center_frequency = demod->load_info.center_frequency ? demod->load_info.center_frequency : cfg->frequency[0];
+
+    // a SigMF recording has the dataset format and annotations in the meta file
+    sigmf_meta_t sigmf = {0};
+    if (demod->load_info.format == SIGMF_IQ) {
+        if (sigmf_meta_read(&sigmf, demod->load_info.path) != 0)
+            return -1;
+        demod->load_info.format = sigmf.format;
+        demod->load_info.path   = sigmf.data_path;
+        cfg->samp_rate          = sigmf.sample_rate;
+        if (sigmf.frequency)
+            cfg->center_frequency = sigmf.frequency;
+    }
+
+    if (strcmp(demod->load_info.path, "-") == 0) { // read samples from stdin
+        in_file = stdin;
+        cfg->in_filename = "<stdin>";
+    } else {
+        in_file = fopen(demod->load_info.path, "rb");
+        if (!in_file) {
+            fprintf(stderr, "Opening file: %s failed!\n", cfg->in_filename);
+            sigmf_meta_free(&sigmf);
+            return -1;
+        }
+    }
+    fprintf(stderr, "Test mode active. Reading samples from file: %s\n", cfg->in_filename);  // Essential information (not quiet)
+    if (demod->load_info.format == CU8_IQ
+            || demod->load_info.format == CS8_IQ
+            || demod->load_info.format == S16_AM
+            || demod->load_info.format == S16_FM) {
+        demod->sample_size = sizeof(uint8_t) * 2; // CU8, AM, FM
+    } else if (demod->load_info.format == CS16_IQ
+            || demod->load_info.format == CF32_IQ) {
+        demod->sample_size = sizeof(int16_t) * 2; // CS16, CF32 (after conversion)
+    } else if (demod->load_info.format == PULSE_OOK) {
+        // ignore
+    } else if (demod->load_info.format == BURST_IQ) {
+        // ignore, each burst has its own format
+    } else if (demod->load_info.format == PULSE_BIN) {
+        // ignore, each package has its own sample rate
+    } else {
+        fprintf(stderr, "Input format invalid: %s\n", file_info_string(&demod->load_info));
+        if (in_file != stdin)
+            fclose(in_file);
+        return -1;
+    }
+    if (cfg->verbosity) {
+        fprintf(stderr, "Input format: %s\n", file_info_string(&demod->load_info));
+    }
+    demod->sample_file_pos = 0.0;
+
+    // special case for pulse data file-inputs
+    if (demod->load_info.format == PULSE_OOK) {
+        uint64_t file_pos = cfg->input_pos;
+        while (!cfg->exit_async) {
+            pulse_data_load(in_file, &demod->pulse_data, cfg->samp_rate);
+            if (!demod->pulse_data.num_pulses)
+                break;
+            // the package offset runs the dedup clock, older files have none, count the package lengths
+            if (demod->pulse_data.offset)
+                cfg->input_pos = file_pos + demod->pulse_data.offset;
+            else
+                for (unsigned i = 0; i < demod->pulse_data.num_pulses; ++i)
+                    cfg->input_pos += demod->pulse_data.pulse[i] + demod->pulse_data.gap[i];
+            replay_pulse_package(cfg);
+        }
+
+        if (in_file != stdin)
+            fclose(in_file);
+
+        return 0;
+    }
+
+    // special case for binary pulse file-inputs
+    if (demod->load_info.format == PULSE_BIN) {
+        int r = read_pulse_file(cfg, in_file);
+        if (in_file != stdin)
+            fclose(in_file);
+        return r;
+    }
+
+    // special case for burst store file-inputs
+    if (demod->load_info.format == BURST_IQ) {
+        int r = read_burst_store(cfg, in_file, bufs);
+        if (in_file != stdin)
+            fclose(in_file);
+        return r;
+    }
+
+    // default case for file-inputs
+    // regular files are mapped and read without copies, pipes and stdin use fread()
+    file_map_t in_map;
+    file_map_open(&in_map, in_file);
+    int n_blocks = 0;
+    if (sigmf.num_annotations && !input->start && !input->end) {
+        // only read the annotated regions of a SigMF recording, with a margin as for grabbed signals
+        size_t num_regions = sigmf_meta_regions(&sigmf, DEFAULT_BUF_LENGTH / demod->sample_size / 8);
+        if (cfg->verbosity) {
+            uint64_t region_samples = 0;
+            for (size_t i = 0; i < num_regions; ++i)
+                region_samples += sigmf.annotations[i].sample_count;
+            fprintf(stderr, "Reading %zu annotated regions, %llu samples\n", num_regions, (unsigned long long)region_samples);
+        }
+        for (size_t i = 0; i < num_regions && n_blocks >= 0 && !cfg->exit_async; ++i) {
+            sigmf_annotation_t const *region = &sigmf.annotations[i];
+            int n = read_samples(cfg, in_file, &in_map, region->sample_start, region->sample_start + region->sample_count, bufs);
+            n_blocks = n < 0 ? n : n_blocks + n;
+        }
+    }
+    else {
+        n_blocks = read_samples(cfg, in_file, &in_map, input->start, input->end, bufs);
+    }
+    file_map_close(&in_map);
+    sigmf_meta_free(&sigmf);
+    if (n_blocks < 0) {
+        if (in_file != stdin)
+            fclose(in_file);
+        return -1;
+    }
+
+    //Always classify a signal at the end of the file
+    if (demod->am_analyze)
+        am_analyze_classify(demod->am_analyze);
+    if (cfg->verbosity) {
+        fprintf(stderr, "Test mode file issued %d packets\n", n_blocks);
+    }
+
+    if (in_file != stdin)
+        fclose(in_file);
+
+    return 0;
+}
+
 int main(int argc, char **argv) {
 #ifndef _WIN32
     struct sigaction sigact;
 #endif
-    FILE *in_file;
     int r = 0;
     struct dm_state *demod;
     r_cfg_t *cfg = &g_cfg;
@@ -1378,6 +2361,13 @@ int main(int argc, char **argv) {
 
     demod = cfg->demod;
 
+    for (int i = 0; i < argc; ++i) {
+        char *arg = strdup(argv[i]);
+        if (!arg)
+            FATAL_STRDUP("main()");
+        list_push(&conf_args, arg);
+    }
+
     // if there is no explicit conf file option look for default conf files
     if (!hasopt('c', argc, argv, OPTSTRING)) {
         parse_conf_try_default_files(cfg);
@@ -1435,6 +2425,7 @@ int main(int argc, char **argv) {
 
     if (!cfg->output_handler.len) {
         add_kv_output(cfg, NULL);
+        push_output_arg("kv");
     }
 
     // register default decoders if nothing is configured
@@ -1443,40 +2434,9 @@ int main(int argc, char **argv) {
     }
 
     // check if we need FM demod
-    for (void **iter = demod->r_devs.elems; iter && *iter; ++iter) {
-        r_device *r_dev = *iter;
-        if (r_dev->modulation >= FSK_DEMOD_MIN_VAL) {
-          demod->enable_FM_demod = 1;
-          break;
-        }
-    }
+    demod->enable_FM_demod = needs_fm_demod(&demod->r_devs);
 
-    {
-        char decoders_str[1024];
-        decoders_str[0] = '\0';
-        if (!cfg->verbosity) {
-            abuf_t p = {0};
-            abuf_init(&p, decoders_str, sizeof(decoders_str));
-            // print registered decoder ranges
-            abuf_printf(&p, " [");
-            for (void **iter = demod->r_devs.elems; iter && *iter; ++iter) {
-                r_device *r_dev = *iter;
-                unsigned num = r_dev->protocol_num;
-                if (num == 0)
-                    continue;
-                while (iter[1]
-                        && r_dev->protocol_num + 1 == ((r_device *)iter[1])->protocol_num)
-                    r_dev = *++iter;
-                if (num == r_dev->protocol_num)
-                    abuf_printf(&p, " %u", num);
-                else
-                    abuf_printf(&p, " %u-%u", num, r_dev->protocol_num);
-            }
-            abuf_printf(&p, " ]");
-        }
-        fprintf(stderr, "Registered %zu out of %u device decoding protocols%s\n",
-                demod->r_devs.len, cfg->num_r_devices, decoders_str);
-    }
+    print_registered_protocols(cfg);
 
     char const **well_known = well_known_output_fields(cfg);
     start_outputs(cfg, well_known);
@@ -1547,6 +2507,7 @@ int main(int argc, char **argv) {
                     else
                         r += run_fsk_demods(&single_dev, &pulse_data);
                     list_free_elems(&single_dev, NULL);
+                    pulse_data_free(&pulse_data);
                 } else
                 r += pulse_slicer_string(e, r_dev);
                 continue;
@@ -1559,6 +2520,7 @@ int main(int argc, char **argv) {
                     r += run_ook_demods(&demod->r_devs, &pulse_data);
                 else
                     r += run_fsk_demods(&demod->r_devs, &pulse_data);
+                pulse_data_free(&pulse_data);
             } else
             for (void **iter = demod->r_devs.elems; iter && *iter; ++iter) {
                 r_device *r_dev = *iter;
@@ -1572,6 +2534,7 @@ int main(int argc, char **argv) {
             fclose(fp);
         }
 
+        free_conf_args();
         r_free_cfg(cfg);
         exit(!r);
     }
@@ -1585,6 +2548,7 @@ int main(int argc, char **argv) {
                 r += run_ook_demods(&demod->r_devs, &pulse_data);
             else
                 r += run_fsk_demods(&demod->r_devs, &pulse_data);
+            pulse_data_free(&pulse_data);
         } else
         for (void **iter = demod->r_devs.elems; iter && *iter; ++iter) {
             r_device *r_dev = *iter;
@@ -1592,6 +2556,7 @@ int main(int argc, char **argv) {
                 fprintf(stderr, "Verifying test data with device %s.\n", r_dev->name);
             r += pulse_slicer_string(cfg->test_data, r_dev);
         }
+        free_conf_args();
         r_free_cfg(cfg);
         exit(!r);
     }
@@ -1610,156 +2575,58 @@ int main(int argc, char **argv) {
             cfg->stop_time += cfg->duration;
         }
 
+        input_buffers_t bufs = {
+                .sample_rate_0       = sample_rate_0,
+                .test_mode_buf       = test_mode_buf,
+                .test_mode_float_buf = test_mode_float_buf,
+        };
+        list_t inputs = {0};
         for (void **iter = cfg->in_files.elems; iter && *iter; ++iter) {
-            cfg->in_filename = *iter;
-
-            file_info_clear(&demod->load_info); // reset all info
-            file_info_parse_filename(&demod->load_info, cfg->in_filename);
-            // apply file info or default
-            cfg->samp_rate        = demod->load_info.sample_rate ? demod->load_info.sample_rate : sample_rate_0;
-            cfg->center_frequency = demod->load_info.center_frequency ? demod->load_info.center_frequency : cfg->frequency[0];
-
-            if (strcmp(demod->load_info.path, "-") == 0) { // read samples from stdin
-                in_file = stdin;
-                cfg->in_filename = "<stdin>";
-            } else {
-                in_file = fopen(demod->load_info.path, "rb");
-                if (!in_file) {
-                    fprintf(stderr, "Opening file: %s failed!\n", cfg->in_filename);
-                    break;
-                }
-            }
-            fprintf(stderr, "Test mode active. Reading samples from file: %s\n", cfg->in_filename);  // Essential information (not quiet)
-            if (demod->load_info.format == CU8_IQ
-                    || demod->load_info.format == CS8_IQ
-                    || demod->load_info.format == S16_AM
-                    || demod->load_info.format == S16_FM) {
-                demod->sample_size = sizeof(uint8_t) * 2; // CU8, AM, FM
-            } else if (demod->load_info.format == CS16_IQ
-                    || demod->load_info.format == CF32_IQ) {
-                demod->sample_size = sizeof(int16_t) * 2; // CS16, CF32 (after conversion)
-            } else if (demod->load_info.format == PULSE_OOK) {
-                // ignore
-            } else {
-                fprintf(stderr, "Input format invalid: %s\n", file_info_string(&demod->load_info));
-                break;
+            char *filename = *iter;
+            if (cfg->batch_jobs > 1 && cfg->batch_split) {
+                file_info_t info = {0};
+                file_info_parse_filename(&info, filename);
+                uint32_t samp_rate = info.sample_rate ? info.sample_rate : sample_rate_0;
+                batch_split_file(&inputs, filename, info.path, info.format, samp_rate, cfg->batch_jobs * 4);
             }
-            if (cfg->verbosity) {
-                fprintf(stderr, "Input format: %s\n", file_info_string(&demod->load_info));
-            }
-            demod->sample_file_pos = 0.0;
-
-            // special case for pulse data file-inputs
-            if (demod->load_info.format == PULSE_OOK) {
-                while (!cfg->exit_async) {
-                    pulse_data_load(in_file, &demod->pulse_data, cfg->samp_rate);
-                    if (!demod->pulse_data.num_pulses)
-                        break;
-
-                    for (void **iter2 = demod->dumper.elems; iter2 && *iter2; ++iter2) {
-                        file_info_t const *dumper = *iter2;
-                        if (dumper->format == VCD_LOGIC) {
-                            pulse_data_print_vcd(dumper->file, &demod->pulse_data, '\'');
-                        } else if (dumper->format == PULSE_OOK) {
-                            pulse_data_dump(dumper->file, &demod->pulse_data);
-                        } else {
-                            fprintf(stderr, "Dumper (%s) not supported on OOK input\n", dumper->spec);
-                            exit(1);
-                        }
-                    }
-
-                    if (demod->pulse_data.fsk_f2_est) {
-                        run_fsk_demods(&demod->r_devs, &demod->pulse_data);
-                    }
-                    else {
-                        int p_events = run_ook_demods(&demod->r_devs, &demod->pulse_data);
-                        if (cfg->verbosity > 2)
-                            pulse_data_print(&demod->pulse_data);
-                        if (demod->analyze_pulses && (cfg->grab_mode <= 1 || (cfg->grab_mode == 2 && p_events == 0) || (cfg->grab_mode == 3 && p_events > 0))) {
-                            pulse_analyzer(&demod->pulse_data, PULSE_DATA_OOK);
-                        }
-                    }
-                }
-
-                if (in_file != stdin)
-                    fclose(in_file = stdin);
-
-                continue;
+            else {
+                batch_input_t *input = calloc(1, sizeof(*input));
+                if (!input)
+                    FATAL_CALLOC("main()");
+                input->filename = filename;
+                list_push(&inputs, input);
             }
+        }
 
-            // default case for file-inputs
-            int n_blocks = 0;
-            unsigned long n_read;
-            delay_timer_t delay_timer;
-            delay_timer_init(&delay_timer);
-            do {
-                // Replay in realtime if requested
-                if (cfg->in_replay) {
-                    // per block delay
-                    unsigned delay_us = (unsigned)(1000000llu * DEFAULT_BUF_LENGTH / cfg->samp_rate / demod->sample_size / cfg->in_replay);
-                    if (demod->load_info.format == CF32_IQ)
-                        delay_us /= 2; // adjust for float only reading half as many samples
-                    delay_timer_wait(&delay_timer, delay_us);
-                }
-                // Convert CF32 file to CS16 buffer
-                if (demod->load_info.format == CF32_IQ) {
-                    n_read = fread(test_mode_float_buf, sizeof(float), DEFAULT_BUF_LENGTH / 2, in_file);
-                    // clamp float to [-1,1] and scale to Q0.15
-                    for (unsigned long n = 0; n < n_read; n++) {
-                        int s_tmp = test_mode_float_buf[n] * INT16_MAX;
-                        if (s_tmp < -INT16_MAX)
-                            s_tmp = -INT16_MAX;
-                        else if (s_tmp > INT16_MAX)
-                            s_tmp = INT16_MAX;
-                        ((int16_t *)test_mode_buf)[n] = s_tmp;
-                    }
-                    n_read *= 2; // convert to byte count
-                } else {
-                    n_read = fread(test_mode_buf, 1, DEFAULT_BUF_LENGTH, in_file);
-
-                    // Convert CS8 file to CU8 buffer
-                    if (demod->load_info.format == CS8_IQ) {
-                        for (unsigned long n = 0; n < n_read; n++) {
-                            test_mode_buf[n] = ((int8_t)test_mode_buf[n]) + 128;
-                        }
-                    }
-                }
-                if (n_read == 0) break;  // sdr_callback() will Segmentation Fault with len=0
-                demod->sample_file_pos = ((float)n_blocks * DEFAULT_BUF_LENGTH + n_read) / cfg->samp_rate / demod->sample_size;
-                n_blocks++; // this assumes n_read == DEFAULT_BUF_LENGTH
-                sdr_callback(test_mode_buf, n_read, cfg);
-            } while (n_read != 0 && !cfg->exit_async);
-
-            // Call a last time with cleared samples to ensure EOP detection
-            if (demod->sample_size == 2) { // CU8
-                memset(test_mode_buf, 128, DEFAULT_BUF_LENGTH); // 128 is 0 in unsigned data
-                // or is 127.5 a better 0 in cu8 data?
-                //for (unsigned long n = 0; n < DEFAULT_BUF_LENGTH/2; n++)
-                //    ((uint16_t *)test_mode_buf)[n] = 0x807f;
+        int failed = 0;
+        if (cfg->batch_jobs > 1 && inputs.len > 1) {
+            if (demod->dumper.len || demod->samp_grab || demod->sigmf_writers.len || demod->pulse_writers.len) {
+                fprintf(stderr, "Writing files (-w, -S) is not supported with parallel batch mode (-j).\n");
+                exit(1);
             }
-            else { // CF32, CS16
-                    memset(test_mode_buf, 0, DEFAULT_BUF_LENGTH);
-            }
-            demod->sample_file_pos = ((float)n_blocks + 1) * DEFAULT_BUF_LENGTH / cfg->samp_rate / demod->sample_size;
-            sdr_callback(test_mode_buf, DEFAULT_BUF_LENGTH, cfg);
-            alarm(0); // cancel the watchdog timer
-
-            //Always classify a signal at the end of the file
-            if (demod->am_analyze)
-                am_analyze_classify(demod->am_analyze);
-            if (cfg->verbosity) {
-                fprintf(stderr, "Test mode file issued %d packets\n", n_blocks);
+            // segments of a split file are always printed in order
+            int ordered = cfg->batch_ordered || cfg->batch_split;
+            failed = batch_run(cfg, &inputs, cfg->batch_jobs, ordered, read_input_file, &bufs);
+        }
+        else {
+            // count failed inputs and go on, as batch_run() does
+            for (void **iter = inputs.elems; iter && *iter && !cfg->exit_async; ++iter) {
+                failed += read_input_file(cfg, *iter, &bufs) != 0;
             }
-
-            if (in_file != stdin)
-                fclose(in_file = stdin);
+            if (failed && inputs.len > 1)
+                fprintf(stderr, "%d of %zu inputs failed\n", failed, inputs.len);
+        }
+        list_free_elems(&inputs, free);
+        if (cfg->report_stats > 0) {
+            event_occurred_handler(cfg, create_report_data(cfg, cfg->report_stats));
+            flush_report_data(cfg);
         }
-
         close_dumpers(cfg);
         free(test_mode_buf);
         free(test_mode_float_buf);
+        free_conf_args();
         r_free_cfg(cfg);
-        exit(0);
+        exit(failed ? 1 : 0);
     }
 
     if (cfg->sr_filename) {
@@ -1786,6 +2653,7 @@ int main(int argc, char **argv) {
     sigaction(SIGPIPE, &sigact, NULL);
     sigaction(SIGUSR1, &sigact, NULL);
     sigaction(SIGINFO, &sigact, NULL);
+    sigaction(SIGHUP, &sigact, NULL);
 #else
     SetConsoleCtrlHandler((PHANDLER_ROUTINE)console_handler, TRUE);
 #endif
@@ -1843,6 +2711,7 @@ int main(int argc, char **argv) {
 
     if (cfg->exit_code >= 0)
         r = cfg->exit_code;
+    free_conf_args();
     r_free_cfg(cfg);
 
     return r >= 0 ? r : -r;
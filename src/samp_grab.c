@@ -27,7 +27,7 @@
 #include "samp_grab.h"
 #include "fatal.h"
 
-samp_grab_t *samp_grab_create(unsigned size)
+samp_grab_t *samp_grab_create(ring_buf_t *ring)
 {
     samp_grab_t *g;
     g = calloc(1, sizeof(*g));
@@ -36,64 +36,50 @@ samp_grab_t *samp_grab_create(unsigned size)
         return NULL; // NOTE: returns NULL on alloc failure.
     }
 
-    g->sg_size = size;
+    g->ring = ring;
     g->sg_counter = 1;
-
-    g->sg_buf = malloc(size);
-    if (!g->sg_buf) {
-        WARN_MALLOC("samp_grab_create()");
-        free(g);
-        return NULL; // NOTE: returns NULL on alloc failure.
-    }
+    g->sg_start = ring_buf_head(ring);
 
     return g;
 }
 
 void samp_grab_free(samp_grab_t *g)
 {
-    if (g->sg_buf)
-        free(g->sg_buf);
     free(g);
 }
 
-void samp_grab_push(samp_grab_t *g, unsigned char *iq_buf, uint32_t len)
+void samp_grab_reset(samp_grab_t *g)
 {
-    //fprintf(stderr, "sg_index %d + len %d (size %d ", g->sg_index, len, g->sg_len);
-
-    g->sg_len += len;
-    if (g->sg_len > g->sg_size)
-        g->sg_len = g->sg_size;
-
-    //fprintf(stderr, "-> %d)\n", g->sg_len);
-
-    while (len) {
-        unsigned chunk_len = len;
-        if (g->sg_index + chunk_len > g->sg_size)
-            chunk_len = g->sg_size - g->sg_index;
-
-        memcpy(&g->sg_buf[g->sg_index], iq_buf, chunk_len);
-        iq_buf += chunk_len;
-        len -= chunk_len;
-        g->sg_index += chunk_len;
-        if (g->sg_index >= g->sg_size)
-            g->sg_index = 0;
-    }
+    g->sg_start = ring_buf_head(g->ring);
 }
 
-void samp_grab_reset(samp_grab_t *g)
+/// Bytes grabbed since the last reset, up to the ring size.
+static unsigned grab_len_bytes(samp_grab_t *g, uint64_t head)
 {
-    g->sg_len = 0;
-    g->sg_index = 0;
+    uint64_t len = head - g->sg_start;
+    return len > g->ring->size ? (unsigned)g->ring->size : (unsigned)len;
 }
 
 #define BLOCK_SIZE (128 * 1024) /* bytes */
 
-void samp_grab_write(samp_grab_t *g, unsigned grab_len, unsigned grab_end)
+unsigned samp_grab_range(samp_grab_t *g, unsigned grab_len, unsigned grab_end, char const **data)
 {
-    if (!g->sg_buf)
-        return;
+    uint64_t head = ring_buf_head(g->ring);
+    unsigned sg_len = grab_len_bytes(g, head);
+    unsigned end_bsize    = *g->sample_size * grab_end;
+    unsigned signal_bsize = *g->sample_size * grab_len;
+    if (end_bsize >= sg_len)
+        return 0;
+    if (signal_bsize > sg_len - end_bsize)
+        signal_bsize = sg_len - end_bsize; // clip to the buffered samples
+
+    *data = (char const *)ring_buf_at(g->ring, head - end_bsize - signal_bsize);
+    return signal_bsize;
+}
 
-    unsigned end_pos, start_pos, signal_bsize, wlen, wrest;
+void samp_grab_write(samp_grab_t *g, unsigned grab_len, unsigned grab_end)
+{
+    unsigned end_pos, signal_bsize;
     char f_name[64] = {0};
     FILE *fp;
 
@@ -108,29 +94,20 @@ void samp_grab_write(samp_grab_t *g, unsigned grab_len, unsigned grab_end)
         }
     }
 
+    uint64_t head = ring_buf_head(g->ring);
+    unsigned sg_len = grab_len_bytes(g, head);
+
     signal_bsize = *g->sample_size * grab_len;
     signal_bsize += BLOCK_SIZE - (signal_bsize % BLOCK_SIZE);
 
-    if (signal_bsize > g->sg_len) {
-        fprintf(stderr, "Signal bigger than buffer, signal = %u > buffer %u !!\n", signal_bsize, g->sg_len);
-        signal_bsize = g->sg_len;
+    if (signal_bsize > sg_len) {
+        fprintf(stderr, "Signal bigger than buffer, signal = %u > buffer %u !!\n", signal_bsize, sg_len);
+        signal_bsize = sg_len;
     }
 
-    // relative end in bytes from current sg_index down
     end_pos = *g->sample_size * grab_end;
-    if (g->sg_index >= end_pos)
-        end_pos = g->sg_index - end_pos;
-    else
-        end_pos = g->sg_size - end_pos + g->sg_index;
-    // end_pos is now absolute in sg_buf
-
-    if (end_pos >= signal_bsize)
-        start_pos = end_pos - signal_bsize;
-    else
-        start_pos = g->sg_size - signal_bsize + end_pos;
-
-    //fprintf(stderr, "signal_bsize = %d  -      sg_index = %d\n", signal_bsize, g->sg_index);
-    //fprintf(stderr, "start_pos    = %d  -   buffer_size = %d\n", start_pos, g->sg_size);
+    // the ring is mapped twice, the signal is contiguous even if it wraps around
+    uint8_t const *start = ring_buf_at(g->ring, head - end_pos - signal_bsize);
 
     fprintf(stderr, "*** Saving signal to file %s (%u samples, %u bytes)\n", f_name, grab_len, signal_bsize);
     fp = fopen(f_name, "wb");
@@ -139,19 +116,7 @@ void samp_grab_write(samp_grab_t *g, unsigned grab_len, unsigned grab_end)
         return;
     }
 
-    wlen = signal_bsize;
-    wrest = 0;
-    if (start_pos + signal_bsize > g->sg_size) {
-        wlen  = g->sg_size - start_pos;
-        wrest = signal_bsize - wlen;
-    }
-    //fprintf(stderr, "*** Writing data from %d, len %d\n", start_pos, wlen);
-    fwrite(&g->sg_buf[start_pos], 1, wlen, fp);
-
-    if (wrest) {
-        //fprintf(stderr, "*** Writing data from %d, len %d\n", 0, wrest);
-        fwrite(&g->sg_buf[0], 1, wrest, fp);
-    }
+    fwrite(start, 1, signal_bsize, fp);
 
     fclose(fp);
 }
@@ -16,10 +16,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
+#include <signal.h>
 #include "sdr.h"
 #include "r_util.h"
 #include "optparse.h"
 #include "fatal.h"
+#include "compat_pthread.h"
 #ifdef RTLSDR
 #include <rtl-sdr.h>
 #if defined(__linux__) && (defined(__GNUC__) || defined(__clang__))
@@ -64,6 +67,8 @@ int __attribute__((weak)) rtlsdr_set_bias_tee(rtlsdr_dev_t *dev, int on);
 #else
     #include <sys/types.h>
     #include <sys/socket.h>
+    #include <sys/select.h>
+    #include <sys/time.h>
     #include <netdb.h>
     #include <netinet/in.h>
 
@@ -74,10 +79,57 @@ int __attribute__((weak)) rtlsdr_set_bias_tee(rtlsdr_dev_t *dev, int on);
 
 #define GAIN_STR_MAX_SIZE 64
 
+#define RTLTCP_DEFAULT_RCVBUF (4 * 1024 * 1024) // about 1 s at 2 Msps
+#define RTLTCP_MIN_BUFFERS    2
+
+#ifdef THREADS
+/// Read-ahead queue of the rtl_tcp receive thread.
+typedef struct rtltcp_queue {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    unsigned buf_num;    ///< number of buffers in the queue
+    uint32_t buf_len;    ///< size of each buffer
+    uint32_t *lens;      ///< bytes received into each buffer
+    double *arrivals;    ///< wall clock time each buffer was received
+    unsigned head;       ///< buffers filled, counts up
+    unsigned tail;       ///< buffers processed, counts up
+    int running;         ///< the receive thread should keep running
+    int eof;             ///< the connection was closed
+    // statistics
+    unsigned long long received; ///< buffers received
+    unsigned long long overruns; ///< buffers dropped because the queue was full
+    unsigned depth_max;          ///< most buffers waiting to be processed
+    double interval_mean;        ///< mean time between buffers in seconds
+    double interval_m2;          ///< sum of squared differences from the mean
+    double interval_max;         ///< longest time between buffers in seconds
+} rtltcp_queue_t;
+#endif
+
+/// Checks of the sample stream for lost samples.
+typedef struct sdr_stream_check {
+    uint32_t rate;        ///< sample rate of the stream, 0 to restart the checks
+    double start;         ///< arrival time of the first buffer
+    double last_arrival;  ///< arrival time of the previous buffer
+    double samples;       ///< samples accounted for since the start, received or lost
+    double expected;      ///< samples expected from the wall clock since the start
+    double lag_base;      ///< least lag of the arrivals behind the sample time
+    double window_end;    ///< end of the current check window
+    double window_min;    ///< least lag in the current check window
+    int suspect;          ///< the lag was raised in the last window, samples might be lost
+    int has_time;         ///< the device has stream timestamps, arrivals are not checked
+    long long time_ns;    ///< expected timestamp of the next buffer
+    double last_warn;     ///< time of the last warning, to limit the rate
+} sdr_stream_check_t;
+
 struct sdr_dev {
     SOCKET rtl_tcp;
     uint32_t rtl_tcp_freq; ///< last known center frequency, rtl_tcp only.
     uint32_t rtl_tcp_rate; ///< last known sample rate, rtl_tcp only.
+    unsigned rtl_tcp_buffers; ///< read-ahead queue depth, rtl_tcp only.
+#ifdef THREADS
+    rtltcp_queue_t rtl_tcp_queue;
+#endif
 
 #ifdef SOAPYSDR
     SoapySDRDevice *soapy_dev;
@@ -92,6 +144,7 @@ struct sdr_dev {
 #endif
 
     char *dev_info;
+    int verbose;
 
     int running;
     int polling;
@@ -110,6 +163,9 @@ struct sdr_dev {
     int freq_correction;
     uint32_t center_frequency;
     char *gain_str;
+
+    sdr_stats_t stats;
+    sdr_stream_check_t stream_check;
 };
 
 /* internal helpers */
@@ -144,6 +200,7 @@ static int apply_changes(sdr_dev_t *dev, sdr_event_cb_t cb, void *ctx)
         flags |= SDR_EV_GAIN;
     }
     if (flags) {
+        dev->stream_check.rate = 0; // the stream might have been interrupted, restart the checks
         sdr_event_t ev = {
                 .ev               = flags,
                 .sample_rate      = dev->sample_rate,
@@ -170,7 +227,6 @@ struct rtl_tcp_info {
 
 static int rtltcp_open(sdr_dev_t **out_dev, char const *dev_query, int verbose)
 {
-    UNUSED(verbose);
     char *host = "localhost";
     char *port = "1234";
     char hostport[280]; // 253 chars DNS name plus extra chars
@@ -180,7 +236,29 @@ static int rtltcp_open(sdr_dev_t **out_dev, char const *dev_query, int verbose)
     if (param)
         strncpy(hostport, param, sizeof(hostport) - 1);
     hostport[sizeof(hostport) - 1] = '\0';
-    hostport_param(hostport, &host, &port);
+    char *opts = hostport_param(hostport, &host, &port);
+
+    unsigned buffers = 0; // default is the number of buffers requested on start
+    int rcvbuf       = RTLTCP_DEFAULT_RCVBUF;
+    char *key, *val;
+    while (getkwargs(&opts, &key, &val)) {
+        key = remove_ws(key);
+        val = trim_ws(val);
+        if (!key || !*key)
+            continue;
+        else if (!strcasecmp(key, "buffers"))
+            buffers = atouint32_metric(val, "rtl_tcp buffers= ");
+        else if (!strcasecmp(key, "rcvbuf"))
+            rcvbuf = (int)atouint32_metric(val, "rtl_tcp rcvbuf= ");
+        else {
+            fprintf(stderr, "Invalid key \"%s\" option.\n", key);
+            return -1;
+        }
+    }
+    if (buffers && buffers < RTLTCP_MIN_BUFFERS) {
+        fprintf(stderr, "rtl_tcp needs at least %d buffers.\n", RTLTCP_MIN_BUFFERS);
+        return -1;
+    }
 
     fprintf(stderr, "rtl_tcp input from %s port %s\n", host, port);
 
@@ -212,6 +290,9 @@ static int rtltcp_open(sdr_dev_t **out_dev, char const *dev_query, int verbose)
     for (res = res0; res; res = res->ai_next) {
         sock = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
         if (sock >= 0) {
+            // a large receive buffer rides out processing hiccups, set before connect for the TCP window
+            if (rcvbuf > 0 && setsockopt(sock, SOL_SOCKET, SO_RCVBUF, (char const *)&rcvbuf, sizeof(rcvbuf)) < 0)
+                perror("rtl_tcp SO_RCVBUF");
             ret = connect(sock, res->ai_addr, res->ai_addrlen);
             if (ret == -1) {
                 perror("connect");
@@ -251,6 +332,12 @@ static int rtltcp_open(sdr_dev_t **out_dev, char const *dev_query, int verbose)
     char const *tuner_name = tuner_number > sizeof (tuner_names) ? "Invalid" : tuner_names[tuner_number];
 
     fprintf(stderr, "rtl_tcp connected to %s:%s (Tuner: %s)\n", host, port, tuner_name);
+    if (verbose) {
+        int actual         = 0;
+        socklen_t opt_len  = sizeof(actual);
+        if (getsockopt(sock, SOL_SOCKET, SO_RCVBUF, (char *)&actual, &opt_len) == 0)
+            fprintf(stderr, "rtl_tcp receive buffer is %d bytes\n", actual);
+    }
 
     sdr_dev_t *dev = calloc(1, sizeof(sdr_dev_t));
     if (!dev) {
@@ -259,6 +346,8 @@ static int rtltcp_open(sdr_dev_t **out_dev, char const *dev_query, int verbose)
     }
 
     dev->rtl_tcp = sock;
+    dev->rtl_tcp_buffers = buffers;
+    dev->verbose = verbose;
     dev->sample_size = sizeof(uint8_t) * 2; // CU8
     dev->sample_signed = 0;
 
@@ -283,9 +372,44 @@ static int rtltcp_close(SOCKET sock)
     return 0;
 }
 
-static int rtltcp_read_loop(sdr_dev_t *dev, sdr_event_cb_t cb, void *ctx, uint32_t buf_num, uint32_t buf_len)
+/// Receive a full buffer, waits at most @p timeout_ms for data if not 0.
+/// Returns the bytes read, 0 on timeout, -1 if the connection failed.
+static int rtltcp_recv(SOCKET sock, uint8_t *buffer, uint32_t buf_len, int timeout_ms)
+{
+    if (timeout_ms) {
+        fd_set fds;
+        FD_ZERO(&fds);
+        FD_SET(sock, &fds);
+        struct timeval timeout = {timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+        int ready = select((int)sock + 1, &fds, NULL, NULL, &timeout);
+        if (ready <= 0)
+            return ready;
+    }
+
+    unsigned n_read = 0;
+    int r;
+
+    do {
+        r = recv(sock, (char *)&buffer[n_read], buf_len - n_read, MSG_WAITALL);
+        if (r <= 0)
+            break;
+        n_read += r;
+        //fprintf(stderr, "readStream ret=%d (of %u)\n", r, n_read);
+    } while (n_read < buf_len);
+    //fprintf(stderr, "readStream ret=%d (read %u)\n", r, n_read);
+
+    if (r < 0) {
+        fprintf(stderr, "WARNING: sync read failed. %d\n", r);
+    }
+    if (n_read == 0) {
+        perror("rtl_tcp");
+        return -1;
+    }
+    return (int)n_read;
+}
+
+static int rtltcp_alloc_buffers(sdr_dev_t *dev, size_t buffer_size)
 {
-    size_t buffer_size = buf_num * buf_len;
     if (dev->buffer_size != buffer_size) {
         free(dev->buffer);
         dev->buffer = malloc(buffer_size);
@@ -296,6 +420,360 @@ static int rtltcp_read_loop(sdr_dev_t *dev, sdr_event_cb_t cb, void *ctx, uint32
         dev->buffer_size = buffer_size;
         dev->buffer_pos = 0;
     }
+    return 0;
+}
+
+/// Wall clock time in seconds, used to stamp the arrival of sample buffers.
+static double time_now_s(void)
+{
+    struct timeval tv;
+    get_time_now(&tv);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+#define SDR_CHECK_WINDOW 1.0  // seconds to find the least arrival lag in
+#define SDR_WARN_INTERVAL 10.0 // seconds between warnings
+
+/// Count lost samples, warns at most every SDR_WARN_INTERVAL.
+static void sdr_count_loss(sdr_dev_t *dev, double lost, double now, char const *reason)
+{
+    sdr_stream_check_t *sc = &dev->stream_check;
+    dev->stats.dropped += (unsigned long long)lost;
+    dev->stats.gaps += 1;
+    if (now - sc->last_warn >= SDR_WARN_INTERVAL) {
+        fprintf(stderr, "SDR input lost %.0f samples (%.1f ms, %s), %llu samples in %llu gaps so far!\n",
+                lost, sc->rate ? lost * 1000.0 / sc->rate : 0.0, reason, dev->stats.dropped, dev->stats.gaps);
+        sc->last_warn = now;
+    }
+}
+
+/** Check the arrival of a buffer for lost samples.
+
+    The arrivals lag behind the sample time by the buffering, the least lag is the baseline.
+    Processing stalls raise the lag until the buffers are caught up, lost samples raise it for good.
+    If the least lag of two check windows is raised by more than half a buffer the samples are lost.
+*/
+static void sdr_check_arrival(sdr_dev_t *dev, unsigned samples, double arrival, long long const *time_ns)
+{
+    sdr_stream_check_t *sc = &dev->stream_check;
+
+    if (!sc->rate) {
+        // (re)start the checks, keep the warning limit
+        double last_warn = sc->last_warn;
+        memset(sc, 0, sizeof(*sc));
+        sc->last_warn = last_warn;
+        sc->rate      = sdr_get_sample_rate(dev);
+        if (!sc->rate)
+            return; // unknown rate, try again on the next buffer
+        sc->start        = arrival;
+        sc->last_arrival = arrival;
+        sc->samples      = samples;
+        sc->lag_base     = -(double)samples / sc->rate;
+        sc->window_min   = sc->lag_base;
+        sc->window_end   = arrival + SDR_CHECK_WINDOW;
+        dev->stats.samples_expected += samples;
+        if (time_ns) {
+            sc->has_time = 1;
+            sc->time_ns  = *time_ns + (long long)(samples * 1e9 / sc->rate);
+        }
+        return;
+    }
+
+    dev->stats.samples_expected += (unsigned long long)((arrival - sc->last_arrival) * sc->rate);
+    sc->last_arrival = arrival;
+
+    if (time_ns) {
+        // stream timestamps are exact, a jump forward of more than a sample is lost samples
+        long long gap_ns = *time_ns - sc->time_ns;
+        if (sc->has_time && gap_ns * 1e-9 * sc->rate > 1.0)
+            sdr_count_loss(dev, gap_ns * 1e-9 * sc->rate, arrival, "timestamp gap");
+        sc->has_time = 1;
+        sc->time_ns  = *time_ns + (long long)(samples * 1e9 / sc->rate);
+        return;
+    }
+    if (sc->has_time)
+        return;
+
+    sc->samples += samples;
+    double lag = (arrival - sc->start) - sc->samples / sc->rate;
+    if (lag < sc->lag_base)
+        sc->lag_base = lag;
+    if (lag < sc->window_min)
+        sc->window_min = lag;
+    if (arrival < sc->window_end)
+        return;
+
+    double raised = sc->window_min - sc->lag_base;
+    if (raised > 0.5 * samples / sc->rate) {
+        if (sc->suspect) {
+            sdr_count_loss(dev, raised * sc->rate, arrival, "late arrivals");
+            sc->lag_base = sc->window_min;
+            sc->suspect  = 0;
+        }
+        else {
+            sc->suspect = 1;
+        }
+    }
+    else {
+        // follow the drift of the sample clock
+        sc->lag_base = sc->window_min;
+        sc->suspect  = 0;
+    }
+    sc->window_end = arrival + SDR_CHECK_WINDOW;
+    sc->window_min = lag;
+}
+
+/// Pass a data buffer to the callback, with checks for lost samples and timing of the callback.
+static void sdr_data_event(sdr_dev_t *dev, sdr_event_cb_t cb, void *ctx, sdr_event_t *ev, long long const *time_ns)
+{
+    sdr_stats_t *stats = &dev->stats;
+    unsigned samples   = ev->len / dev->sample_size;
+
+    stats->buffers += 1;
+    stats->bytes += ev->len;
+    stats->samples += samples;
+    sdr_check_arrival(dev, samples, ev->arrival, time_ns);
+
+    double start = time_now_s();
+    cb(ev, ctx);
+    double elapsed = time_now_s() - start;
+
+    uint32_t rate   = dev->stream_check.rate;
+    double duration = rate ? (double)samples / rate : 0.0;
+    stats->callback_seconds += elapsed;
+    stats->buffer_seconds += duration;
+    if (elapsed > stats->callback_max)
+        stats->callback_max = elapsed;
+    if (rate && elapsed > duration) {
+        stats->late += 1;
+        if (start - dev->stream_check.last_warn >= SDR_WARN_INTERVAL) {
+            fprintf(stderr, "Processing a %.1f ms buffer took %.1f ms, samples will be lost if this persists (%llu late so far)!\n",
+                    duration * 1000.0, elapsed * 1000.0, stats->late);
+            dev->stream_check.last_warn = start;
+        }
+    }
+}
+
+static void sdr_print_stats(sdr_dev_t *dev)
+{
+    sdr_stats_t const *stats = &dev->stats;
+    fprintf(stderr, "SDR input: %llu samples of %llu expected, %llu lost in %llu gaps, %llu overruns, "
+                    "%llu late callbacks (max %.1f ms), load %.0f%%\n",
+            stats->samples, stats->samples_expected, stats->dropped, stats->gaps, stats->overruns,
+            stats->late, stats->callback_max * 1000.0,
+            stats->buffer_seconds > 0.0 ? stats->callback_seconds * 100.0 / stats->buffer_seconds : 0.0);
+}
+
+#ifdef THREADS
+
+/*
+    The receive thread reads ahead into a queue of buffers so the TCP stream keeps flowing
+    while the callback is busy. If all buffers are waiting to be processed the newest data
+    is dropped (an overrun) rather than backing up the connection to the server.
+*/
+
+static void rtltcp_print_stats(rtltcp_queue_t *q, unsigned buf_num)
+{
+    double stddev = q->received > 2 ? sqrt(q->interval_m2 / (q->received - 2)) : 0.0;
+    fprintf(stderr, "rtl_tcp input: %llu buffers received, %llu overruns, queue max %u of %u, "
+                    "interval %.1f ms (jitter %.1f ms, max %.1f ms)\n",
+            q->received, q->overruns, q->depth_max, buf_num,
+            q->interval_mean * 1e3, stddev * 1e3, q->interval_max * 1e3);
+}
+
+static THREAD_RETURN THREAD_CALL rtltcp_recv_thread(void *arg)
+{
+    sdr_dev_t *dev     = arg;
+    rtltcp_queue_t *q  = &dev->rtl_tcp_queue;
+    unsigned buf_num   = q->buf_num;
+    uint32_t buf_len   = q->buf_len;
+    uint8_t *discard   = NULL;
+    double last_time   = 0.0;
+    double last_warn   = 0.0;
+    int overrun_active = 0;
+
+    while (q->running) {
+        pthread_mutex_lock(&q->lock);
+        int full = q->head - q->tail >= buf_num;
+        pthread_mutex_unlock(&q->lock);
+
+        // only the receive thread writes to the head buffer
+        uint8_t *buffer = &dev->buffer[(q->head % buf_num) * buf_len];
+        if (full) {
+            if (!discard)
+                discard = malloc(buf_len);
+            if (!discard) {
+                WARN_MALLOC("rtltcp_recv_thread()");
+                break;
+            }
+            buffer = discard;
+        }
+
+        int n_read = rtltcp_recv(dev->rtl_tcp, buffer, buf_len, 100); // check q->running every 100 ms
+        if (n_read == 0) {
+            pthread_cond_signal(&q->cond); // let the processing thread check for a stop too
+            continue;
+        }
+
+        double now = time_now_s();
+        pthread_mutex_lock(&q->lock);
+        if (n_read < 0) {
+            q->eof = 1;
+        }
+        else {
+            q->received += 1;
+            if (last_time > 0.0) {
+                // running mean and variance of the arrival interval (Welford)
+                double interval = now - last_time;
+                double delta    = interval - q->interval_mean;
+                q->interval_mean += delta / (q->received - 1);
+                q->interval_m2 += delta * (interval - q->interval_mean);
+                if (interval > q->interval_max)
+                    q->interval_max = interval;
+            }
+            if (full) {
+                q->overruns += 1;
+            }
+            else {
+                q->lens[q->head % buf_num]     = (uint32_t)n_read;
+                q->arrivals[q->head % buf_num] = now;
+                q->head += 1;
+                if (q->head - q->tail > q->depth_max)
+                    q->depth_max = q->head - q->tail;
+            }
+        }
+        pthread_mutex_unlock(&q->lock);
+        pthread_cond_signal(&q->cond);
+        last_time = now;
+
+        if (full && !overrun_active && now - last_warn >= 10.0) {
+            fprintf(stderr, "rtl_tcp input overrun, processing is too slow, dropping samples (%llu buffers so far)!\n", q->overruns);
+            last_warn = now;
+        }
+        overrun_active = full;
+        if (n_read < 0)
+            break;
+    }
+
+    free(discard);
+    return 0;
+}
+
+static int rtltcp_read_loop(sdr_dev_t *dev, sdr_event_cb_t cb, void *ctx, uint32_t buf_num, uint32_t buf_len)
+{
+    rtltcp_queue_t *q = &dev->rtl_tcp_queue;
+    if (dev->rtl_tcp_buffers)
+        buf_num = dev->rtl_tcp_buffers;
+    if (buf_num < RTLTCP_MIN_BUFFERS)
+        buf_num = RTLTCP_MIN_BUFFERS;
+
+    if (rtltcp_alloc_buffers(dev, (size_t)buf_num * buf_len) != 0)
+        return -1;
+
+    free(q->lens);
+    free(q->arrivals);
+    memset(q, 0, sizeof(*q));
+    q->buf_num = buf_num;
+    q->buf_len = buf_len;
+    q->lens = calloc(buf_num, sizeof(*q->lens));
+    if (!q->lens) {
+        WARN_CALLOC("rtltcp_read_loop()");
+        return -1; // NOTE: returns error on alloc failure.
+    }
+    q->arrivals = calloc(buf_num, sizeof(*q->arrivals));
+    if (!q->arrivals) {
+        WARN_CALLOC("rtltcp_read_loop()");
+        return -1; // NOTE: returns error on alloc failure.
+    }
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->cond, NULL);
+    q->running = 1;
+
+#ifndef _WIN32
+    // Block all signals from the receive thread
+    sigset_t sigset;
+    sigset_t oldset;
+    sigfillset(&sigset);
+    pthread_sigmask(SIG_SETMASK, &sigset, &oldset);
+#endif
+    int r = pthread_create(&q->thread, NULL, rtltcp_recv_thread, dev);
+#ifndef _WIN32
+    pthread_sigmask(SIG_SETMASK, &oldset, NULL);
+#endif
+    if (r) {
+        fprintf(stderr, "%s: error in pthread_create, rc: %d\n", __func__, r);
+        pthread_mutex_destroy(&q->lock);
+        pthread_cond_destroy(&q->cond);
+        return -1;
+    }
+
+    unsigned long long last_overruns = 0;
+    dev->running = 1;
+    do {
+        pthread_mutex_lock(&q->lock);
+        while (q->head == q->tail && !q->eof && dev->running)
+            pthread_cond_wait(&q->cond, &q->lock);
+        int has_data = q->head != q->tail;
+        int eof      = q->eof;
+        unsigned pos = q->tail % buf_num;
+        uint32_t len = q->lens[pos];
+        double arrival = q->arrivals[pos];
+        unsigned long long overruns = q->overruns;
+        pthread_mutex_unlock(&q->lock);
+
+        if (overruns > last_overruns) {
+            // the receive thread warns, account the dropped buffers so the arrival checks don't count them again
+            double lost = (double)(overruns - last_overruns) * buf_len / dev->sample_size;
+            dev->stats.overruns += overruns - last_overruns;
+            dev->stats.dropped += (unsigned long long)lost;
+            dev->stats.gaps += 1;
+            dev->stream_check.samples += lost;
+            last_overruns = overruns;
+        }
+
+        if (!has_data) {
+            if (eof)
+                dev->running = 0;
+            continue;
+        }
+
+        sdr_event_t ev = {
+                .ev      = SDR_EV_DATA,
+                .buf     = &dev->buffer[pos * buf_len],
+                .len     = len,
+                .arrival = arrival,
+        };
+        dev->polling = 1;
+        sdr_data_event(dev, cb, ctx, &ev, NULL);
+        dev->polling = 0;
+
+        // the buffer is free for the receive thread again
+        pthread_mutex_lock(&q->lock);
+        q->tail += 1;
+        pthread_mutex_unlock(&q->lock);
+
+        apply_changes(dev, cb, ctx);
+
+    } while (dev->running);
+
+    q->running = 0;
+    pthread_join(q->thread, NULL);
+    pthread_mutex_destroy(&q->lock);
+    pthread_cond_destroy(&q->cond);
+
+    if (q->overruns || dev->verbose)
+        rtltcp_print_stats(q, buf_num);
+
+    return 0;
+}
+
+#else
+
+static int rtltcp_read_loop(sdr_dev_t *dev, sdr_event_cb_t cb, void *ctx, uint32_t buf_num, uint32_t buf_len)
+{
+    size_t buffer_size = buf_num * buf_len;
+    if (rtltcp_alloc_buffers(dev, buffer_size) != 0)
+        return -1;
 
     dev->running = 1;
     do {
@@ -304,34 +782,20 @@ static int rtltcp_read_loop(sdr_dev_t *dev, sdr_event_cb_t cb, void *ctx, uint32
         uint8_t *buffer = &dev->buffer[dev->buffer_pos];
         dev->buffer_pos += buf_len;
 
-        unsigned n_read = 0;
-        int r;
-
-        do {
-            r = recv(dev->rtl_tcp, &buffer[n_read], buf_len - n_read, MSG_WAITALL);
-            if (r <= 0)
-                break;
-            n_read += r;
-            //fprintf(stderr, "readStream ret=%d (of %u)\n", r, n_read);
-        } while (n_read < buf_len);
-        //fprintf(stderr, "readStream ret=%d (read %u)\n", r, n_read);
-
-        if (r < 0) {
-            fprintf(stderr, "WARNING: sync read failed. %d\n", r);
-        }
-        if (n_read == 0) {
-            perror("rtl_tcp");
+        int n_read = rtltcp_recv(dev->rtl_tcp, buffer, buf_len, 0);
+        if (n_read < 0) {
             dev->running = 0;
         }
 
         sdr_event_t ev = {
-                .ev  = SDR_EV_DATA,
-                .buf = buffer,
-                .len = n_read,
+                .ev      = SDR_EV_DATA,
+                .buf     = buffer,
+                .len     = n_read,
+                .arrival = time_now_s(),
         };
         dev->polling = 1;
         if (n_read > 0) // prevent a crash in callback
-            cb(&ev, ctx);
+            sdr_data_event(dev, cb, ctx, &ev, NULL);
         dev->polling = 0;
         apply_changes(dev, cb, ctx);
 
@@ -340,6 +804,8 @@ static int rtltcp_read_loop(sdr_dev_t *dev, sdr_event_cb_t cb, void *ctx, uint32
     return 0;
 }
 
+#endif
+
 #pragma pack(push, 1)
 struct command {
     unsigned char cmd;
@@ -417,6 +883,7 @@ static int sdr_open_rtl(sdr_dev_t **out_dev, char const *dev_query, int verbose)
         WARN_CALLOC("sdr_open_rtl()");
         return -1; // NOTE: returns error on alloc failure.
     }
+    dev->verbose = verbose;
 
     for (uint32_t i = dev_query ? dev_index : 0;
             //cast quiets -Wsign-compare; if dev_index were < 0, would have returned -1 above
@@ -509,12 +976,13 @@ static void rtlsdr_read_cb(unsigned char *iq_buf, uint32_t len, void *ctx)
     memcpy(buffer, iq_buf, len);
 
     sdr_event_t ev = {
-            .ev  = SDR_EV_DATA,
-            .buf = buffer,
-            .len = len,
+            .ev      = SDR_EV_DATA,
+            .buf     = buffer,
+            .len     = len,
+            .arrival = time_now_s(),
     };
     if (len > 0) // prevent a crash in callback
-        dev->rtlsdr_cb(&ev, dev->rtlsdr_cb_ctx);
+        sdr_data_event(dev, dev->rtlsdr_cb, dev->rtlsdr_cb_ctx, &ev, NULL);
 }
 
 static int rtlsdr_read_loop(sdr_dev_t *dev, sdr_event_cb_t cb, void *ctx, uint32_t buf_num, uint32_t buf_len)
@@ -866,6 +1334,7 @@ static int sdr_open_soapy(sdr_dev_t **out_dev, char const *dev_query, int verbos
         WARN_CALLOC("sdr_open_soapy()");
         return -1; // NOTE: returns error on alloc failure.
     }
+    dev->verbose = verbose;
 
     dev->soapy_dev = SoapySDRDevice_makeStrArgs(dev_query);
     if (!dev->soapy_dev) {
@@ -970,11 +1439,13 @@ static int soapysdr_read_loop(sdr_dev_t *dev, sdr_event_cb_t cb, void *ctx, uint
         int16_t *buffer = (void *)&dev->buffer[dev->buffer_pos];
         dev->buffer_pos += buf_len;
 
-        void *buffs[]    = {buffer};
-        int flags        = 0;
-        long long timeNs = 0;
-        long timeoutUs   = 1000000; // 1 second
-        unsigned n_read  = 0, i;
+        void *buffs[]     = {buffer};
+        int flags         = 0;
+        long long timeNs  = 0;
+        int has_time      = 0;
+        long long time_ns = 0; // stream time of the first sample
+        long timeoutUs    = 1000000; // 1 second
+        unsigned n_read   = 0, i;
         int r;
 
         do {
@@ -982,12 +1453,18 @@ static int soapysdr_read_loop(sdr_dev_t *dev, sdr_event_cb_t cb, void *ctx, uint
             r  = SoapySDRDevice_readStream(dev->soapy_dev, dev->soapy_stream, buffs, buf_elems - n_read, &flags, &timeNs, timeoutUs);
             if (r < 0)
                 break;
+            if (n_read == 0) {
+                has_time = flags & SOAPY_SDR_HAS_TIME;
+                time_ns  = timeNs;
+            }
             n_read += r; // r is number of elements read, elements=complex pairs, so buffer length is twice
             //fprintf(stderr, "readStream ret=%d, flags=%d, timeNs=%lld (%zu - %u)\n", r, flags, timeNs, buf_elems, n_read);
         } while (n_read < buf_elems);
         //fprintf(stderr, "readStream ret=%u (%u), flags=%d, timeNs=%lld\n", n_read, buf_len, flags, timeNs);
+        double arrival = time_now_s();
         if (r < 0) {
             if (r == SOAPY_SDR_OVERFLOW) {
+                dev->stats.overruns += 1;
                 fprintf(stderr, "O");
                 fflush(stderr);
                 continue;
@@ -1013,13 +1490,14 @@ static int soapysdr_read_loop(sdr_dev_t *dev, sdr_event_cb_t cb, void *ctx, uint
         }
 
         sdr_event_t ev = {
-                .ev  = SDR_EV_DATA,
-                .buf = buffer,
-                .len = n_read * dev->sample_size,
+                .ev      = SDR_EV_DATA,
+                .buf     = buffer,
+                .len     = n_read * dev->sample_size,
+                .arrival = arrival,
         };
         dev->polling = 1;
         if (n_read > 0) // prevent a crash in callback
-            cb(&ev, ctx);
+            sdr_data_event(dev, cb, ctx, &ev, has_time ? &time_ns : NULL);
         dev->polling = 0;
         apply_changes(dev, cb, ctx);
 
@@ -1086,6 +1564,10 @@ int sdr_close(sdr_dev_t *dev)
         ret = rtlsdr_close(dev->rtlsdr_dev);
 #endif
 
+#ifdef THREADS
+    free(dev->rtl_tcp_queue.lens);
+    free(dev->rtl_tcp_queue.arrivals);
+#endif
     free(dev->dev_info);
     free(dev->buffer);
     free(dev);
@@ -1603,20 +2085,35 @@ int sdr_start(sdr_dev_t *dev, sdr_event_cb_t cb, void *ctx, uint32_t buf_num, ui
     if (buf_len == 0)
         buf_len = SDR_DEFAULT_BUF_LENGTH;
 
+    memset(&dev->stats, 0, sizeof(dev->stats));
+    dev->stream_check.rate = 0;
+
+    int r = -1;
+
     if (dev->rtl_tcp)
-        return rtltcp_read_loop(dev, cb, ctx, buf_num, buf_len);
+        r = rtltcp_read_loop(dev, cb, ctx, buf_num, buf_len);
 
 #ifdef SOAPYSDR
     if (dev->soapy_dev)
-        return soapysdr_read_loop(dev, cb, ctx, buf_num, buf_len);
+        r = soapysdr_read_loop(dev, cb, ctx, buf_num, buf_len);
 #endif
 
 #ifdef RTLSDR
     if (dev->rtlsdr_dev)
-        return rtlsdr_read_loop(dev, cb, ctx, buf_num, buf_len);
+        r = rtlsdr_read_loop(dev, cb, ctx, buf_num, buf_len);
 #endif
 
-    return -1;
+    if (dev->stats.dropped || dev->stats.overruns || dev->verbose)
+        sdr_print_stats(dev);
+    return r;
+}
+
+sdr_stats_t const *sdr_get_stats(sdr_dev_t *dev)
+{
+    if (!dev)
+        return NULL;
+
+    return &dev->stats;
 }
 
 int sdr_stop(sdr_dev_t *dev)
@@ -0,0 +1,382 @@
+/** @file
+    SigMF recordings, a dataset file with a JSON metadata file.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef _MSC_VER
+#include <unistd.h>
+#else
+#include <io.h>
+#define access _access
+#define F_OK 0
+#endif
+
+#include "sigmf.h"
+#include "fileformat.h"
+#include "jsmn.h"
+#include "fatal.h"
+
+/// Allocate "<base><ext>" where base is @p path without a SigMF extension.
+static char *sigmf_path(char const *path, char const *ext)
+{
+    size_t len         = strlen(path);
+    char const *exts[] = {".sigmf-meta", ".sigmf-data", ".sigmf"};
+    for (size_t i = 0; i < sizeof(exts) / sizeof(*exts); ++i) {
+        size_t ext_len = strlen(exts[i]);
+        if (len >= ext_len && !strcmp(&path[len - ext_len], exts[i])) {
+            len -= ext_len;
+            break;
+        }
+    }
+    size_t ext_len = strlen(ext);
+    char *p = malloc(len + ext_len + 1);
+    if (!p)
+        FATAL_MALLOC("sigmf_path()");
+    memcpy(p, path, len);
+    memcpy(&p[len], ext, ext_len + 1);
+    return p;
+}
+
+static char const *datatype_name(uint32_t format)
+{
+    switch (format) {
+    case CU8_IQ:  return "cu8";
+    case CS8_IQ:  return "ci8";
+    case CS16_IQ: return "ci16_le";
+    case CF32_IQ: return "cf32_le";
+    default:      return NULL;
+    }
+}
+
+static uint32_t datatype_format(char const *name, int len)
+{
+    uint32_t formats[] = {CU8_IQ, CS8_IQ, CS16_IQ, CF32_IQ};
+    for (size_t i = 0; i < sizeof(formats) / sizeof(*formats); ++i) {
+        char const *type = datatype_name(formats[i]);
+        if ((int)strlen(type) == len && !strncmp(type, name, len))
+            return formats[i];
+    }
+    return 0;
+}
+
+/* Reading */
+
+static int tok_eq(char const *json, jsmntok_t const *tok, char const *s)
+{
+    return tok->type == JSMN_STRING && (int)strlen(s) == tok->end - tok->start
+            && !strncmp(json + tok->start, s, tok->end - tok->start);
+}
+
+static uint64_t tok_u64(char const *json, jsmntok_t const *tok)
+{
+    return tok->type == JSMN_PRIMITIVE ? strtoull(json + tok->start, NULL, 10) : 0;
+}
+
+/// Index of the token after the value at @p i, objects and arrays are skipped whole.
+static int tok_next(jsmntok_t const *tok, int i)
+{
+    int pending = 1;
+    while (pending--)
+        pending += tok[i++].size;
+    return i;
+}
+
+static int compare_annotations(void const *a, void const *b)
+{
+    sigmf_annotation_t const *x = a;
+    sigmf_annotation_t const *y = b;
+    return x->sample_start < y->sample_start ? -1 : x->sample_start > y->sample_start;
+}
+
+static char *read_file(char const *path, size_t *len)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return NULL;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    rewind(file);
+    char *buf = malloc(size > 0 ? (size_t)size + 1 : 1);
+    if (!buf)
+        FATAL_MALLOC("read_file()");
+    *len = size > 0 ? fread(buf, 1, (size_t)size, file) : 0;
+    buf[*len] = '\0';
+    fclose(file);
+    return buf;
+}
+
+int sigmf_meta_read(sigmf_meta_t *meta, char const *path)
+{
+    *meta = (sigmf_meta_t){0};
+    char *meta_path = sigmf_path(path, ".sigmf-meta");
+    size_t len = 0;
+    char *json = read_file(meta_path, &len);
+    if (!json) {
+        fprintf(stderr, "Opening SigMF meta file: %s failed!\n", meta_path);
+        free(meta_path);
+        return -1;
+    }
+
+    jsmn_parser parser;
+    jsmn_init(&parser);
+    int num_toks = jsmn_parse(&parser, json, len, NULL, 0);
+    jsmntok_t *tok = calloc(num_toks > 0 ? num_toks : 1, sizeof(*tok));
+    if (!tok)
+        FATAL_CALLOC("sigmf_meta_read()");
+    jsmn_init(&parser);
+    if (num_toks <= 0 || jsmn_parse(&parser, json, len, tok, num_toks) != num_toks || tok[0].type != JSMN_OBJECT) {
+        fprintf(stderr, "Invalid SigMF meta file: %s\n", meta_path);
+        free(tok);
+        free(json);
+        free(meta_path);
+        return -1;
+    }
+
+    // walk the top level object
+    for (int i = 1; i < num_toks; i = tok_next(tok, i + 1)) {
+        jsmntok_t const *val = &tok[i + 1];
+        if (tok_eq(json, &tok[i], "global") && val->type == JSMN_OBJECT) {
+            for (int j = i + 2; j < tok_next(tok, i + 1); j = tok_next(tok, j + 1)) {
+                if (tok_eq(json, &tok[j], "core:datatype"))
+                    meta->format = datatype_format(json + tok[j + 1].start, tok[j + 1].end - tok[j + 1].start);
+                else if (tok_eq(json, &tok[j], "core:sample_rate"))
+                    meta->sample_rate = (uint32_t)strtod(json + tok[j + 1].start, NULL);
+            }
+        }
+        else if (tok_eq(json, &tok[i], "captures") && val->type == JSMN_ARRAY && val->size > 0) {
+            int obj = i + 2; // the first capture
+            for (int j = obj + 1; j < tok_next(tok, obj); j = tok_next(tok, j + 1)) {
+                if (tok_eq(json, &tok[j], "core:frequency"))
+                    meta->frequency = (uint32_t)strtod(json + tok[j + 1].start, NULL);
+            }
+        }
+        else if (tok_eq(json, &tok[i], "annotations") && val->type == JSMN_ARRAY && val->size > 0) {
+            meta->annotations = calloc(val->size, sizeof(*meta->annotations));
+            if (!meta->annotations)
+                FATAL_CALLOC("sigmf_meta_read()");
+            int obj = i + 2;
+            for (int n = 0; n < val->size; ++n, obj = tok_next(tok, obj)) {
+                if (tok[obj].type != JSMN_OBJECT)
+                    continue;
+                sigmf_annotation_t *a = &meta->annotations[meta->num_annotations++];
+                for (int j = obj + 1; j < tok_next(tok, obj); j = tok_next(tok, j + 1)) {
+                    if (tok_eq(json, &tok[j], "core:sample_start"))
+                        a->sample_start = tok_u64(json, &tok[j + 1]);
+                    else if (tok_eq(json, &tok[j], "core:sample_count"))
+                        a->sample_count = tok_u64(json, &tok[j + 1]);
+                }
+            }
+            qsort(meta->annotations, meta->num_annotations, sizeof(*meta->annotations), compare_annotations);
+        }
+    }
+    free(tok);
+    free(json);
+
+    if (!meta->format || !meta->sample_rate) {
+        fprintf(stderr, "Unsupported SigMF datatype or sample rate in: %s\n", meta_path);
+        free(meta_path);
+        sigmf_meta_free(meta);
+        return -1;
+    }
+    free(meta_path);
+    meta->data_path = sigmf_path(path, ".sigmf-data");
+    return 0;
+}
+
+size_t sigmf_meta_regions(sigmf_meta_t *meta, uint64_t pad)
+{
+    size_t num_regions = 0;
+    for (size_t i = 0; i < meta->num_annotations; ++i) {
+        sigmf_annotation_t const *a = &meta->annotations[i];
+        uint64_t start = a->sample_start > pad ? a->sample_start - pad : 0;
+        uint64_t end   = a->sample_start + a->sample_count + pad;
+        sigmf_annotation_t *last = num_regions ? &meta->annotations[num_regions - 1] : NULL;
+        if (last && start <= last->sample_start + last->sample_count) {
+            // overlaps the previous region, extend it
+            if (end > last->sample_start + last->sample_count)
+                last->sample_count = end - last->sample_start;
+            continue;
+        }
+        sigmf_annotation_t *region = &meta->annotations[num_regions++];
+        region->sample_start = start;
+        region->sample_count = end - start;
+    }
+    meta->num_annotations = num_regions;
+    return num_regions;
+}
+
+void sigmf_meta_free(sigmf_meta_t *meta)
+{
+    free(meta->data_path);
+    free(meta->annotations);
+    *meta = (sigmf_meta_t){0};
+}
+
+/* Writing */
+
+sigmf_writer_t *sigmf_writer_open(char const *path, int overwrite)
+{
+    sigmf_writer_t *writer = calloc(1, sizeof(*writer));
+    if (!writer)
+        FATAL_CALLOC("sigmf_writer_open()");
+
+    writer->meta_path = sigmf_path(path, ".sigmf-meta");
+    char *data_path   = sigmf_path(path, ".sigmf-data");
+    if (!overwrite && (access(writer->meta_path, F_OK) == 0 || access(data_path, F_OK) == 0)) {
+        fprintf(stderr, "Output file %s already exists, exiting\n", path);
+    }
+    else if (!(writer->data = fopen(data_path, "wb"))) {
+        fprintf(stderr, "Failed to open %s\n", data_path);
+    }
+    free(data_path);
+    if (!writer->data) {
+        free(writer->meta_path);
+        free(writer);
+        return NULL;
+    }
+    return writer;
+}
+
+int sigmf_writer_write(sigmf_writer_t *writer, void const *buf, size_t len,
+        uint32_t format, uint32_t sample_rate, uint32_t frequency)
+{
+    if (!writer->num_samples) {
+        writer->format      = format;
+        writer->sample_rate = sample_rate;
+        writer->start_time  = time(NULL);
+    }
+    if (!writer->num_captures || writer->captures[writer->num_captures - 1].frequency != frequency) {
+        sigmf_capture_t *captures = realloc(writer->captures, (writer->num_captures + 1) * sizeof(*captures));
+        if (!captures)
+            FATAL_REALLOC("sigmf_writer_write()");
+        writer->captures = captures;
+        writer->captures[writer->num_captures++] = (sigmf_capture_t){writer->num_samples, frequency};
+    }
+
+    if (fwrite(buf, 1, len, writer->data) != len)
+        return -1;
+    writer->num_samples += len / (format == CU8_IQ ? 2 : 4);
+    return 0;
+}
+
+void sigmf_writer_annotate(sigmf_writer_t *writer, uint64_t start_ago, uint64_t end_ago,
+        char const *label, char const *comment)
+{
+    if (start_ago > writer->num_samples)
+        start_ago = writer->num_samples; // starts before the recording
+    if (end_ago >= start_ago)
+        return;
+
+    if (writer->num_annotations >= writer->size_annotations) {
+        writer->size_annotations = writer->size_annotations ? writer->size_annotations * 2 : 64;
+        sigmf_annotation_t *annotations = realloc(writer->annotations, writer->size_annotations * sizeof(*annotations));
+        if (!annotations)
+            FATAL_REALLOC("sigmf_writer_annotate()");
+        writer->annotations = annotations;
+    }
+    sigmf_annotation_t *a = &writer->annotations[writer->num_annotations++];
+    a->sample_start = writer->num_samples - start_ago;
+    a->sample_count = start_ago - end_ago;
+    a->label        = NULL;
+    a->comment      = NULL;
+    if (label && *label) {
+        a->label = strdup(label);
+        if (!a->label)
+            FATAL_STRDUP("sigmf_writer_annotate()");
+    }
+    if (comment) {
+        a->comment = strdup(comment);
+        if (!a->comment)
+            FATAL_STRDUP("sigmf_writer_annotate()");
+    }
+}
+
+/// Print a JSON string, the labels are plain model names but escape anyway.
+static void print_json_string(FILE *file, char const *s)
+{
+    fputc('"', file);
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\')
+            fputc('\\', file);
+        if ((unsigned char)*s >= ' ')
+            fputc(*s, file);
+    }
+    fputc('"', file);
+}
+
+void sigmf_writer_close(sigmf_writer_t *writer)
+{
+    if (!writer)
+        return;
+    fclose(writer->data);
+
+    FILE *meta = fopen(writer->meta_path, "wb");
+    if (!meta) {
+        fprintf(stderr, "Failed to open %s\n", writer->meta_path);
+    }
+    else {
+        char datetime[32] = "";
+        struct tm tm_info;
+#ifdef _WIN32
+        gmtime_s(&tm_info, &writer->start_time);
+#else
+        gmtime_r(&writer->start_time, &tm_info);
+#endif
+        strftime(datetime, sizeof(datetime), "%Y-%m-%dT%H:%M:%SZ", &tm_info);
+
+        char const *datatype = datatype_name(writer->format);
+        fprintf(meta, "{\n    \"global\": {\n");
+        fprintf(meta, "        \"core:datatype\": \"%s\",\n", datatype ? datatype : "cu8");
+        fprintf(meta, "        \"core:sample_rate\": %u,\n", writer->sample_rate);
+        fprintf(meta, "        \"core:recorder\": \"rtl_433\",\n");
+        fprintf(meta, "        \"core:version\": \"1.0.0\"\n");
+        fprintf(meta, "    },\n    \"captures\": [");
+        for (size_t i = 0; i < writer->num_captures; ++i) {
+            fprintf(meta, "%s\n        {\"core:sample_start\": %llu, \"core:frequency\": %u",
+                    i ? "," : "", (unsigned long long)writer->captures[i].sample_start, writer->captures[i].frequency);
+            if (i == 0)
+                fprintf(meta, ", \"core:datetime\": \"%s\"", datetime);
+            fprintf(meta, "}");
+        }
+        fprintf(meta, "\n    ],\n    \"annotations\": [");
+        // packages are detected in order of their end, sort by start
+        qsort(writer->annotations, writer->num_annotations, sizeof(*writer->annotations), compare_annotations);
+        for (size_t i = 0; i < writer->num_annotations; ++i) {
+            sigmf_annotation_t const *a = &writer->annotations[i];
+            fprintf(meta, "%s\n        {\"core:sample_start\": %llu, \"core:sample_count\": %llu",
+                    i ? "," : "", (unsigned long long)a->sample_start, (unsigned long long)a->sample_count);
+            if (a->label) {
+                fprintf(meta, ", \"core:label\": ");
+                print_json_string(meta, a->label);
+            }
+            if (a->comment) {
+                fprintf(meta, ", \"core:comment\": ");
+                print_json_string(meta, a->comment);
+            }
+            fprintf(meta, "}");
+        }
+        fprintf(meta, "\n    ]\n}\n");
+        if (fclose(meta) != 0)
+            fprintf(stderr, "Short write on %s\n", writer->meta_path);
+    }
+
+    for (size_t i = 0; i < writer->num_annotations; ++i) {
+        free(writer->annotations[i].label);
+        free(writer->annotations[i].comment);
+    }
+    free(writer->annotations);
+    free(writer->captures);
+    free(writer->meta_path);
+    free(writer);
+}
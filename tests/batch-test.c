@@ -0,0 +1,157 @@
+/** @file
+    Batch mode event serialization tests.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "data.h"
+#include "list.h"
+#include "fileformat.h"
+#include "batch.h"
+
+#define SPLIT_RATE   32000 // sample rate of the generated file
+#define SPLIT_SECS   40    // length of the generated file
+#define BURST_PERIOD 2     // a burst every 2 seconds
+#define BURST_MS     50    // burst length
+
+/// Write a CU8 file with short bursts of a carrier in low noise.
+static int write_bursts(char const *path)
+{
+    FILE *file = fopen(path, "wb");
+    if (!file)
+        return -1;
+    unsigned char iq[2];
+    for (unsigned i = 0; i < SPLIT_RATE * SPLIT_SECS; ++i) {
+        unsigned pos = i % (SPLIT_RATE * BURST_PERIOD);
+        if (pos < SPLIT_RATE * BURST_MS / 1000) {
+            iq[0] = i & 1 ? 255 : 0;
+            iq[1] = 128;
+        }
+        else {
+            iq[0] = 127 + (i & 1);
+            iq[1] = 128 + (i & 2) / 2;
+        }
+        fwrite(iq, 1, 2, file);
+    }
+    return fclose(file);
+}
+
+/// Check if a cut at @p sample is outside of all bursts.
+static int is_silent(uint64_t sample)
+{
+    return sample % (SPLIT_RATE * BURST_PERIOD) >= SPLIT_RATE * BURST_MS / 1000;
+}
+
+static data_t *make_event(void)
+{
+    return data_make(
+            "model",            "",             DATA_STRING, "Test",
+            "id",               "ID",           DATA_INT,    42,
+            "temperature_C",    "Temperature",  DATA_FORMAT, "%.1f C", DATA_DOUBLE, 21.5,
+            "codes",            "",             DATA_ARRAY,  data_array(2, DATA_STRING, (char *[2]){"{8}ab", "{8}cd"}),
+            "levels",           "",             DATA_ARRAY,  data_array(3, DATA_INT, (int[3]){1, -2, 3}),
+            "nested",           "",             DATA_DATA,   data_make("count", "", DATA_INT, 3, NULL),
+            NULL);
+}
+
+static data_t *find_key(data_t *data, char const *key)
+{
+    for (; data; data = data->next)
+        if (!strcmp(data->key, key))
+            return data;
+    return NULL;
+}
+
+#define ASSERT_EQUALS(a, b) \
+    do { \
+        if ((a) == (b)) \
+            ++passed; \
+        else { \
+            ++failed; \
+            fprintf(stderr, "FAIL line %d: %d <> %d\n", __LINE__, (int)(a), (int)(b)); \
+        } \
+    } while (0)
+
+#define ASSERT_STR_EQUALS(a, b) \
+    do { \
+        if (!strcmp((a), (b))) \
+            ++passed; \
+        else { \
+            ++failed; \
+            fprintf(stderr, "FAIL line %d: \"%s\" <> \"%s\"\n", __LINE__, (a), (b)); \
+        } \
+    } while (0)
+
+int main(void)
+{
+    unsigned passed = 0;
+    unsigned failed = 0;
+    char buf[1024];
+    char json_in[1024];
+    char json_out[1024];
+
+    fprintf(stderr, "batch:: test\n");
+
+    fprintf(stderr, "batch:: pack and unpack\n");
+    data_t *data = make_event();
+    size_t len = batch_pack(data, NULL, 0);
+    ASSERT_EQUALS(len < sizeof(buf), 1);
+    ASSERT_EQUALS(batch_pack(data, buf, sizeof(buf)), len);
+    data_t *copy = batch_unpack(buf, len);
+    ASSERT_EQUALS(copy != NULL, 1);
+    data_print_jsons(data, json_in, sizeof(json_in));
+    data_print_jsons(copy, json_out, sizeof(json_out));
+    ASSERT_STR_EQUALS(json_out, json_in);
+    data_t *temp = find_key(copy, "temperature_C");
+    ASSERT_EQUALS(temp != NULL, 1);
+    ASSERT_STR_EQUALS(temp->pretty_key, "Temperature");
+    ASSERT_STR_EQUALS(temp->format, "%.1f C");
+    ASSERT_EQUALS(find_key(copy, "id")->format == NULL, 1);
+    data_free(copy);
+
+    fprintf(stderr, "batch:: malformed input\n");
+    ASSERT_EQUALS(batch_unpack(buf, len - 1) == NULL, 1); // truncated
+    buf[len] = 0;
+    ASSERT_EQUALS(batch_unpack(buf, len + 1) == NULL, 1); // trailing bytes
+    buf[0] = 0x7f;
+    ASSERT_EQUALS(batch_unpack(buf, len) == NULL, 1); // bad type
+    data_free(data);
+
+    fprintf(stderr, "batch:: split at silent gaps\n");
+    char path[] = "batch-test.cu8";
+    ASSERT_EQUALS(write_bursts(path), 0);
+    list_t inputs = {0};
+    int added = batch_split_file(&inputs, path, path, CU8_IQ, SPLIT_RATE, 4);
+    ASSERT_EQUALS(added, (int)inputs.len);
+    ASSERT_EQUALS(added >= 2 && added <= 4, 1);
+    uint64_t next = 0;
+    for (size_t i = 0; i < inputs.len; ++i) {
+        batch_input_t *input = inputs.elems[i];
+        ASSERT_EQUALS(input->start, next); // contiguous
+        if (i > 0)
+            ASSERT_EQUALS(is_silent(input->start), 1);
+        next = input->end;
+        if (i + 1 < inputs.len)
+            ASSERT_EQUALS(input->end - input->start >= SPLIT_RATE * 10, 1);
+    }
+    ASSERT_EQUALS(next, 0); // last segment to the end
+    list_free_elems(&inputs, free);
+
+    added = batch_split_file(&inputs, path, path, CU8_IQ, SPLIT_RATE, 1);
+    ASSERT_EQUALS(added, 1); // too short to split into 10 s segments
+    list_free_elems(&inputs, free);
+    remove(path);
+
+    fprintf(stderr, "batch:: test (%u/%u) passed, (%u) failed.\n", passed, passed + failed, failed);
+
+    return failed;
+}
@@ -0,0 +1,257 @@
+#!/usr/bin/env python3
+
+"""Benchmark rtl_433 throughput and accuracy over a corpus of sample files.
+
+The corpus follows the rtl_433_tests layout: sample files (e.g. .cu8) with the expected
+events as JSON lines in a file of the same name with a .json extension.
+Samples without an expected file are only timed.
+
+Reports the samples processed per second (MS/s), CPU time per processing stage,
+the startup time (to the first sample buffer), events decoded, and the differences to the expected events.
+A machine-readable summary (--summary) can be compared to a previous run (--baseline).
+"""
+
+import sys
+import os
+import argparse
+import subprocess
+import json
+import time
+
+SAMPLE_EXTENSIONS = ('.cu8', '.cs8', '.cs16', '.cf32')
+STAGES = ('demod', 'detect', 'decode', 'output')
+
+
+def find_samples(paths):
+    """Find all sample files, sorted for a stable order."""
+    samples = []
+    for path in paths:
+        if os.path.isfile(path):
+            samples.append(path)
+            continue
+        for root, dirs, files in os.walk(path):
+            dirs.sort()
+            for name in sorted(files):
+                if name.lower().endswith(SAMPLE_EXTENSIONS):
+                    samples.append(os.path.join(root, name))
+    return samples
+
+
+def expected_path(sample):
+    """The expected events file for a sample file, None if there is none."""
+    path = os.path.splitext(sample)[0] + '.json'
+    return path if os.path.isfile(path) else None
+
+
+def read_events(lines):
+    """Parse JSON lines, returns events and the stats report."""
+    events = []
+    report = None
+    for line in lines:
+        line = line.strip()
+        if not line:
+            continue
+        try:
+            obj = json.loads(line)
+        except ValueError:
+            continue
+        if 'enabled' in obj and 'frames' in obj:
+            report = obj
+        else:
+            events.append(obj)
+    return events, report
+
+
+def canonical(event, ignore):
+    """A comparable string of an event, without the ignored keys."""
+    return json.dumps({k: v for k, v in event.items() if k not in ignore}, sort_keys=True)
+
+
+def compare(expected, decoded, ignore):
+    """Match events as multisets, returns the missing and extra events."""
+    remaining = {}
+    for event in expected:
+        key = canonical(event, ignore)
+        remaining[key] = remaining.get(key, 0) + 1
+    extra = []
+    for event in decoded:
+        key = canonical(event, ignore)
+        if remaining.get(key, 0) > 0:
+            remaining[key] -= 1
+        else:
+            extra.append(key)
+    missing = [key for key, count in remaining.items() for _ in range(count)]
+    return missing, extra
+
+
+def run_sample(rtl_433, sample, args):
+    """Run rtl_433 on a sample file, returns the events, the stats report, and the wall time."""
+    cmd = [rtl_433, '-c', '0', '-F', 'json', '-M', 'stats:1:0'] + args + ['-r', sample]
+    start = time.perf_counter()
+    proc = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL)
+    wall = time.perf_counter() - start
+    events, report = read_events(proc.stdout.decode('utf-8', 'replace').splitlines())
+    return events, report, wall, proc.returncode
+
+
+def bench(options):
+    samples = find_samples(options.paths)
+    if not samples:
+        print("No sample files found in %s" % ', '.join(options.paths), file=sys.stderr)
+        return None
+
+    ignore = set(options.ignore.split(',')) if options.ignore else set()
+    totals = {
+        'files': 0,
+        'failed': 0,
+        'samples': 0,
+        'wall_seconds': 0.0,
+        'cpu_ms': {stage: 0.0 for stage in STAGES},
+        'startup_ms': 0.0,
+        'events': 0,
+        'expected': 0,
+        'missing': 0,
+        'extra': 0,
+    }
+    files = []
+    startups = []
+
+    for sample in samples:
+        best = None
+        for _ in range(options.repeat):
+            run = run_sample(options.rtl_433, sample, options.args)
+            if not best or run[2] < best[2]:
+                best = run
+        events, report, wall, returncode = best
+
+        pipeline = report.get('pipeline', {}) if report else {}
+        entry = {
+            'file': sample,
+            'returncode': returncode,
+            'samples': int(pipeline.get('samples', 0)),
+            'wall_seconds': round(wall, 6),
+            'cpu_ms': pipeline.get('cpu_ms', {}),
+            'startup_ms': pipeline.get('startup_ms', 0.0),
+            'events': len(events),
+        }
+        if 'startup_ms' in pipeline:
+            startups.append(pipeline['startup_ms'])
+
+        expected_file = expected_path(sample)
+        if expected_file:
+            with open(expected_file, 'r') as file:
+                expected, _ = read_events(file)
+            missing, extra = compare(expected, events, ignore)
+            entry['expected'] = len(expected)
+            entry['missing'] = len(missing)
+            entry['extra'] = len(extra)
+            totals['expected'] += len(expected)
+            totals['missing'] += len(missing)
+            totals['extra'] += len(extra)
+            if options.verbose and (missing or extra):
+                print("%s:" % sample)
+                for key in missing:
+                    print("  - %s" % key)
+                for key in extra:
+                    print("  + %s" % key)
+
+        if returncode != 0 or not report:
+            totals['failed'] += 1
+        totals['files'] += 1
+        totals['samples'] += entry['samples']
+        totals['wall_seconds'] += wall
+        totals['events'] += len(events)
+        for stage in STAGES:
+            totals['cpu_ms'][stage] += entry['cpu_ms'].get(stage, 0.0)
+        files.append(entry)
+
+    totals['wall_seconds'] = round(totals['wall_seconds'], 6)
+    totals['msps'] = round(totals['samples'] / totals['wall_seconds'] / 1e6, 3) if totals['wall_seconds'] else 0.0
+    cpu_seconds = sum(totals['cpu_ms'].values()) / 1000.0
+    totals['pipeline_msps'] = round(totals['samples'] / cpu_seconds / 1e6, 3) if cpu_seconds else 0.0
+    totals['cpu_ms'] = {stage: round(ms, 3) for stage, ms in totals['cpu_ms'].items()}
+    # the median of the runs, the startup does not depend on the sample file
+    if startups:
+        totals['startup_ms'] = round(sorted(startups)[len(startups) // 2], 3)
+
+    return {
+        'version': 1,
+        'rtl_433': options.rtl_433,
+        'args': options.args,
+        'corpus': options.paths,
+        'totals': totals,
+        'files': files,
+    }
+
+
+def ratio(new, old):
+    return "%+.1f%%" % ((new / old - 1.0) * 100.0) if old else "n/a"
+
+
+def print_summary(summary, baseline):
+    totals = summary['totals']
+    base = baseline['totals'] if baseline else None
+
+    def line(label, key, fmt):
+        text = "%-24s" % label + fmt % totals[key]
+        if base and key in base:
+            text += "  (%s)" % ratio(totals[key], base[key])
+        print(text)
+
+    line("Files:", 'files', "%d")
+    line("Failed runs:", 'failed', "%d")
+    line("Samples:", 'samples', "%d")
+    line("Wall time:", 'wall_seconds', "%.3f s")
+    line("Throughput:", 'msps', "%.3f MS/s")
+    line("Pipeline throughput:", 'pipeline_msps', "%.3f MS/s")
+    line("Startup (first sample):", 'startup_ms', "%.3f ms")
+    for stage in STAGES:
+        text = "%-24s%.3f ms" % ("CPU %s:" % stage, totals['cpu_ms'][stage])
+        if base:
+            text += "  (%s)" % ratio(totals['cpu_ms'][stage], base['cpu_ms'].get(stage, 0.0))
+        print(text)
+    line("Events:", 'events', "%d")
+    line("Expected events:", 'expected', "%d")
+    line("Missing events:", 'missing', "%d")
+    line("Extra events:", 'extra', "%d")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('paths', nargs='+', help="sample files or directories (rtl_433_tests layout)")
+    parser.add_argument('--rtl-433', default='rtl_433', help="rtl_433 binary to run (default: rtl_433)")
+    parser.add_argument('--args', default='', help="extra arguments to rtl_433, e.g. \"-R 0 -X ...\"")
+    parser.add_argument('--ignore', default='time', help="comma separated keys not compared (default: time)")
+    parser.add_argument('--repeat', type=int, default=1, help="runs per file, the fastest run counts (default: 1)")
+    parser.add_argument('--summary', help="write a JSON summary to this file")
+    parser.add_argument('--baseline', help="compare to the JSON summary of a previous run")
+    parser.add_argument('--strict', action='store_true', help="exit with an error on missing or extra events")
+    parser.add_argument('-v', '--verbose', action='store_true', help="list the missing (-) and extra (+) events")
+    options = parser.parse_args()
+    options.args = options.args.split()
+    options.repeat = max(options.repeat, 1)
+
+    summary = bench(options)
+    if not summary:
+        return 1
+
+    baseline = None
+    if options.baseline:
+        with open(options.baseline, 'r') as file:
+            baseline = json.load(file)
+
+    print_summary(summary, baseline)
+
+    if options.summary:
+        with open(options.summary, 'w') as file:
+            json.dump(summary, file, indent=2)
+            file.write('\n')
+
+    totals = summary['totals']
+    if totals['failed'] or (options.strict and (totals['missing'] or totals['extra'])):
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
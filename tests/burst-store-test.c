@@ -0,0 +1,148 @@
+/** @file
+    Burst store tests.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "burst_store.h"
+#include "fileformat.h"
+
+#define ASSERT_EQUALS(a, b) \
+    do { \
+        if ((a) == (b)) \
+            ++passed; \
+        else { \
+            ++failed; \
+            fprintf(stderr, "FAIL line %d: %d <> %d\n", __LINE__, (int)(a), (int)(b)); \
+        } \
+    } while (0)
+
+static burst_info_t make_info(uint64_t time_us, uint32_t num_samples, char const *models)
+{
+    burst_info_t info = {0};
+    info.time_us          = time_us;
+    info.center_frequency = 433920000;
+    info.sample_rate      = 250000;
+    info.format           = CU8_IQ;
+    info.num_samples      = num_samples;
+    info.rssi_db          = -3.5f;
+    info.snr_db           = 20.0f;
+    info.noise_db         = -23.5f;
+    info.events           = models[0] ? 1 : 0;
+    snprintf(info.models, sizeof(info.models), "%s", models);
+    return info;
+}
+
+int main(void)
+{
+    unsigned passed = 0;
+    unsigned failed = 0;
+    char const *path       = "burst-store-test.burst";
+    char const *index_path = "burst-store-test.burst.idx";
+    uint8_t samples[200];
+    for (unsigned i = 0; i < sizeof(samples); ++i)
+        samples[i] = (uint8_t)i;
+
+    fprintf(stderr, "burst_store:: test\n");
+
+    fprintf(stderr, "burst_store:: write and append\n");
+    burst_store_t *store = burst_store_open(path, 1);
+    ASSERT_EQUALS(store != NULL, 1);
+    burst_info_t info = make_info(1000000, 50, "Test,Other");
+    ASSERT_EQUALS(burst_store_write(store, &info, samples, 100, NULL, 0), 0);
+    info = make_info(2000000, 100, "");
+    ASSERT_EQUALS(burst_store_write(store, &info, samples, 60, &samples[60], 140), 0); // in two parts
+    burst_store_close(store);
+    store = burst_store_open(path, 0);
+    ASSERT_EQUALS(store != NULL, 1);
+    info = make_info(3000000, 10, "Test");
+    ASSERT_EQUALS(burst_store_write(store, &info, samples, 20, NULL, 0), 0);
+    burst_store_close(store);
+
+    fprintf(stderr, "burst_store:: read back\n");
+    FILE *file = fopen(path, "rb");
+    ASSERT_EQUALS(file != NULL, 1);
+    ASSERT_EQUALS(burst_store_read_header(file), 0);
+    uint8_t *buf    = NULL;
+    size_t buf_size = 0;
+    ASSERT_EQUALS(burst_store_read(file, &info, &buf, &buf_size), 100);
+    ASSERT_EQUALS(info.time_us == 1000000, 1);
+    ASSERT_EQUALS(info.num_samples, 50);
+    ASSERT_EQUALS(info.sample_rate, 250000);
+    ASSERT_EQUALS(info.format, CU8_IQ);
+    ASSERT_EQUALS(info.rssi_db == -3.5f, 1);
+    ASSERT_EQUALS(strcmp(info.models, "Test,Other"), 0);
+    ASSERT_EQUALS(memcmp(buf, samples, 100), 0);
+    ASSERT_EQUALS(burst_store_read(file, &info, &buf, &buf_size), 200);
+    ASSERT_EQUALS(info.events, 0);
+    ASSERT_EQUALS(info.models[0], '\0');
+    ASSERT_EQUALS(memcmp(buf, samples, 200), 0);
+    ASSERT_EQUALS(burst_store_read(file, &info, &buf, &buf_size), 20);
+    ASSERT_EQUALS(info.time_us == 3000000, 1);
+    ASSERT_EQUALS(burst_store_read(file, &info, &buf, &buf_size), 0); // end
+    fclose(file);
+    free(buf);
+
+    fprintf(stderr, "burst_store:: index\n");
+    FILE *index = fopen(index_path, "rb");
+    ASSERT_EQUALS(index != NULL, 1);
+    uint64_t offset = 0;
+    ASSERT_EQUALS(burst_store_read_index(index, 2, &offset, &info), 0);
+    ASSERT_EQUALS(info.time_us == 3000000, 1);
+    ASSERT_EQUALS(info.num_samples, 10);
+    ASSERT_EQUALS(burst_store_read_index(index, 3, &offset, &info), -1);
+    ASSERT_EQUALS(burst_store_read_index(index, 1, &offset, &info), 0);
+    fclose(index);
+    // seek to a record by index
+    file = fopen(path, "rb");
+    ASSERT_EQUALS(file != NULL, 1);
+    fseek(file, (long)offset, SEEK_SET);
+    buf      = NULL;
+    buf_size = 0;
+    ASSERT_EQUALS(burst_store_read(file, &info, &buf, &buf_size), 200);
+    ASSERT_EQUALS(info.time_us == 2000000, 1);
+    fclose(file);
+    free(buf);
+
+    fprintf(stderr, "burst_store:: reject a corrupt sample count\n");
+    store = burst_store_open(path, 1);
+    ASSERT_EQUALS(store != NULL, 1);
+    info = make_info(1000000, 50, "");
+    ASSERT_EQUALS(burst_store_write(store, &info, samples, 100, NULL, 0), 0);
+    burst_store_close(store);
+    file = fopen(path, "r+b");
+    ASSERT_EQUALS(file != NULL, 1);
+    fseek(file, 16 + 28, SEEK_SET); // num_samples of the first record
+    fwrite("\xff\xff\xff\x7f", 1, 4, file);
+    rewind(file);
+    ASSERT_EQUALS(burst_store_read_header(file), 0);
+    buf      = NULL;
+    buf_size = 0;
+    ASSERT_EQUALS(burst_store_read(file, &info, &buf, &buf_size), -1);
+    ASSERT_EQUALS(buf_size, 0); // nothing allocated
+    fclose(file);
+    free(buf);
+
+    fprintf(stderr, "burst_store:: refuse to append to other files\n");
+    file = fopen(path, "wb");
+    ASSERT_EQUALS(file != NULL, 1);
+    fputs("not a burst store", file);
+    fclose(file);
+    ASSERT_EQUALS(burst_store_open(path, 0) == NULL, 1);
+
+    remove(path);
+    remove(index_path);
+
+    fprintf(stderr, "burst_store:: test (%u/%u) passed, (%u) failed.\n", passed, passed + failed, failed);
+
+    return failed;
+}
@@ -0,0 +1,110 @@
+/** @file
+    CSV output tests.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "data.h"
+#include "output_file.h"
+
+static char out[4096];
+
+/// Read all output written to @p file so far.
+static char const *read_back(FILE *file)
+{
+    fflush(file);
+    rewind(file);
+    size_t len = fread(out, 1, sizeof(out) - 1, file);
+    out[len] = '\0';
+    fseek(file, 0, SEEK_END); // continue writing at the end
+    return out;
+}
+
+#define ASSERT_OUTPUT(expect) \
+    do { \
+        char const *got = read_back(file); \
+        if (!strcmp(got, expect)) \
+            ++passed; \
+        else { \
+            ++failed; \
+            fprintf(stderr, "FAIL line %d: got \"%s\"\n", __LINE__, got); \
+        } \
+    } while (0)
+
+int main(void)
+{
+    unsigned passed = 0;
+    unsigned failed = 0;
+
+    fprintf(stderr, "csv:: test\n");
+
+    FILE *file = tmpfile();
+    if (!file) {
+        fprintf(stderr, "csv:: can't open a temporary file\n");
+        return 1;
+    }
+
+    char const *fields[] = {"time", "model", "id", "temperature_C", "model", "codes", "label", "array", "id"};
+    data_output_t *output = data_output_csv_create(file);
+    data_output_start(output, fields, sizeof(fields) / sizeof(*fields));
+
+    fprintf(stderr, "csv:: header with unique fields\n");
+    ASSERT_OUTPUT("time,model,id,temperature_C,codes,label,array\n");
+
+    fprintf(stderr, "csv:: rows in column order\n");
+    data_t *data = data_make(
+            "model",            "", DATA_STRING, "Test",
+            "id",               "", DATA_INT,    42,
+            "temperature_C",    "", DATA_DOUBLE, 21.5,
+            "label",            "", DATA_STRING, "a,b",
+            "unknown",          "", DATA_INT,    1,
+            "id",               "", DATA_INT,    7,
+            NULL);
+    data_output_print(output, data);
+    data_free(data);
+    data = data_make(
+            "time",             "", DATA_STRING, "2021-01-01 00:00:00",
+            "model",            "", DATA_STRING, "Test",
+            "array",            "", DATA_ARRAY,  data_array(3, DATA_INT, (int[3]){1, 2, 3}),
+            "nested",           "", DATA_DATA,   data_make("id", "", DATA_INT, 9, NULL),
+            NULL);
+    data_output_print(output, data);
+    data_free(data);
+    ASSERT_OUTPUT("time,model,id,temperature_C,codes,label,array\n"
+                  ",Test,42,21.500,,a\\,b,\n"
+                  "2021-01-01 00:00:00,Test,,,,,1;2;3\n");
+
+    fprintf(stderr, "csv:: skip state events\n");
+    data = data_make(
+            "id",               "", DATA_INT,    1,
+            "label",            "", DATA_STRING, "state",
+            NULL);
+    data_output_print(output, data);
+    data_free(data);
+    data = data_make(
+            "model",            "", DATA_STRING, "Test",
+            NULL);
+    data_output_print(output, data);
+    data_free(data);
+    ASSERT_OUTPUT("time,model,id,temperature_C,codes,label,array\n"
+                  ",Test,42,21.500,,a\\,b,\n"
+                  "2021-01-01 00:00:00,Test,,,,,1;2;3\n"
+                  "\n"
+                  ",Test,,,,,\n");
+
+    data_output_free(output);
+    fclose(file);
+
+    fprintf(stderr, "csv:: test (%u/%u) passed, (%u) failed.\n", passed, passed + failed, failed);
+
+    return failed;
+}
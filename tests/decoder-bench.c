@@ -0,0 +1,416 @@
+/** @file
+    Decoder microbenchmark.
+
+    Runs the slicer and decoder of every protocol on fixture inputs,
+    reports the time and allocations per call and the return codes.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "r_device.h"
+#include "rtl_433_devices.h"
+#include "bitbuffer.h"
+#include "pulse_detect.h"
+#include "pulse_slicer.h"
+#include "data.h"
+#include "metrics.h"
+#include "list.h"
+
+#define DEFAULT_ITERATIONS  1000
+#define DEFAULT_SAMPLE_RATE 250000
+
+// Counting allocations needs the linker to wrap the allocation functions (GNU ld on Linux).
+#ifdef DECODER_BENCH_ALLOCS
+static unsigned long alloc_count;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+char *__real_strdup(char const *s);
+void *__wrap_malloc(size_t size);
+void *__wrap_calloc(size_t nmemb, size_t size);
+void *__wrap_realloc(void *ptr, size_t size);
+char *__wrap_strdup(char const *s);
+
+void *__wrap_malloc(size_t size)
+{
+    ++alloc_count;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size)
+{
+    ++alloc_count;
+    return __real_calloc(nmemb, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    ++alloc_count;
+    return __real_realloc(ptr, size);
+}
+
+char *__wrap_strdup(char const *s)
+{
+    ++alloc_count;
+    return __real_strdup(s);
+}
+#endif
+
+/// A fixture input, either a bitbuffer or a pulse package.
+typedef struct fixture {
+    char const *name;
+    bitbuffer_t *bits;   ///< bitbuffer fixture, calls the decoder directly
+    pulse_data_t *pulses; ///< pulse package fixture, calls the slicer and decoder
+} fixture_t;
+
+/// Results of one decoder over all fixtures.
+typedef struct bench_result {
+    r_device *r_dev;
+    unsigned long calls;
+    double seconds;
+    unsigned long allocs;
+} bench_result_t;
+
+/// Events are counted from the decoder return codes, just drop the data.
+static void bench_output_fn(r_device *decoder, data_t *data)
+{
+    (void)decoder;
+    data_free(data);
+}
+
+static int run_slicer(r_device *r_dev, pulse_data_t const *pulses)
+{
+    switch (r_dev->modulation) {
+    case OOK_PULSE_PCM:
+    case FSK_PULSE_PCM:
+        return pulse_slicer_pcm(pulses, r_dev);
+    case OOK_PULSE_PPM:
+        return pulse_slicer_ppm(pulses, r_dev);
+    case OOK_PULSE_PWM:
+    case FSK_PULSE_PWM:
+        return pulse_slicer_pwm(pulses, r_dev);
+    case OOK_PULSE_MANCHESTER_ZEROBIT:
+    case FSK_PULSE_MANCHESTER_ZEROBIT:
+        return pulse_slicer_manchester_zerobit(pulses, r_dev);
+    case OOK_PULSE_PIWM_RAW:
+        return pulse_slicer_piwm_raw(pulses, r_dev);
+    case OOK_PULSE_PIWM_DC:
+        return pulse_slicer_piwm_dc(pulses, r_dev);
+    case OOK_PULSE_DMC:
+        return pulse_slicer_dmc(pulses, r_dev);
+    case OOK_PULSE_PWM_OSV1:
+        return pulse_slicer_osv1(pulses, r_dev);
+    case OOK_PULSE_NRZS:
+        return pulse_slicer_nrzs(pulses, r_dev);
+    default:
+        fprintf(stderr, "Unknown modulation %u in protocol!\n", r_dev->modulation);
+        return 0;
+    }
+}
+
+/// Decoders may change the bitbuffer, restore the rows in use from the fixture.
+static void restore_bits(bitbuffer_t *bits, bitbuffer_t const *orig)
+{
+    unsigned rows = bits->num_rows > orig->num_rows ? bits->num_rows : orig->num_rows;
+    if (rows > BITBUF_ROWS)
+        rows = BITBUF_ROWS;
+    bits->num_rows = orig->num_rows;
+    bits->free_row = orig->free_row;
+    memcpy(bits->bits_per_row, orig->bits_per_row, rows * sizeof(*bits->bits_per_row));
+    memcpy(bits->syncs_before_row, orig->syncs_before_row, rows * sizeof(*bits->syncs_before_row));
+    memcpy(bits->bb, orig->bb, rows * sizeof(*bits->bb));
+}
+
+/// Call a decoder on a bitbuffer, with the same accounting as the slicers.
+static void run_decoder(r_device *r_dev, bitbuffer_t *bits)
+{
+    int ret = r_dev->decode_fn(r_dev, bits);
+    r_dev->decode_events += 1;
+    if (ret > 0) {
+        r_dev->decode_ok += 1;
+        r_dev->decode_messages += ret;
+    }
+    else if (ret >= DECODE_FAIL_SANITY) {
+        r_dev->decode_fails[-ret] += 1;
+    }
+    else {
+        fprintf(stderr, "Decoder \"%s\" gave invalid return value %d: notify maintainer\n", r_dev->name, ret);
+        exit(1);
+    }
+}
+
+/// Time the restoring of a bitbuffer, to take it out of the decoder timings.
+static double time_restore(bitbuffer_t const *orig, unsigned iterations)
+{
+    bitbuffer_t bits = *orig;
+    bits.num_rows    = BITBUF_ROWS; // worst case, a decoder that adds all rows
+    double start     = metrics_cpu_time();
+    for (unsigned i = 0; i < iterations; ++i)
+        restore_bits(&bits, orig);
+    return metrics_cpu_time() - start;
+}
+
+static void bench_fixture(bench_result_t *result, fixture_t const *fixture, unsigned iterations, int fsk)
+{
+    r_device *r_dev = result->r_dev;
+    static bitbuffer_t bits;
+
+    if (fixture->pulses) {
+        // only the decoders for the package modulation, as in production
+        int is_fsk = fsk || fixture->pulses->fsk_f2_est;
+        if ((r_dev->modulation >= FSK_DEMOD_MIN_VAL) != is_fsk)
+            return;
+    }
+    else if (!r_dev->decode_fn) {
+        return;
+    }
+
+#ifdef DECODER_BENCH_ALLOCS
+    unsigned long allocs = alloc_count;
+#endif
+    double start = metrics_cpu_time();
+    if (fixture->pulses) {
+        for (unsigned i = 0; i < iterations; ++i)
+            run_slicer(r_dev, fixture->pulses);
+    }
+    else {
+        bits = *fixture->bits;
+        for (unsigned i = 0; i < iterations; ++i) {
+            run_decoder(r_dev, &bits);
+            restore_bits(&bits, fixture->bits);
+        }
+    }
+    double seconds = metrics_cpu_time() - start;
+#ifdef DECODER_BENCH_ALLOCS
+    result->allocs += alloc_count - allocs;
+#endif
+    if (fixture->bits)
+        seconds -= time_restore(fixture->bits, iterations);
+    result->seconds += seconds > 0.0 ? seconds : 0.0;
+    result->calls += iterations;
+}
+
+static int compare_seconds(void const *a, void const *b)
+{
+    bench_result_t const *ra = a;
+    bench_result_t const *rb = b;
+    return (ra->seconds < rb->seconds) - (ra->seconds > rb->seconds);
+}
+
+static void print_results(bench_result_t *results, unsigned num_results, unsigned iterations, unsigned top)
+{
+    qsort(results, num_results, sizeof(*results), compare_seconds);
+
+    double total = 0.0;
+    for (unsigned i = 0; i < num_results; ++i)
+        total += results[i].seconds;
+
+    // return codes are counted for a single pass over the fixtures
+    printf("%5s %9s %9s %7s %7s %7s %7s %7s %7s %7s %7s %7s  %s\n",
+            "proto", "calls", "ns/call", "allocs", "time%", "decodes", "events",
+            "other", "len", "early", "mic", "sanity", "name");
+    for (unsigned i = 0; i < num_results && (!top || i < top); ++i) {
+        bench_result_t *result = &results[i];
+        r_device *r_dev        = result->r_dev;
+        if (!result->calls)
+            continue;
+        char allocs[16] = "-";
+#ifdef DECODER_BENCH_ALLOCS
+        snprintf(allocs, sizeof(allocs), "%.2f", (double)result->allocs / result->calls);
+#endif
+        printf("%5u %9lu %9.1f %7s %6.1f%% %7u %7u %7u %7u %7u %7u %7u  %s\n",
+                r_dev->protocol_num,
+                result->calls,
+                result->seconds * 1e9 / result->calls,
+                allocs,
+                total > 0.0 ? result->seconds * 100.0 / total : 0.0,
+                r_dev->decode_events / iterations,
+                r_dev->decode_messages / iterations,
+                r_dev->decode_fails[-DECODE_FAIL_OTHER] / iterations,
+                r_dev->decode_fails[-DECODE_ABORT_LENGTH] / iterations,
+                r_dev->decode_fails[-DECODE_ABORT_EARLY] / iterations,
+                r_dev->decode_fails[-DECODE_FAIL_MIC] / iterations,
+                r_dev->decode_fails[-DECODE_FAIL_SANITY] / iterations,
+                r_dev->name);
+    }
+    printf("Total decoder time: %.3f ms\n", total * 1e3);
+}
+
+static void usage(char const *argv0)
+{
+    fprintf(stderr,
+            "%s [-n iterations] [-s samplerate] [-R protocol] [-a] [-F] [-t top] [-y code] [file.ook ...]\n"
+            "\tRuns the slicer and decoder of each protocol on the fixtures and reports\n"
+            "\tthe time and allocations per call and the decoder return codes.\n"
+            "\t-n <iterations> : Runs per decoder and fixture (default: %d)\n"
+            "\t-s <samplerate> : Sample rate of the pulse files (default: %d)\n"
+            "\t-R <protocol> : Run only this protocol, can be repeated\n"
+            "\t-a : Also run the protocols disabled by default\n"
+            "\t-F : Treat pulse files as FSK packages, the OOK text format does not keep the modulation\n"
+            "\t-t <top> : Show only the top decoders by time\n"
+            "\t-y <code> : Bitbuffer fixture in the -y format, e.g. {25}fb2dd58, can be repeated\n"
+            "\tfile.ook : Pulse packages in the OOK text format (as written by -w file.ook)\n",
+            argv0, DEFAULT_ITERATIONS, DEFAULT_SAMPLE_RATE);
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned iterations  = DEFAULT_ITERATIONS;
+    uint32_t sample_rate = DEFAULT_SAMPLE_RATE;
+    unsigned disabled    = 0;
+    unsigned top         = 0;
+    int fsk              = 0;
+    list_t protocols     = {0};
+    list_t codes         = {0};
+    list_t files         = {0};
+
+    for (int argi = 1; argi < argc; ++argi) {
+        char const *arg = argv[argi];
+        if (!strcmp(arg, "-a")) {
+            disabled = 2; // all but the hidden protocols
+        }
+        else if (!strcmp(arg, "-F")) {
+            fsk = 1;
+        }
+        else if (argi + 1 < argc && !strcmp(arg, "-n")) {
+            iterations = (unsigned)strtoul(argv[++argi], NULL, 10);
+        }
+        else if (argi + 1 < argc && !strcmp(arg, "-s")) {
+            sample_rate = (uint32_t)strtoul(argv[++argi], NULL, 10);
+        }
+        else if (argi + 1 < argc && !strcmp(arg, "-t")) {
+            top = (unsigned)strtoul(argv[++argi], NULL, 10);
+        }
+        else if (argi + 1 < argc && !strcmp(arg, "-R")) {
+            list_push(&protocols, argv[++argi]);
+        }
+        else if (argi + 1 < argc && !strcmp(arg, "-y")) {
+            list_push(&codes, argv[++argi]);
+        }
+        else if (*arg == '-') {
+            usage(argv[0]);
+        }
+        else {
+            list_push(&files, argv[argi]);
+        }
+    }
+    if (!iterations || !sample_rate || (!codes.len && !files.len))
+        usage(argv[0]);
+
+    // collect the fixtures
+    list_t fixtures = {0};
+    for (size_t i = 0; i < codes.len; ++i) {
+        fixture_t *fixture = calloc(1, sizeof(*fixture));
+        if (!fixture)
+            return 1;
+        fixture->name = codes.elems[i];
+        fixture->bits = calloc(1, sizeof(*fixture->bits));
+        if (!fixture->bits)
+            return 1;
+        bitbuffer_parse(fixture->bits, fixture->name);
+        list_push(&fixtures, fixture);
+    }
+    for (size_t i = 0; i < files.len; ++i) {
+        char const *path = files.elems[i];
+        FILE *file       = fopen(path, "r");
+        if (!file) {
+            fprintf(stderr, "Failed to open %s\n", path);
+            return 1;
+        }
+        for (;;) {
+            pulse_data_t *pulses = calloc(1, sizeof(*pulses));
+            if (!pulses)
+                return 1;
+            pulse_data_load(file, pulses, sample_rate);
+            if (!pulses->num_pulses) {
+                pulse_data_free(pulses);
+                free(pulses);
+                break;
+            }
+            fixture_t *fixture = calloc(1, sizeof(*fixture));
+            if (!fixture)
+                return 1;
+            fixture->name   = path;
+            fixture->pulses = pulses;
+            list_push(&fixtures, fixture);
+        }
+        fclose(file);
+    }
+    fprintf(stderr, "Loaded %zu fixtures, running %u iterations each\n", fixtures.len, iterations);
+
+    // collect the decoders, as in r_init_cfg() and register_protocol()
+    r_device r_devices[] = {
+#define DECL(name) name,
+            DEVICES
+#undef DECL
+    };
+    unsigned num_r_devices = sizeof(r_devices) / sizeof(*r_devices);
+    bench_result_t *results = calloc(num_r_devices, sizeof(*results));
+    if (!results)
+        return 1;
+    unsigned num_results = 0;
+    for (unsigned i = 0; i < num_r_devices; ++i) {
+        r_devices[i].protocol_num = i + 1;
+        int selected = !protocols.len && r_devices[i].disabled <= disabled;
+        for (size_t j = 0; j < protocols.len; ++j)
+            selected |= (unsigned)atoi(protocols.elems[j]) == i + 1;
+        if (!selected)
+            continue;
+
+        r_device *r_dev;
+        if (r_devices[i].create_fn) {
+            r_dev = r_devices[i].create_fn(NULL);
+        }
+        else {
+            r_dev = malloc(sizeof(*r_dev));
+            if (!r_dev)
+                return 1;
+            *r_dev = r_devices[i];
+        }
+        r_dev->protocol_num = i + 1;
+        r_dev->verbose      = 0;
+        r_dev->output_fn    = bench_output_fn;
+
+        results[num_results++].r_dev = r_dev;
+    }
+
+    for (unsigned i = 0; i < num_results; ++i) {
+        for (size_t j = 0; j < fixtures.len; ++j) {
+            bench_fixture(&results[i], fixtures.elems[j], iterations, fsk);
+        }
+    }
+
+    print_results(results, num_results, iterations, top);
+
+    for (unsigned i = 0; i < num_results; ++i) {
+        free(results[i].r_dev->decode_ctx);
+        free(results[i].r_dev);
+    }
+    free(results);
+    for (size_t j = 0; j < fixtures.len; ++j) {
+        fixture_t *fixture = fixtures.elems[j];
+        free(fixture->bits);
+        if (fixture->pulses)
+            pulse_data_free(fixture->pulses);
+        free(fixture->pulses);
+    }
+    list_free_elems(&fixtures, free);
+    list_free_elems(&codes, NULL);
+    list_free_elems(&files, NULL);
+    list_free_elems(&protocols, NULL);
+    pulse_data_pool_free();
+    bitbuffer_pool_free();
+
+    return 0;
+}
@@ -0,0 +1,121 @@
+/** @file
+    Event de-duplication tests.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "data.h"
+#include "data_dedup.h"
+
+static data_t *make_event(int id, double temperature, double rssi)
+{
+    return data_make(
+            "model",            "", DATA_STRING, "Test",
+            "id",               "", DATA_INT,    id,
+            "temperature_C",    "", DATA_DOUBLE, temperature,
+            "rssi",             "", DATA_DOUBLE, rssi,
+            NULL);
+}
+
+static int get_int(data_t *data, char const *key)
+{
+    for (data_t *d = data; d; d = d->next)
+        if (!strcmp(d->key, key) && d->type == DATA_INT)
+            return d->value.v_int;
+    return -1;
+}
+
+/// apply and count the events passed through
+static int apply(data_dedup_t *dedup, data_t *data, double now)
+{
+    data_t *out = data_dedup_apply(dedup, data, now);
+    data_free(out);
+    return out != NULL;
+}
+
+#define ASSERT_EQUALS(a, b) \
+    do { \
+        if ((a) == (b)) \
+            ++passed; \
+        else { \
+            ++failed; \
+            fprintf(stderr, "FAIL line %d: %d <> %d\n", __LINE__, (int)(a), (int)(b)); \
+        } \
+    } while (0)
+
+int main(void)
+{
+    unsigned passed = 0;
+    unsigned failed = 0;
+    char params[64];
+
+    fprintf(stderr, "dedup:: test\n");
+
+    fprintf(stderr, "dedup:: drop repeats\n");
+    snprintf(params, sizeof(params), "1000");
+    data_dedup_t *dedup = data_dedup_create(params);
+    ASSERT_EQUALS(apply(dedup, make_event(1, 20.0, -10.0), 0.0), 1);
+    ASSERT_EQUALS(apply(dedup, make_event(1, 20.0, -12.0), 0.1), 0); // meta data differs
+    ASSERT_EQUALS(apply(dedup, make_event(2, 20.0, -10.0), 0.2), 1); // other id
+    ASSERT_EQUALS(apply(dedup, make_event(1, 20.1, -10.0), 0.3), 1); // other reading
+    ASSERT_EQUALS(apply(dedup, make_event(1, 20.0, -10.0), 1.0), 0); // window restarted at 0.1
+    ASSERT_EQUALS(apply(dedup, make_event(1, 20.0, -10.0), 2.1), 1); // window closed
+    ASSERT_EQUALS(dedup->lookups, 6);
+    ASSERT_EQUALS(dedup->hits, 2);
+    ASSERT_EQUALS(data_dedup_entries(dedup, 2.1), 1);
+    ASSERT_EQUALS(data_dedup_entries(dedup, 10.0), 0);
+    data_dedup_free(dedup);
+
+    fprintf(stderr, "dedup:: selected fields\n");
+    snprintf(params, sizeof(params), "1000,fields=rssi");
+    dedup = data_dedup_create(params);
+    ASSERT_EQUALS(apply(dedup, make_event(1, 20.0, -10.0), 0.0), 1);
+    ASSERT_EQUALS(apply(dedup, make_event(1, 25.0, -10.0), 0.1), 0); // temperature ignored
+    ASSERT_EQUALS(apply(dedup, make_event(1, 20.0, -11.0), 0.2), 1);
+    data_dedup_free(dedup);
+
+    fprintf(stderr, "dedup:: collapse with count\n");
+    snprintf(params, sizeof(params), "500,collapse");
+    dedup = data_dedup_create(params);
+    ASSERT_EQUALS(apply(dedup, make_event(1, 20.0, -10.0), 0.0), 0); // held
+    ASSERT_EQUALS(apply(dedup, make_event(1, 20.0, -10.0), 0.1), 0);
+    ASSERT_EQUALS(apply(dedup, make_event(1, 20.0, -10.0), 0.2), 0);
+    ASSERT_EQUALS(apply(dedup, make_event(2, 20.0, -10.0), 0.3), 0);
+    ASSERT_EQUALS(data_dedup_expire(dedup, 0.5) == NULL, 1); // not due
+    data_t *out = data_dedup_expire(dedup, 0.75); // window restarted at 0.2
+    ASSERT_EQUALS(get_int(out, "id"), 1);
+    ASSERT_EQUALS(get_int(out, "dedup_count"), 3);
+    data_free(out);
+    ASSERT_EQUALS(data_dedup_expire(dedup, 0.75) == NULL, 1);
+    out = data_dedup_expire(dedup, -1.0); // all
+    ASSERT_EQUALS(get_int(out, "id"), 2);
+    ASSERT_EQUALS(get_int(out, "dedup_count"), 1);
+    data_free(out);
+    ASSERT_EQUALS(dedup->held, 0);
+    data_dedup_free(dedup);
+
+    fprintf(stderr, "dedup:: table growth\n");
+    snprintf(params, sizeof(params), "1000");
+    dedup = data_dedup_create(params);
+    int passed_through = 0;
+    for (int i = 0; i < 1000; ++i)
+        passed_through += apply(dedup, make_event(i, 20.0, -10.0), i * 0.001);
+    for (int i = 0; i < 1000; ++i)
+        passed_through += apply(dedup, make_event(i, 20.0, -10.0), 0.5 + i * 0.001);
+    ASSERT_EQUALS(passed_through, 1000);
+    ASSERT_EQUALS(data_dedup_entries(dedup, 1.4), 1000);
+    ASSERT_EQUALS(data_dedup_entries(dedup, 2.5), 0);
+    data_dedup_free(dedup);
+
+    fprintf(stderr, "dedup:: test (%u/%u) passed, (%u) failed.\n", passed, passed + failed, failed);
+
+    return failed;
+}
@@ -0,0 +1,256 @@
+/** @file
+    InfluxDB output tests against a local HTTP stand-in server.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "data.h"
+#include "output_influx.h"
+#include "mongoose.h"
+
+#ifdef ZLIB
+#include <zlib.h>
+#endif
+
+#define SPOOL_PATH "influx-test.spool"
+
+/// HTTP stand-in for InfluxDB, collects all posted line protocol
+typedef struct {
+    int connections;
+    int requests;
+    int gzipped;
+    int fail_next; ///< reply with 503 to this many requests
+    char lines[64 * 1024];
+    size_t lines_len;
+} stand_in_t;
+
+static stand_in_t stand_in;
+
+static void stand_in_append(char const *body, size_t len, int gzipped)
+{
+#ifdef ZLIB
+    if (gzipped) {
+        char plain[16 * 1024];
+        z_stream zs = {0};
+        inflateInit2(&zs, 15 + 16);
+        zs.next_in   = (Bytef *)body;
+        zs.avail_in  = len;
+        zs.next_out  = (Bytef *)plain;
+        zs.avail_out = sizeof(plain);
+        inflate(&zs, Z_FINISH);
+        len = sizeof(plain) - zs.avail_out;
+        inflateEnd(&zs);
+        memcpy(&stand_in.lines[stand_in.lines_len], plain, len);
+        stand_in.lines_len += len;
+        return;
+    }
+#endif
+    (void)gzipped;
+    memcpy(&stand_in.lines[stand_in.lines_len], body, len);
+    stand_in.lines_len += len;
+}
+
+static void stand_in_event(struct mg_connection *nc, int ev, void *ev_data)
+{
+    struct http_message *hm = (struct http_message *)ev_data;
+
+    if (ev == MG_EV_ACCEPT) {
+        stand_in.connections++;
+    }
+    else if (ev == MG_EV_HTTP_REQUEST) {
+        stand_in.requests++;
+        if (stand_in.fail_next) {
+            stand_in.fail_next--;
+            mg_printf(nc, "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 4\r\n\r\ndown");
+            return;
+        }
+        struct mg_str *enc = mg_get_http_header(hm, "Content-Encoding");
+        int gzipped = enc && !mg_vcasecmp(enc, "gzip");
+        stand_in.gzipped += gzipped;
+        stand_in_append(hm->body.p, hm->body.len, gzipped);
+        // like InfluxDB: no content and no Content-Length
+        mg_printf(nc, "HTTP/1.1 204 No Content\r\n\r\n");
+    }
+}
+
+static void stand_in_reset(void)
+{
+    memset(&stand_in, 0, sizeof(stand_in));
+}
+
+static void poll_until(struct mg_mgr *mgr, size_t lines_len, double timeout)
+{
+    double end = mg_time() + timeout;
+    while (stand_in.lines_len < lines_len && mg_time() < end)
+        mg_mgr_poll(mgr, 10);
+}
+
+static void print_events(data_output_t *output, int first, int count)
+{
+    for (int i = first; i < first + count; ++i) {
+        data_t *data = data_make(
+                "model",            "", DATA_STRING, "Test",
+                "id",               "", DATA_INT,    i,
+                "temperature_C",    "", DATA_DOUBLE, 21.5,
+                NULL);
+        data_output_print(output, data);
+        data_free(data);
+    }
+}
+
+static void expected_lines(char *buf, int first, int count)
+{
+    *buf = '\0';
+    for (int i = first; i < first + count; ++i)
+        buf += sprintf(buf, "Test,id=%d temperature_C=21.500000\n", i);
+}
+
+#define ASSERT_EQUALS(a, b) \
+    do { \
+        if ((a) == (b)) \
+            ++passed; \
+        else { \
+            ++failed; \
+            fprintf(stderr, "FAIL line %d: %d <> %d\n", __LINE__, (int)(a), (int)(b)); \
+        } \
+    } while (0)
+
+#define ASSERT_LINES(first, count) \
+    do { \
+        expected_lines(expect, first, count); \
+        if (stand_in.lines_len == strlen(expect) && !memcmp(stand_in.lines, expect, stand_in.lines_len)) \
+            ++passed; \
+        else { \
+            ++failed; \
+            fprintf(stderr, "FAIL line %d: got \"%.*s\"\n", __LINE__, (int)stand_in.lines_len, stand_in.lines); \
+        } \
+    } while (0)
+
+int main(void)
+{
+    unsigned passed = 0;
+    unsigned failed = 0;
+    char expect[64 * 1024];
+    char opts[256];
+    char port[16];
+
+    struct mg_mgr mgr;
+    mg_mgr_init(&mgr, NULL);
+
+    struct mg_connection *listener = mg_bind(&mgr, "127.0.0.1:0", stand_in_event);
+    if (!listener) {
+        fprintf(stderr, "influx:: can't bind stand-in server\n");
+        return 1;
+    }
+    mg_set_protocol_http_websocket(listener);
+    mg_conn_addr_to_str(listener, port, sizeof(port), MG_SOCK_STRINGIFY_PORT);
+    remove(SPOOL_PATH);
+
+    fprintf(stderr, "influx:: test\n");
+
+    fprintf(stderr, "influx:: latency bound batch\n");
+    stand_in_reset();
+    snprintf(opts, sizeof(opts), "influx://127.0.0.1:%s/write?db=test,latency=200", port);
+    data_output_t *output = data_output_influx_create(&mgr, opts);
+    print_events(output, 0, 10);
+    poll_until(&mgr, 1, 0.05);
+    ASSERT_EQUALS(stand_in.requests, 0); // not due yet
+    expected_lines(expect, 0, 10);
+    poll_until(&mgr, strlen(expect), 2.0);
+    ASSERT_LINES(0, 10);
+    ASSERT_EQUALS(stand_in.requests, 1);
+
+    fprintf(stderr, "influx:: keep-alive connection\n");
+    print_events(output, 10, 5);
+    expected_lines(expect, 0, 15);
+    poll_until(&mgr, strlen(expect), 2.0);
+    ASSERT_LINES(0, 15);
+    ASSERT_EQUALS(stand_in.requests, 2);
+    ASSERT_EQUALS(stand_in.connections, 1);
+    data_output_free(output);
+
+    fprintf(stderr, "influx:: size bound batch\n");
+    stand_in_reset();
+    snprintf(opts, sizeof(opts), "influx://127.0.0.1:%s/write?db=test,batch=100,latency=60000", port);
+    output = data_output_influx_create(&mgr, opts);
+    print_events(output, 0, 4);
+    expected_lines(expect, 0, 4);
+    poll_until(&mgr, strlen(expect), 2.0);
+    ASSERT_LINES(0, 4);
+    data_output_free(output);
+
+#ifdef ZLIB
+    fprintf(stderr, "influx:: gzip body\n");
+    stand_in_reset();
+    snprintf(opts, sizeof(opts), "influx://127.0.0.1:%s/write?db=test,latency=10,gzip", port);
+    output = data_output_influx_create(&mgr, opts);
+    print_events(output, 0, 20);
+    expected_lines(expect, 0, 20);
+    poll_until(&mgr, strlen(expect), 2.0);
+    ASSERT_LINES(0, 20);
+    ASSERT_EQUALS(stand_in.gzipped, 1);
+    data_output_free(output);
+#endif
+
+    fprintf(stderr, "influx:: retry from spool\n");
+    stand_in_reset();
+    stand_in.fail_next = 1;
+    snprintf(opts, sizeof(opts), "influx://127.0.0.1:%s/write?db=test,latency=10,spool=" SPOOL_PATH, port);
+    output = data_output_influx_create(&mgr, opts);
+    print_events(output, 0, 3);
+    poll_until(&mgr, 1, 0.5);
+    ASSERT_EQUALS(stand_in.requests, 1); // rejected and spooled
+    ASSERT_EQUALS(stand_in.lines_len, 0);
+    print_events(output, 3, 2);
+    expected_lines(expect, 0, 5);
+    poll_until(&mgr, strlen(expect), 3.0);
+    ASSERT_LINES(0, 5); // spool first, in order
+    poll_until(&mgr, sizeof(stand_in.lines), 0.1); // let the client see the last reply
+
+    fprintf(stderr, "influx:: spool persists unsent lines\n");
+    stand_in_reset();
+    print_events(output, 5, 2);
+    data_output_free(output); // never polled, lines go to the spool
+    snprintf(opts, sizeof(opts), "influx://127.0.0.1:%s/write?db=test,latency=10,spool=" SPOOL_PATH, port);
+    output = data_output_influx_create(&mgr, opts);
+    expected_lines(expect, 5, 2);
+    poll_until(&mgr, strlen(expect), 2.0);
+    ASSERT_LINES(5, 2);
+    data_output_free(output);
+
+    fprintf(stderr, "influx:: retry after a failed connect\n");
+    stand_in_reset();
+    char down_port[16];
+    struct mg_connection *down = mg_bind(&mgr, "127.0.0.1:0", stand_in_event);
+    mg_conn_addr_to_str(down, down_port, sizeof(down_port), MG_SOCK_STRINGIFY_PORT);
+    down->flags |= MG_F_CLOSE_IMMEDIATELY;
+    mg_mgr_poll(&mgr, 10);
+    snprintf(opts, sizeof(opts), "influx://127.0.0.1:%s/write?db=test,latency=10", down_port);
+    output = data_output_influx_create(&mgr, opts);
+    print_events(output, 0, 3);
+    poll_until(&mgr, 1, 0.5); // connect refused
+    ASSERT_EQUALS(stand_in.connections, 0);
+    snprintf(opts, sizeof(opts), "127.0.0.1:%s", down_port);
+    struct mg_connection *up = mg_bind(&mgr, opts, stand_in_event);
+    mg_set_protocol_http_websocket(up);
+    expected_lines(expect, 0, 3);
+    poll_until(&mgr, strlen(expect), 3.0); // no new events, only the retry timer
+    ASSERT_LINES(0, 3);
+    data_output_free(output);
+
+    mg_mgr_free(&mgr);
+    remove(SPOOL_PATH);
+
+    fprintf(stderr, "influx:: test (%u/%u) passed, (%u) failed.\n", passed, passed + failed, failed);
+
+    return failed;
+}
@@ -0,0 +1,172 @@
+/** @file
+    MQTT output tests against a local broker stand-in.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "data.h"
+#include "output_mqtt.h"
+#include "mongoose.h"
+
+/// MQTT broker stand-in, collects all published topics and payloads
+typedef struct {
+    int connections;
+    int publishes;
+    int hold_acks; ///< don't acknowledge QoS 1 messages
+    int held;
+    uint16_t held_ids[64];
+    struct mg_connection *client;
+    char log[16 * 1024]; ///< "topic payload\n" lines
+    size_t log_len;
+} stand_in_t;
+
+static stand_in_t stand_in;
+
+static void stand_in_event(struct mg_connection *nc, int ev, void *ev_data)
+{
+    struct mg_mqtt_message *msg = (struct mg_mqtt_message *)ev_data;
+
+    if (ev == MG_EV_ACCEPT) {
+        stand_in.connections++;
+        stand_in.client = nc;
+    }
+    else if (ev == MG_EV_MQTT_CONNECT) {
+        mg_mqtt_connack(nc, MG_EV_MQTT_CONNACK_ACCEPTED);
+    }
+    else if (ev == MG_EV_MQTT_PUBLISH) {
+        stand_in.publishes++;
+        stand_in.log_len += snprintf(&stand_in.log[stand_in.log_len], sizeof(stand_in.log) - stand_in.log_len,
+                "%.*s %.*s\n", (int)msg->topic.len, msg->topic.p, (int)msg->payload.len, msg->payload.p);
+        if (msg->qos == 1 && stand_in.hold_acks)
+            stand_in.held_ids[stand_in.held++] = msg->message_id;
+        else if (msg->qos == 1)
+            mg_mqtt_puback(nc, msg->message_id);
+    }
+}
+
+static void stand_in_reset(void)
+{
+    memset(&stand_in, 0, sizeof(stand_in));
+}
+
+static void poll_until(struct mg_mgr *mgr, int publishes, double timeout)
+{
+    double end = mg_time() + timeout;
+    while (stand_in.publishes < publishes && mg_time() < end)
+        mg_mgr_poll(mgr, 10);
+}
+
+static void poll_connected(struct mg_mgr *mgr)
+{
+    // the client publishes only with an established MQTT connection
+    double end = mg_time() + 2.0;
+    while (mg_time() < end && !(stand_in.client && stand_in.client->proto_data))
+        mg_mgr_poll(mgr, 10);
+    for (int i = 0; i < 10; ++i)
+        mg_mgr_poll(mgr, 10);
+}
+
+static void print_event(data_output_t *output, char const *model, int id, int channel)
+{
+    data_t *data = data_make(
+            "model",            "", DATA_STRING, model,
+            "id",               "", DATA_INT,    id,
+            "channel",          "", DATA_INT,    channel,
+            "temperature_C",    "", DATA_DOUBLE, 21.5,
+            NULL);
+    data_output_print(output, data);
+    data_free(data);
+}
+
+#define ASSERT_EQUALS(a, b) \
+    do { \
+        if ((a) == (b)) \
+            ++passed; \
+        else { \
+            ++failed; \
+            fprintf(stderr, "FAIL line %d: %d <> %d\n", __LINE__, (int)(a), (int)(b)); \
+        } \
+    } while (0)
+
+#define ASSERT_LOG(expect) \
+    do { \
+        if (!strcmp(stand_in.log, expect)) \
+            ++passed; \
+        else { \
+            ++failed; \
+            fprintf(stderr, "FAIL line %d: got \"%s\"\n", __LINE__, stand_in.log); \
+        } \
+    } while (0)
+
+int main(void)
+{
+    unsigned passed = 0;
+    unsigned failed = 0;
+    char opts[256];
+    char port[16];
+
+    struct mg_mgr mgr;
+    mg_mgr_init(&mgr, NULL);
+
+    struct mg_connection *listener = mg_bind(&mgr, "127.0.0.1:0", stand_in_event);
+    if (!listener) {
+        fprintf(stderr, "mqtt:: can't bind stand-in broker\n");
+        return 1;
+    }
+    mg_set_protocol_mqtt(listener);
+    mg_conn_addr_to_str(listener, port, sizeof(port), MG_SOCK_STRINGIFY_PORT);
+
+    fprintf(stderr, "mqtt:: test\n");
+
+    fprintf(stderr, "mqtt:: topic templates\n");
+    stand_in_reset();
+    snprintf(opts, sizeof(opts), "mqtt://127.0.0.1:%s,events=ev[/model],devices=dev[/model][/subtype:none][/id]/c[channel]", port);
+    data_output_t *output = data_output_mqtt_create(&mgr, opts, "");
+    poll_connected(&mgr);
+    print_event(output, "Test Sensor+1", 42, 3);
+    poll_until(&mgr, 4, 2.0);
+    ASSERT_EQUALS(stand_in.publishes, 4);
+    ASSERT_LOG("ev/Test_Sensor_1 {\"model\":\"Test Sensor+1\",\"id\":42,\"channel\":3,\"temperature_C\":21.5}\n"
+               "dev/Test_Sensor_1/none/42/c3/id 42\n"
+               "dev/Test_Sensor_1/none/42/c3/channel 3\n"
+               "dev/Test_Sensor_1/none/42/c3/temperature_C 21.5\n");
+    data_output_free(output);
+
+    fprintf(stderr, "mqtt:: QoS 1 in-flight window\n");
+    stand_in_reset();
+    stand_in.hold_acks = 1;
+    snprintf(opts, sizeof(opts), "mqtt://127.0.0.1:%s,qos=1,window=2,devices=dev[/id]", port);
+    output = data_output_mqtt_create(&mgr, opts, "");
+    poll_connected(&mgr);
+    print_event(output, "Test", 1, 1);
+    print_event(output, "Test", 2, 1);
+    poll_until(&mgr, 6, 0.5);
+    ASSERT_EQUALS(stand_in.publishes, 2); // window full
+    stand_in.hold_acks = 0;
+    for (int i = 0; i < stand_in.held; ++i)
+        mg_mqtt_puback(stand_in.client, stand_in.held_ids[i]);
+    poll_until(&mgr, 6, 2.0);
+    ASSERT_EQUALS(stand_in.publishes, 6);
+    ASSERT_LOG("dev/1/id 1\n"
+               "dev/1/channel 1\n"
+               "dev/1/temperature_C 21.5\n"
+               "dev/2/id 2\n"
+               "dev/2/channel 1\n"
+               "dev/2/temperature_C 21.5\n");
+    data_output_free(output);
+
+    mg_mgr_free(&mgr);
+
+    fprintf(stderr, "mqtt:: test (%u/%u) passed, (%u) failed.\n", passed, passed + failed, failed);
+
+    return failed;
+}
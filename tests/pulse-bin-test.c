@@ -0,0 +1,156 @@
+/** @file
+    Binary pulse file tests.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pulse_bin.h"
+
+#define ASSERT_EQUALS(a, b) \
+    do { \
+        if ((a) == (b)) \
+            ++passed; \
+        else { \
+            ++failed; \
+            fprintf(stderr, "FAIL line %d: %d <> %d\n", __LINE__, (int)(a), (int)(b)); \
+        } \
+    } while (0)
+
+static pulse_data_t data;
+
+static void make_package(uint64_t offset, unsigned num_pulses, int fsk)
+{
+    pulse_data_clear(&data);
+    pulse_data_reserve(&data, num_pulses);
+    data.offset      = offset;
+    data.sample_rate = 250000;
+    data.depth_bits  = 8;
+    data.num_pulses  = num_pulses;
+    for (unsigned i = 0; i < num_pulses; ++i) {
+        data.pulse[i] = 100 + i;          // one byte and two byte varints
+        data.gap[i]   = i * 1000 % 70000; // up to three byte varints
+    }
+    data.fsk_f1_est    = fsk ? 5000 : 0;
+    data.fsk_f2_est    = fsk ? -5000 : 0;
+    data.centerfreq_hz = 433920000.0f;
+    data.freq1_hz      = 433900000.0f;
+    data.rssi_db       = -3.5f;
+    data.noise_db      = -23.5f;
+}
+
+int main(void)
+{
+    unsigned passed = 0;
+    unsigned failed = 0;
+    char const *path       = "pulse-bin-test.pbin";
+    char const *index_path = "pulse-bin-test.pbin.idx";
+
+    fprintf(stderr, "pulse_bin:: test\n");
+
+    fprintf(stderr, "pulse_bin:: write and append\n");
+    pulse_bin_writer_t *writer = pulse_bin_open(path, 1);
+    ASSERT_EQUALS(writer != NULL, 1);
+    make_package(1000, 20, 0);
+    ASSERT_EQUALS(pulse_bin_write(writer, &data), 0);
+    make_package(2000, PD_MAX_PULSES, 1);
+    ASSERT_EQUALS(pulse_bin_write(writer, &data), 0);
+    pulse_bin_close(writer);
+    writer = pulse_bin_open(path, 0);
+    ASSERT_EQUALS(writer != NULL, 1);
+    make_package(3000, 1, 0);
+    ASSERT_EQUALS(pulse_bin_write(writer, &data), 0);
+    pulse_bin_close(writer);
+
+    fprintf(stderr, "pulse_bin:: read back\n");
+    FILE *file = fopen(path, "rb");
+    ASSERT_EQUALS(file != NULL, 1);
+    pulse_bin_reader_t reader;
+    ASSERT_EQUALS(pulse_bin_reader_open(&reader, file), 0);
+    ASSERT_EQUALS(pulse_bin_read(&reader, &data), 1);
+    ASSERT_EQUALS(data.offset == 1000, 1);
+    ASSERT_EQUALS(data.num_pulses, 20);
+    ASSERT_EQUALS(data.sample_rate, 250000);
+    ASSERT_EQUALS(data.depth_bits, 8);
+    ASSERT_EQUALS(data.fsk_f2_est, 0);
+    ASSERT_EQUALS(data.rssi_db == -3.5f, 1);
+    ASSERT_EQUALS(data.centerfreq_hz == 433920000.0f, 1);
+    ASSERT_EQUALS(data.pulse[19], 119);
+    ASSERT_EQUALS(data.gap[19], 19000);
+    ASSERT_EQUALS(pulse_bin_read(&reader, &data), 1);
+    ASSERT_EQUALS(data.num_pulses, PD_MAX_PULSES);
+    ASSERT_EQUALS(data.fsk_f1_est, 5000);
+    ASSERT_EQUALS(data.fsk_f2_est, -5000);
+    ASSERT_EQUALS(data.pulse[PD_MAX_PULSES - 1], 100 + PD_MAX_PULSES - 1);
+    ASSERT_EQUALS(data.gap[PD_MAX_PULSES - 1], (PD_MAX_PULSES - 1) * 1000 % 70000);
+    ASSERT_EQUALS(pulse_bin_read(&reader, &data), 1);
+    ASSERT_EQUALS(data.offset == 3000, 1);
+    ASSERT_EQUALS(data.num_pulses, 1);
+    ASSERT_EQUALS(pulse_bin_read(&reader, &data), 0); // end
+
+    fprintf(stderr, "pulse_bin:: index\n");
+    FILE *index = fopen(index_path, "rb");
+    ASSERT_EQUALS(index != NULL, 1);
+    pulse_bin_index_t entry;
+    ASSERT_EQUALS(pulse_bin_read_index(index, 3, &entry), -1);
+    ASSERT_EQUALS(pulse_bin_read_index(index, 1, &entry), 0);
+    ASSERT_EQUALS(entry.offset == 2000, 1);
+    ASSERT_EQUALS(entry.num_pulses, PD_MAX_PULSES);
+    ASSERT_EQUALS(entry.package_type, PULSE_DATA_FSK);
+    fclose(index);
+    // seek to a package by index
+    reader.pos = (size_t)entry.record_offset;
+    ASSERT_EQUALS(pulse_bin_read(&reader, &data), 1);
+    ASSERT_EQUALS(data.offset == 2000, 1);
+    pulse_bin_reader_close(&reader);
+    fclose(file);
+
+    fprintf(stderr, "pulse_bin:: reject truncated files\n");
+    file = fopen(path, "rb");
+    ASSERT_EQUALS(file != NULL, 1);
+    fseek(file, 0, SEEK_END);
+    long len = ftell(file);
+    rewind(file);
+    uint8_t *buf = malloc((size_t)len);
+    if (!buf)
+        return 1;
+    ASSERT_EQUALS(fread(buf, 1, (size_t)len, file), (size_t)len);
+    fclose(file);
+    file = fopen(path, "wb");
+    fwrite(buf, 1, (size_t)len - 1, file);
+    fclose(file);
+    free(buf);
+    file = fopen(path, "rb");
+    ASSERT_EQUALS(pulse_bin_reader_open(&reader, file), 0);
+    ASSERT_EQUALS(pulse_bin_read(&reader, &data), 1);
+    ASSERT_EQUALS(pulse_bin_read(&reader, &data), 1);
+    ASSERT_EQUALS(pulse_bin_read(&reader, &data), -1);
+    pulse_bin_reader_close(&reader);
+    fclose(file);
+
+    fprintf(stderr, "pulse_bin:: refuse to append to other files\n");
+    file = fopen(path, "wb");
+    ASSERT_EQUALS(file != NULL, 1);
+    fputs("not a pulse file", file);
+    fclose(file);
+    ASSERT_EQUALS(pulse_bin_open(path, 0) == NULL, 1);
+    file = fopen(path, "rb");
+    ASSERT_EQUALS(pulse_bin_reader_open(&reader, file), -1);
+    fclose(file);
+
+    remove(path);
+    remove(index_path);
+    pulse_data_free(&data);
+
+    fprintf(stderr, "pulse_bin:: test (%u/%u) passed, (%u) failed.\n", passed, passed + failed, failed);
+
+    return failed;
+}
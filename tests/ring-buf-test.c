@@ -0,0 +1,72 @@
+/** @file
+    Ring buffer tests.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ring_buf.h"
+
+#define ASSERT_EQUALS(a, b) \
+    do { \
+        if ((a) == (b)) \
+            ++passed; \
+        else { \
+            ++failed; \
+            fprintf(stderr, "FAIL line %d: %d <> %d\n", __LINE__, (int)(a), (int)(b)); \
+        } \
+    } while (0)
+
+int main(void)
+{
+    unsigned passed = 0;
+    unsigned failed = 0;
+
+    fprintf(stderr, "ring_buf:: test\n");
+
+    ring_buf_t *ring = ring_buf_create(1000);
+    ASSERT_EQUALS(ring != NULL, 1);
+    if (!ring)
+        return 1;
+    size_t size = ring->size;
+    ASSERT_EQUALS(size >= 1000, 1);
+    fprintf(stderr, "ring_buf:: %zu bytes, %s\n", size, ring->mirrored ? "mirrored" : "double-mapped");
+
+    uint8_t *data = malloc(2 * size);
+    if (!data)
+        return 1;
+    for (size_t i = 0; i < 2 * size; ++i)
+        data[i] = (uint8_t)(i * 7);
+
+    fprintf(stderr, "ring_buf:: contiguous across the wraparound\n");
+    size_t first = size - size / 4;
+    ring_buf_write(ring, data, first);
+    ring_buf_write(ring, &data[first], size / 2);
+    ASSERT_EQUALS(ring_buf_head(ring) == first + size / 2, 1);
+    ASSERT_EQUALS(ring_buf_tail(ring) == first + size / 2 - size, 1);
+    // the last write wrapped around, but reads back in one piece
+    ASSERT_EQUALS(memcmp(ring_buf_at(ring, first), &data[first], size / 2), 0);
+    // a full ring size slice ending at the head
+    ASSERT_EQUALS(memcmp(ring_buf_at(ring, ring_buf_tail(ring)), &data[first + size / 2 - size], size), 0);
+
+    fprintf(stderr, "ring_buf:: oversized write keeps the newest data\n");
+    uint64_t head = ring_buf_head(ring);
+    ring_buf_write(ring, data, 2 * size);
+    ASSERT_EQUALS(ring_buf_head(ring) == head + 2 * size, 1);
+    ASSERT_EQUALS(memcmp(ring_buf_at(ring, ring_buf_tail(ring)), &data[size], size), 0);
+
+    free(data);
+    ring_buf_free(ring);
+
+    fprintf(stderr, "ring_buf:: test (%u/%u) passed, (%u) failed.\n", passed, passed + failed, failed);
+
+    return failed;
+}
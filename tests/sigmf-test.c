@@ -0,0 +1,85 @@
+/** @file
+    SigMF recording tests.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sigmf.h"
+#include "fileformat.h"
+
+#define ASSERT_EQUALS(a, b) \
+    do { \
+        if ((a) == (b)) \
+            ++passed; \
+        else { \
+            ++failed; \
+            fprintf(stderr, "FAIL line %d: %d <> %d\n", __LINE__, (int)(a), (int)(b)); \
+        } \
+    } while (0)
+
+int main(void)
+{
+    unsigned passed = 0;
+    unsigned failed = 0;
+    char const *meta_path = "sigmf-test.sigmf-meta";
+    char const *data_path = "sigmf-test.sigmf-data";
+    uint8_t samples[2000];
+    for (unsigned i = 0; i < sizeof(samples); ++i)
+        samples[i] = (uint8_t)i;
+
+    fprintf(stderr, "sigmf:: test\n");
+
+    fprintf(stderr, "sigmf:: write\n");
+    sigmf_writer_t *writer = sigmf_writer_open("sigmf-test.sigmf", 1);
+    ASSERT_EQUALS(writer != NULL, 1);
+    ASSERT_EQUALS(sigmf_writer_write(writer, samples, 1000, CU8_IQ, 250000, 433920000), 0);
+    // samples 100 to 200, then 250 to 300
+    sigmf_writer_annotate(writer, 400, 300, "Test", "OOK");
+    sigmf_writer_annotate(writer, 250, 200, "", "OOK");
+    ASSERT_EQUALS(sigmf_writer_write(writer, samples, 2000, CU8_IQ, 250000, 433920000), 0);
+    // samples 1400 to 1450
+    sigmf_writer_annotate(writer, 100, 50, "Test,Other", "FSK");
+    sigmf_writer_close(writer);
+
+    fprintf(stderr, "sigmf:: read back\n");
+    sigmf_meta_t meta = {0};
+    ASSERT_EQUALS(sigmf_meta_read(&meta, meta_path), 0);
+    ASSERT_EQUALS(strcmp(meta.data_path, data_path), 0);
+    ASSERT_EQUALS(meta.format, CU8_IQ);
+    ASSERT_EQUALS(meta.sample_rate, 250000);
+    ASSERT_EQUALS(meta.frequency == 433920000, 1);
+    ASSERT_EQUALS(meta.num_annotations, 3);
+    ASSERT_EQUALS(meta.annotations[0].sample_start, 100);
+    ASSERT_EQUALS(meta.annotations[0].sample_count, 100);
+    ASSERT_EQUALS(meta.annotations[2].sample_start, 1400);
+    ASSERT_EQUALS(meta.annotations[2].sample_count, 50);
+
+    fprintf(stderr, "sigmf:: regions\n");
+    ASSERT_EQUALS(sigmf_meta_regions(&meta, 50), 2);
+    ASSERT_EQUALS(meta.annotations[0].sample_start, 50);
+    ASSERT_EQUALS(meta.annotations[0].sample_count, 300);
+    ASSERT_EQUALS(meta.annotations[1].sample_start, 1350);
+    ASSERT_EQUALS(meta.annotations[1].sample_count, 150);
+    sigmf_meta_free(&meta);
+
+    fprintf(stderr, "sigmf:: read by data file name\n");
+    ASSERT_EQUALS(sigmf_meta_read(&meta, data_path), 0);
+    ASSERT_EQUALS(meta.num_annotations, 3);
+    sigmf_meta_free(&meta);
+
+    remove(meta_path);
+    remove(data_path);
+
+    fprintf(stderr, "sigmf:: test (%u/%u) passed, (%u) failed.\n", passed, passed + failed, failed);
+
+    return failed;
+}
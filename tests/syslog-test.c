@@ -0,0 +1,135 @@
+/** @file
+    Syslog UDP output tests against a local datagram receiver.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "data.h"
+#include "output_udp.h"
+#include "mongoose.h"
+
+/// UDP receiver, counts datagrams and the messages in them
+typedef struct {
+    int datagrams;
+    int messages;
+    int max_lines; ///< most messages seen in one datagram
+} receiver_t;
+
+static receiver_t receiver;
+
+static void receiver_event(struct mg_connection *nc, int ev, void *ev_data)
+{
+    if (ev == MG_EV_RECV) {
+        int len = *(int *)ev_data;
+        char const *p = nc->recv_mbuf.buf + nc->recv_mbuf.len - len;
+        int lines = 1;
+        for (int i = 0; i < len; ++i)
+            lines += p[i] == '\n';
+        receiver.datagrams++;
+        receiver.messages += lines;
+        if (lines > receiver.max_lines)
+            receiver.max_lines = lines;
+        mbuf_remove(&nc->recv_mbuf, nc->recv_mbuf.len);
+    }
+}
+
+static void poll_for(struct mg_mgr *mgr, double timeout)
+{
+    double end = mg_time() + timeout;
+    while (mg_time() < end)
+        mg_mgr_poll(mgr, 10);
+}
+
+static void print_events(data_output_t *output, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        data_t *data = data_make(
+                "model",            "", DATA_STRING, "Test",
+                "id",               "", DATA_INT,    i,
+                NULL);
+        data_output_print(output, data);
+        data_free(data);
+    }
+}
+
+#define ASSERT_EQUALS(a, b) \
+    do { \
+        if ((a) == (b)) \
+            ++passed; \
+        else { \
+            ++failed; \
+            fprintf(stderr, "FAIL line %d: %d <> %d\n", __LINE__, (int)(a), (int)(b)); \
+        } \
+    } while (0)
+
+int main(void)
+{
+    unsigned passed = 0;
+    unsigned failed = 0;
+    char opts[64];
+    char port[16];
+
+    struct mg_mgr mgr;
+    mg_mgr_init(&mgr, NULL);
+
+    struct mg_connection *listener = mg_bind(&mgr, "udp://127.0.0.1:0", receiver_event);
+    if (!listener) {
+        fprintf(stderr, "syslog:: can't bind receiver\n");
+        return 1;
+    }
+    mg_conn_addr_to_str(listener, port, sizeof(port), MG_SOCK_STRINGIFY_PORT);
+
+    fprintf(stderr, "syslog:: test\n");
+
+    fprintf(stderr, "syslog:: one datagram per event\n");
+    memset(&receiver, 0, sizeof(receiver));
+    data_output_t *output = data_output_syslog_create(&mgr, "127.0.0.1", port, NULL);
+    print_events(output, 3);
+    poll_for(&mgr, 0.1);
+    ASSERT_EQUALS(receiver.datagrams, 3);
+    data_output_free(output);
+
+    fprintf(stderr, "syslog:: batch of datagrams\n");
+    memset(&receiver, 0, sizeof(receiver));
+    snprintf(opts, sizeof(opts), "batch=3,latency=60000");
+    output = data_output_syslog_create(&mgr, "127.0.0.1", port, opts);
+    print_events(output, 2);
+    poll_for(&mgr, 0.1);
+    ASSERT_EQUALS(receiver.datagrams, 0); // not due yet
+    print_events(output, 1);
+    poll_for(&mgr, 0.1);
+    ASSERT_EQUALS(receiver.datagrams, 3);
+    print_events(output, 1);
+    data_output_free(output); // flushes the queue
+    poll_for(&mgr, 0.1);
+    ASSERT_EQUALS(receiver.datagrams, 4);
+
+    fprintf(stderr, "syslog:: newline separated messages\n");
+    memset(&receiver, 0, sizeof(receiver));
+    snprintf(opts, sizeof(opts), "lines,latency=50");
+    output = data_output_syslog_create(&mgr, "127.0.0.1", port, opts);
+    print_events(output, 5);
+    poll_for(&mgr, 0.2); // latency timer
+    ASSERT_EQUALS(receiver.datagrams, 1);
+    ASSERT_EQUALS(receiver.messages, 5);
+    print_events(output, 40); // ~60 bytes each, needs more than one datagram
+    poll_for(&mgr, 0.2);
+    ASSERT_EQUALS(receiver.messages, 45);
+    ASSERT_EQUALS(receiver.datagrams > 2, 1);
+    data_output_free(output);
+
+    mg_mgr_free(&mgr);
+
+    fprintf(stderr, "syslog:: test (%u/%u) passed, (%u) failed.\n", passed, passed + failed, failed);
+
+    return failed;
+}